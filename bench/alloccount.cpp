@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: MIT
+
+// Counts the heap allocations of the program that this library is preloaded into (with
+// `LD_PRELOAD`), and writes their number to the file descriptor in `RGBDS_BENCH_ALLOC_FD` when it
+// exits. This wraps glibc's allocator, so it is only built on Linux.
+
+#include <atomic>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+}
+
+static std::atomic<unsigned long> nbAllocs;
+
+extern "C" void *malloc(size_t size) {
+	nbAllocs.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size) {
+	nbAllocs.fetch_add(1, std::memory_order_relaxed);
+	return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+	nbAllocs.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(ptr, size);
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size) {
+	nbAllocs.fetch_add(1, std::memory_order_relaxed);
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t size) {
+	nbAllocs.fetch_add(1, std::memory_order_relaxed);
+	*ptr = __libc_memalign(alignment, size);
+	return *ptr ? 0 : ENOMEM;
+}
+
+[[gnu::destructor]] static void reportAllocs() {
+	unsigned long count = nbAllocs.load(); // Before anything below allocates
+	if (char const *fd = getenv("RGBDS_BENCH_ALLOC_FD"); fd) {
+		dprintf(atoi(fd), "%lu", count);
+	}
+}
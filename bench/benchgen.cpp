@@ -0,0 +1,533 @@
+// SPDX-License-Identifier: MIT
+
+// Generates the inputs of the benchmarks: large, but valid, inputs for each of the programs, that
+// stress one part of them each. They are not meant to look like real projects, only to be big.
+// The same scale always generates the same files, regardless of the platform.
+
+#include <algorithm>
+#include <array>
+#include <errno.h>
+#include <inttypes.h>
+#include <png.h>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static std::mt19937 rng; // Its output is fully specified by the standard, unlike distributions
+
+static uint32_t randUpTo(uint32_t max) { // Inclusive
+	return rng() % (max + 1);
+}
+
+static bool randChance(uint32_t percent) {
+	return randUpTo(99) < percent;
+}
+
+static unsigned long scale = 1;
+
+static FILE *createFile(std::string const &fileName, char const *mode = "w") {
+	FILE *file = fopen(fileName.c_str(), mode);
+	if (!file) {
+		fprintf(stderr, "FATAL: Cannot create %s: %s\n", fileName.c_str(), strerror(errno));
+		exit(1);
+	}
+	return file;
+}
+
+static void closeFile(FILE *file, std::string const &fileName) {
+	if (ferror(file) || fclose(file) != 0) {
+		fprintf(stderr, "FATAL: Cannot write %s: %s\n", fileName.c_str(), strerror(errno));
+		exit(1);
+	}
+}
+
+// A single source file, heavy on macros, REPT and FOR blocks, interpolation, and symbols; this
+// stresses RGBASM's lexer, its macro expansion, and its symbol table more than its output.
+static void generateMacroSource(std::string const &fileName) {
+	FILE *file = createFile(fileName);
+	uint32_t nbMacros = 100;
+	uint32_t nbConstants = 20000 * scale;
+	uint32_t nbSections = 50 * scale;
+
+	for (uint32_t i = 0; i < nbConstants; ++i) {
+		fprintf(file, "DEF CONST_%" PRIu32 " EQU $%04" PRIx32 "\n", i, randUpTo(0xFFFF));
+	}
+	for (uint32_t i = 0; i < nbConstants / 10; ++i) {
+		fprintf(
+		    file, "DEF STR_%" PRIu32 " EQUS \"CONST_%" PRIu32 "\"\n", i, randUpTo(nbConstants - 1)
+		);
+	}
+
+	for (uint32_t i = 0; i < nbMacros; ++i) {
+		fprintf(file, "\nMACRO op%" PRIu32 "\n", i);
+		fputs("\tREPT \\1\n", file);
+		fprintf(
+		    file, "\t\tdb (\\2 + %" PRIu32 ") & $FF, LOW(\\3 * %" PRIu32 ")\n", i, randUpTo(99)
+		);
+		fputs("\tENDR\n", file);
+		fprintf(file, "\tFOR V, %" PRIu32 "\n", randUpTo(4) + 1);
+		fprintf(file, "\t\tREDEF TMP_{d:V} EQU \\2 ^ V * %" PRIu32 "\n", randUpTo(99));
+		fputs("\t\tdb LOW(TMP_{d:V})\n", file);
+		fputs("\tENDR\n", file);
+		fputs("\tld a, \\2 & $FF\n", file);
+		fputs("\tld [hl+], a\n", file);
+		fputs("ENDM\n", file);
+	}
+
+	for (uint32_t s = 0; s < nbSections; ++s) {
+		fprintf(file, "\nSECTION \"Code %" PRIu32 "\", ROMX\n", s);
+		fprintf(file, "Code%" PRIu32 "::\n", s);
+		for (uint32_t j = 0; j < 200; ++j) {
+			uint32_t constant = randUpTo(nbConstants - 1);
+			if (j % 10 == 0) {
+				fprintf(file, ".local%" PRIu32 "\n", j);
+			}
+			fprintf(
+			    file,
+			    "\top%" PRIu32 " %" PRIu32 ", CONST_%" PRIu32 ", {STR_%" PRIu32 "}\n",
+			    randUpTo(nbMacros - 1),
+			    randUpTo(7) + 1,
+			    constant,
+			    randUpTo(nbConstants / 10 - 1)
+			);
+			if (randChance(10)) {
+				fprintf(file, "\tjp .local%" PRIu32 "\n", j - j % 10);
+			}
+		}
+		fputs("\tREPT 16\n", file);
+		fputs("\t\tREPT 4\n", file);
+		fprintf(file, "\t\t\tdw Code%" PRIu32 ", STRLEN(\"{STR_0}\")\n", s);
+		fputs("\t\tENDR\n", file);
+		fputs("\tENDR\n", file);
+	}
+
+	closeFile(file, fileName);
+}
+
+// A single source file full of operands that refer to labels in floating sections, which stay
+// unknown until link time; this stresses how RGBASM builds and outputs relocatable expressions.
+static void generateRelocSource(std::string const &fileName) {
+	FILE *file = createFile(fileName);
+	uint32_t nbSections = 200 * scale;
+	uint32_t nbLabels = 100; // Per section
+	uint32_t nbOperands = 3; // Per label
+
+	for (uint32_t s = 0; s < nbSections; ++s) {
+		fprintf(file, "\nSECTION \"Relocs %" PRIu32 "\", ROMX\n", s);
+		for (uint32_t l = 0; l < nbLabels; ++l) {
+			fprintf(file, "Reloc%" PRIu32 "_%" PRIu32 ":\n", s, l);
+			for (uint32_t o = 0; o < nbOperands; ++o) {
+				// Labels of any section, including ones that are not defined yet
+				uint32_t target = randUpTo(nbSections - 1);
+				uint32_t label = randUpTo(nbLabels - 1);
+				switch (randUpTo(5)) {
+				case 0:
+					fprintf(file, "\tdw Reloc%" PRIu32 "_%" PRIu32 "\n", target, label);
+					break;
+				case 1:
+					fprintf(
+					    file,
+					    "\tld hl, Reloc%" PRIu32 "_%" PRIu32 " + %" PRIu32 "\n",
+					    target,
+					    label,
+					    randUpTo(15)
+					);
+					break;
+				case 2:
+					fprintf(file, "\tcall Reloc%" PRIu32 "_%" PRIu32 "\n", target, label);
+					break;
+				case 3:
+					fprintf(file, "\tld a, BANK(Reloc%" PRIu32 "_%" PRIu32 ")\n", target, label);
+					break;
+				case 4:
+					fprintf(file, "\tld a, HIGH(Reloc%" PRIu32 "_%" PRIu32 ")\n", target, label);
+					break;
+				case 5:
+					fprintf(file, "\tdw STARTOF(\"Relocs %" PRIu32 "\")\n", target);
+					break;
+				}
+			}
+		}
+	}
+
+	closeFile(file, fileName);
+}
+
+// Many object files, which reference each other's labels and share fragments and unions; besides
+// placing them, most of the work is reading the objects, which contain a lot of data and patches.
+static void generateObjectSources(std::string const &dirName) {
+	uint32_t nbFiles = 200 * scale;
+	uint32_t nbSectionsPerFile = 4;
+
+	for (uint32_t f = 0; f < nbFiles; ++f) {
+		char fileName[sizeof("/obj0000000000.asm")];
+		snprintf(fileName, sizeof(fileName), "/obj%04" PRIu32 ".asm", f);
+		std::string path = dirName + fileName;
+		FILE *file = createFile(path);
+
+		for (uint32_t k = 0; k < nbSectionsPerFile; ++k) {
+			fprintf(file, "SECTION \"Data %" PRIu32 "_%" PRIu32 "\", ROMX\n", f, k);
+			fprintf(file, "Data%" PRIu32 "_%" PRIu32 "::\n", f, k);
+			fprintf(
+			    file, "\tds %" PRIu32 ", $%02" PRIx32 "\n", randUpTo(1024) + 256, randUpTo(0xFF)
+			);
+			for (uint32_t i = 0; i < 32; ++i) {
+				fprintf(
+				    file,
+				    "\tdw Code%" PRIu32 "_%" PRIu32 " + %" PRIu32 "\n",
+				    randUpTo(nbFiles - 1),
+				    randUpTo(nbSectionsPerFile - 1),
+				    randUpTo(15)
+				);
+			}
+
+			fprintf(file, "SECTION \"Code %" PRIu32 "_%" PRIu32 "\", ROMX\n", f, k);
+			fprintf(file, "Code%" PRIu32 "_%" PRIu32 "::\n", f, k);
+			for (uint32_t i = 0; i < 64; ++i) {
+				uint32_t other = randUpTo(nbFiles - 1);
+				uint32_t otherSection = randUpTo(nbSectionsPerFile - 1);
+				switch (randUpTo(3)) {
+				case 0:
+					fprintf(file, "\tcall Code%" PRIu32 "_%" PRIu32 "\n", other, otherSection);
+					break;
+				case 1:
+					fprintf(file, "\tld hl, Data%" PRIu32 "_%" PRIu32 "\n", other, otherSection);
+					break;
+				case 2:
+					fprintf(
+					    file, "\tld a, BANK(Data%" PRIu32 "_%" PRIu32 ")\n", other, otherSection
+					);
+					break;
+				case 3:
+					fprintf(file, "\tld [Var%" PRIu32 "], a\n", other);
+					break;
+				}
+			}
+			fputs("\tret\n", file);
+		}
+
+		fprintf(file, "SECTION FRAGMENT \"Shared %" PRIu32 "\", ROMX\n", f / 64);
+		fprintf(file, "\tdw Code%" PRIu32 "_0, Data%" PRIu32 "_0\n", f, f);
+		fprintf(file, "\tds %" PRIu32 ", $%02" PRIx32 "\n", randUpTo(32), randUpTo(0xFF));
+
+		fputs("SECTION UNION \"Variables\", WRAM0\n", file);
+		fprintf(file, "Var%" PRIu32 "::\n", f);
+		fprintf(file, "\tds %" PRIu32 "\n", randUpTo(64) + 1);
+
+		closeFile(file, path);
+	}
+}
+
+// A single source file with many small sections of every kind of constraint, so that linking it
+// is mostly placing them.
+static void generateLayoutSource(std::string const &fileName) {
+	FILE *file = createFile(fileName);
+	uint32_t nbSections = 10000 * scale;
+	uint32_t nbBanks = 64 * scale;
+
+	for (uint32_t s = 0; s < nbSections; ++s) {
+		uint32_t size = randUpTo(199) + 1;
+		uint32_t kind = randUpTo(99);
+
+		if (kind < 5) {
+			fprintf(file, "SECTION \"Vars %" PRIu32 "\", WRAMX\n", s);
+			size = randUpTo(15) + 1;
+		} else if (kind < 7) {
+			fprintf(file, "SECTION \"Home %" PRIu32 "\", ROM0\n", s);
+			size = randUpTo(15) + 1;
+		} else if (kind < 15) {
+			fprintf(
+			    file,
+			    "SECTION \"Banked %" PRIu32 "\", ROMX, BANK[%" PRIu32 "]\n",
+			    s,
+			    randUpTo(nbBanks - 1) + 1
+			);
+		} else if (kind < 25) {
+			fprintf(
+			    file,
+			    "SECTION \"Aligned %" PRIu32 "\", ROMX, ALIGN[%" PRIu32 "]\n",
+			    s,
+			    randUpTo(7) + 1
+			);
+		} else if (kind < 30) {
+			fprintf(file, "SECTION FRAGMENT \"Fragment %" PRIu32 "\", ROMX\n", randUpTo(49));
+			size = randUpTo(31) + 1;
+		} else {
+			fprintf(file, "SECTION \"Floating %" PRIu32 "\", ROMX\n", s);
+		}
+		fprintf(file, "Label%" PRIu32 ":\n", s);
+		if (kind < 5) {
+			fprintf(file, "\tds %" PRIu32 "\n", size); // RAM cannot contain data
+		} else {
+			fprintf(file, "\tds %" PRIu32 ", $%02" PRIx32 "\n", size, randUpTo(0xFF));
+		}
+	}
+
+	closeFile(file, fileName);
+}
+
+// Many SDCC objects, with a linker script to place their areas. Each object has code in one of
+// several banked areas (which are fragments, like with SDCC), calling functions of the others.
+static void generateSDCCObjects(std::string const &dirName) {
+	uint32_t nbFiles = 500 * scale;
+	uint32_t nbBanks = 16 * scale;
+	uint32_t nbFunctions = 8; // Per file
+
+	std::string scriptName = dirName + "/script.link";
+	FILE *script = createFile(scriptName);
+	for (uint32_t b = 1; b <= nbBanks; ++b) {
+		fprintf(script, "ROMX %" PRIu32 "\n", b);
+		fprintf(script, "\t\"_CODE_%" PRIu32 "\" OPTIONAL\n", b);
+	}
+	fputs("WRAM0\n", script);
+	fputs("\t\"_DATA\" OPTIONAL\n", script);
+	closeFile(script, scriptName);
+
+	for (uint32_t f = 0; f < nbFiles; ++f) {
+		char fileName[sizeof("/mod0000000000.rel")];
+		snprintf(fileName, sizeof(fileName), "/mod%04" PRIu32 ".rel", f);
+		std::string path = dirName + fileName;
+		FILE *file = createFile(path);
+
+		// Each function is a few calls to functions of other files, and some data
+		struct Function {
+			uint32_t offset;
+			std::vector<uint32_t> callees; // Indices of imported symbols
+			std::vector<uint8_t> data;
+		};
+		std::vector<Function> functions(nbFunctions);
+		std::vector<std::string> imports;
+		uint32_t codeSize = 0;
+		for (Function &function : functions) {
+			function.offset = codeSize;
+			for (uint32_t i = randUpTo(4) + 1; i; --i) {
+				char name[sizeof("_mod0000000000_fn0000000000")];
+				snprintf(
+				    name,
+				    sizeof(name),
+				    "_mod%" PRIu32 "_fn%" PRIu32,
+				    randUpTo(nbFiles - 1),
+				    randUpTo(nbFunctions - 1)
+				);
+				function.callees.push_back(imports.size());
+				imports.push_back(name);
+				codeSize += 3;
+			}
+			for (uint32_t i = randUpTo(32) + 8; i; --i) {
+				function.data.push_back(randUpTo(0xFF));
+			}
+			function.data.push_back(0xC9); // ret
+			codeSize += function.data.size();
+		}
+
+		fputs("XL3\n", file);
+		// Numbers are in hexadecimal, as the "X" of the first line says
+		fprintf(file, "H 2 areas %zx global symbols\n", nbFunctions + 1 + imports.size());
+		fprintf(file, "M mod%" PRIu32 "\n", f);
+		fputs("O -msm83\n", file);
+		// Symbols are numbered in order, starting with the imports and `.__.ABS.`
+		for (std::string const &name : imports) {
+			fprintf(file, "S %s Ref000000\n", name.c_str());
+		}
+		fputs("S .__.ABS. Def000000\n", file);
+		fprintf(
+		    file, "A _CODE_%" PRIu32 " size %" PRIx32 " flags 0 addr 0\n", f % nbBanks + 1, codeSize
+		);
+		for (uint32_t i = 0; i < nbFunctions; ++i) {
+			fprintf(
+			    file,
+			    "S _mod%" PRIu32 "_fn%" PRIu32 " Def%06" PRIx32 "\n",
+			    f,
+			    i,
+			    functions[i].offset
+			);
+		}
+		fputs("A _DATA size 2 flags 0 addr 0\n", file);
+
+		// SDCC emits each instruction with its relocations, at most 16 bytes per `T` line
+		for (Function const &function : functions) {
+			uint32_t addr = function.offset;
+			for (uint32_t callee : function.callees) {
+				fprintf(
+				    file, "T %02" PRIX32 " %02" PRIX32 " 00 CD 00 00\n", addr & 0xFF, addr >> 8
+				);
+				fprintf(
+				    file,
+				    "R 00 00 00 00 02 04 %02" PRIX32 " %02" PRIX32 "\n",
+				    callee & 0xFF,
+				    callee >> 8
+				);
+				addr += 3;
+			}
+			for (size_t i = 0; i < function.data.size(); i += 16) {
+				fprintf(file, "T %02" PRIX32 " %02" PRIX32 " 00", addr & 0xFF, addr >> 8);
+				size_t end = i + 16 < function.data.size() ? i + 16 : function.data.size();
+				for (size_t j = i; j < end; ++j) {
+					fprintf(file, " %02" PRIX8, function.data[j]);
+				}
+				fputs("\nR 00 00 00 00\n", file);
+				addr += end - i;
+			}
+		}
+
+		closeFile(file, path);
+	}
+}
+
+// A large image made of tiles that often repeat, possibly flipped, in many different palettes;
+// this stresses RGBGFX's palette packing and tile deduplication.
+static void generateImage(std::string const &fileName) {
+	uint32_t width = 64, height = 256 * scale; // In tiles
+	uint32_t nbPatterns = 192;
+	uint32_t nbPalettes = 48;
+
+	// Colors are distinct, even through RGB555, so that palettes can't accidentally merge
+	std::vector<uint32_t> colors;
+	while (colors.size() < nbPalettes * 4) {
+		uint32_t color = randUpTo(0x7FFF);
+		if (std::find(colors.begin(), colors.end(), color) == colors.end()) {
+			colors.push_back(color);
+		}
+	}
+	// Each palette is sorted by luminance, so that RGBGFX gives a pattern the same color indices
+	// whichever palette it is in, and can thus deduplicate it
+	auto luminance = [](uint32_t color) {
+		return (color & 0x1F) * 2126 + (color >> 5 & 0x1F) * 7152 + (color >> 10 & 0x1F) * 722;
+	};
+	for (uint32_t p = 0; p < nbPalettes; ++p) {
+		auto first = colors.begin() + p * 4;
+		std::sort(first, first + 4, [&](uint32_t lhs, uint32_t rhs) {
+			return luminance(lhs) < luminance(rhs);
+		});
+	}
+	std::vector<std::array<uint8_t, 64>> patterns(nbPatterns);
+	for (std::array<uint8_t, 64> &pattern : patterns) {
+		for (uint8_t &pixel : pattern) {
+			pixel = randUpTo(3);
+		}
+	}
+
+	static constexpr uint8_t SIZEOF_PIXEL = 4; // Each pixel is 4 bytes (RGBA @ 8 bits/component)
+	std::vector<uint8_t> data(width * 8 * height * 8 * SIZEOF_PIXEL);
+	for (uint32_t ty = 0; ty < height; ++ty) {
+		for (uint32_t tx = 0; tx < width; ++tx) {
+			std::array<uint8_t, 64> const &pattern = patterns[randUpTo(nbPatterns - 1)];
+			uint32_t palette = randUpTo(nbPalettes - 1);
+			bool flipX = randChance(25), flipY = randChance(25);
+			for (uint32_t y = 0; y < 8; ++y) {
+				for (uint32_t x = 0; x < 8; ++x) {
+					uint8_t index = pattern[(flipY ? 7 - y : y) * 8 + (flipX ? 7 - x : x)];
+					uint32_t color = colors[palette * 4 + index];
+					uint8_t *pixel =
+					    &data[((ty * 8 + y) * width * 8 + tx * 8 + x) * SIZEOF_PIXEL];
+					pixel[0] = (color & 0x1F) << 3 | (color & 0x1F) >> 2;
+					pixel[1] = (color >> 5 & 0x1F) << 3 | (color >> 5 & 0x1F) >> 2;
+					pixel[2] = (color >> 10 & 0x1F) << 3 | (color >> 10 & 0x1F) >> 2;
+					pixel[3] = 0xFF;
+				}
+			}
+		}
+	}
+
+	FILE *file = createFile(fileName, "wb");
+	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	png_infop pngInfo = png_create_info_struct(png);
+	if (!png || !pngInfo || setjmp(png_jmpbuf(png))) {
+		fprintf(stderr, "FATAL: Cannot write %s\n", fileName.c_str());
+		exit(1);
+	}
+	png_init_io(png, file);
+	png_set_IHDR(
+	    png,
+	    pngInfo,
+	    width * 8,
+	    height * 8,
+	    8,
+	    PNG_COLOR_TYPE_RGB_ALPHA,
+	    PNG_INTERLACE_NONE,
+	    PNG_COMPRESSION_TYPE_DEFAULT,
+	    PNG_FILTER_TYPE_DEFAULT
+	);
+	std::vector<uint8_t *> rowPtrs(height * 8);
+	for (uint32_t y = 0; y < height * 8; ++y) {
+		rowPtrs[y] = &data[y * width * 8 * SIZEOF_PIXEL];
+	}
+	png_set_rows(png, pngInfo, rowPtrs.data());
+	png_write_png(png, pngInfo, PNG_TRANSFORM_IDENTITY, nullptr);
+	png_destroy_write_struct(&png, &pngInfo);
+	closeFile(file, fileName);
+}
+
+// A big ROM, without a valid header; RGBFIX's work is proportional to its size.
+static void generateROM(std::string const &fileName) {
+	uint32_t nbBanks = 256 * scale;
+	std::vector<uint8_t> bank(0x4000);
+
+	FILE *file = createFile(fileName, "wb");
+	for (uint32_t b = 0; b < nbBanks; ++b) {
+		for (uint8_t &byte : bank) {
+			byte = rng();
+		}
+		if (b == 0) {
+			memset(&bank[0x100], 0, 0x50); // Leave the header blank
+		}
+		fwrite(bank.data(), 1, bank.size(), file);
+	}
+	// Leave the ROM's end unpadded, for RGBFIX to pad
+	fwrite(bank.data(), 1, 0x1234, file);
+	closeFile(file, fileName);
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 3 || argc > 4) {
+		fprintf(stderr, "usage: %s <kind> <output> [<scale>]\n", argv[0]);
+		fputs(
+		    "kinds: asm, relocs, objects (output is a directory), layout, sdcc (directory), png, "
+		    "rom\n",
+		    stderr
+		);
+		return 2;
+	}
+
+	if (argc > 3) {
+		char *endptr;
+		scale = strtoul(argv[3], &endptr, 0);
+		if (argv[3][0] == '\0' || *endptr != '\0' || scale == 0) {
+			fprintf(stderr, "FATAL: invalid scale \"%s\"\n", argv[3]);
+			return 1;
+		}
+	}
+
+	std::string kind = argv[1];
+	std::string output = argv[2];
+	// Each kind of input gets its own sequence, so that adding one does not change the others
+	uint32_t seed = UINT32_C(0x811C9DC5); // FNV-1a, since `std::hash` is not portable
+	for (char c : kind) {
+		seed = (seed ^ static_cast<uint8_t>(c)) * UINT32_C(0x01000193);
+	}
+	rng.seed(seed);
+	if (kind == "asm") {
+		generateMacroSource(output);
+	} else if (kind == "relocs") {
+		generateRelocSource(output);
+	} else if (kind == "objects") {
+		generateObjectSources(output);
+	} else if (kind == "layout") {
+		generateLayoutSource(output);
+	} else if (kind == "sdcc") {
+		generateSDCCObjects(output);
+	} else if (kind == "png") {
+		generateImage(output);
+	} else if (kind == "rom") {
+		generateROM(output);
+	} else {
+		fprintf(stderr, "FATAL: unknown kind \"%s\"\n", kind.c_str());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MIT
+
+// Runs a command several times, and prints how long it took and how much memory it used, as a
+// JSON object. The command's standard output is discarded, and it must succeed every time.
+// If `RGBDS_BENCH_ALLOC_SHIM` names the `alloccount` library, the untimed first run also counts
+// how many heap allocations the command performs.
+
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+struct Run {
+	double wallMs;
+	double userMs;
+	double sysMs;
+	long peakRssKiB;
+	long nbAllocs; // -1 if not counted
+};
+
+static double toMs(timeval const &time) {
+	return time.tv_sec * 1000.0 + time.tv_usec / 1000.0;
+}
+
+static Run runOnce(char *argv[], char const *allocShim = nullptr) {
+	// The shim writes the allocation count to this pipe when the command exits
+	int allocPipe[2] = {-1, -1};
+	if (allocShim && pipe(allocPipe) == -1) {
+		fprintf(stderr, "FATAL: Cannot create a pipe: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	pid_t pid = fork();
+	if (pid == -1) {
+		fprintf(stderr, "FATAL: Cannot fork: %s\n", strerror(errno));
+		exit(1);
+	}
+	if (pid == 0) {
+		if (int devNull = open("/dev/null", O_WRONLY); devNull != -1) {
+			dup2(devNull, STDOUT_FILENO);
+			close(devNull);
+		}
+		if (allocShim) {
+			close(allocPipe[0]);
+			setenv("LD_PRELOAD", allocShim, 1);
+			setenv("RGBDS_BENCH_ALLOC_FD", std::to_string(allocPipe[1]).c_str(), 1);
+		}
+		execvp(argv[0], argv);
+		fprintf(stderr, "FATAL: Cannot run %s: %s\n", argv[0], strerror(errno));
+		_exit(127);
+	}
+
+	if (allocShim) {
+		close(allocPipe[1]);
+	}
+
+	int status;
+	rusage usage;
+	if (wait4(pid, &status, 0, &usage) == -1) {
+		fprintf(stderr, "FATAL: Cannot wait for %s: %s\n", argv[0], strerror(errno));
+		exit(1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		fprintf(stderr, "FATAL: %s failed\n", argv[0]);
+		exit(1);
+	}
+
+	long nbAllocs = -1;
+	if (allocShim) {
+		char count[24];
+		ssize_t len = read(allocPipe[0], count, sizeof(count) - 1);
+		if (len > 0) {
+			count[len] = '\0';
+			nbAllocs = strtol(count, nullptr, 10);
+		}
+		close(allocPipe[0]);
+	}
+
+	return {
+	    .wallMs = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6,
+	    .userMs = toMs(usage.ru_utime),
+	    .sysMs = toMs(usage.ru_stime),
+#ifdef __APPLE__
+	    .peakRssKiB = usage.ru_maxrss / 1024, // macOS reports bytes, unlike everyone else
+#else
+	    .peakRssKiB = usage.ru_maxrss,
+#endif
+	    .nbAllocs = nbAllocs,
+	};
+}
+
+static double median(std::vector<double> values) {
+	std::sort(values.begin(), values.end());
+	size_t mid = values.size() / 2;
+	return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+static void appendJSONString(std::string &out, char const *str) {
+	out.push_back('"');
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\') {
+			out.push_back('\\');
+		}
+		out.push_back(*str);
+	}
+	out.push_back('"');
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 4) {
+		fprintf(stderr, "usage: %s <name> <runs> <command> [<args>...]\n", argv[0]);
+		return 2;
+	}
+
+	char *endptr;
+	unsigned long nbRuns = strtoul(argv[2], &endptr, 0);
+	if (argv[2][0] == '\0' || *endptr != '\0' || nbRuns == 0) {
+		fprintf(stderr, "FATAL: invalid number of runs \"%s\"\n", argv[2]);
+		return 1;
+	}
+
+	// A first, untimed run warms up the file cache, and counts allocations without slowing down
+	// the timed runs
+	long nbAllocs = runOnce(&argv[3], getenv("RGBDS_BENCH_ALLOC_SHIM")).nbAllocs;
+
+	std::vector<double> wall, user, sys;
+	long peakRssKiB = 0;
+	for (unsigned long i = 0; i < nbRuns; ++i) {
+		Run run = runOnce(&argv[3]);
+		wall.push_back(run.wallMs);
+		user.push_back(run.userMs);
+		sys.push_back(run.sysMs);
+		peakRssKiB = std::max(peakRssKiB, run.peakRssKiB);
+	}
+
+	std::string command;
+	for (int i = 3; i < argc; ++i) {
+		if (i != 3) {
+			command.push_back(' ');
+		}
+		command.append(argv[i]);
+	}
+
+	std::string out = "{\"name\": ";
+	appendJSONString(out, argv[1]);
+	out.append(", \"command\": ");
+	appendJSONString(out, command.c_str());
+	printf(
+	    "%s, \"runs\": %lu, \"wall_ms\": {\"min\": %.3f, \"median\": %.3f, \"max\": %.3f}, "
+	    "\"user_ms\": %.3f, \"sys_ms\": %.3f, \"peak_rss_kib\": %ld, \"allocations\": %s}\n",
+	    out.c_str(),
+	    nbRuns,
+	    *std::min_element(wall.begin(), wall.end()),
+	    median(wall),
+	    *std::max_element(wall.begin(), wall.end()),
+	    median(user),
+	    median(sys),
+	    peakRssKiB,
+	    nbAllocs != -1 ? std::to_string(nbAllocs).c_str() : "null"
+	);
+	return 0;
+}
@@ -0,0 +1,182 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+export LC_ALL=C
+
+# Game Boy release date, 1989-04-21T12:34:56Z (for reproducible outputs)
+export SOURCE_DATE_EPOCH=609165296
+
+usage() {
+	echo "Runs benchmarks of RGBDS, and prints their timings and peak memory usage as JSON."
+	echo "Usage: $0 [options] [<benchmark>...]"
+	echo "Options:"
+	echo "    -h, --help            show this help message"
+	echo "    -l, --list            list the benchmarks, and exit"
+	echo "    -o, --output <file>   write the results to this file instead of standard output"
+	echo "    -r, --runs <n>        number of timed runs of each benchmark (default: 5)"
+	echo "    -s, --scale <n>       multiply the size of the generated inputs (default: 1)"
+}
+
+benchmarks=(
+	asm-macros
+	asm-relocs
+	link-objects
+	link-layout
+	link-sdcc
+	gfx-convert
+	gfx-dedup
+	fix-rom
+)
+
+# Parse options in pure Bash because macOS `getopt` is stuck
+# in what util-linux `getopt` calls `GETOPT_COMPATIBLE` mode
+output=
+runs=5
+scale=1
+selected=()
+while [[ $# -gt 0 ]]; do
+	case "$1" in
+		-h|--help)
+			usage
+			exit 0
+			;;
+		-l|--list)
+			printf '%s\n' "${benchmarks[@]}"
+			exit 0
+			;;
+		-o|--output)
+			shift
+			output="$1"
+			;;
+		-r|--runs)
+			shift
+			runs="$1"
+			;;
+		-s|--scale)
+			shift
+			scale="$1"
+			;;
+		-*)
+			usage
+			exit 1
+			;;
+		*)
+			selected+=("$1")
+			;;
+	esac
+	shift
+done
+if [[ ${#selected[@]} -eq 0 ]]; then
+	selected=("${benchmarks[@]}")
+fi
+if [[ -n "$output" && "$output" != /* ]]; then
+	output="$PWD/$output"
+fi
+
+cd "$(dirname "$0")"
+
+RGBASM=../rgbasm
+RGBLINK=../rgblink
+RGBFIX=../rgbfix
+RGBGFX=../rgbgfx
+for program in "$RGBASM" "$RGBLINK" "$RGBFIX" "$RGBGFX" ./benchgen ./benchrun; do
+	if [[ ! -x "$program" ]]; then
+		echo "$program is not built" >&2
+		exit 1
+	fi
+done
+
+# Allocations are counted by preloading this library, which is only built on Linux
+if [[ -e ./alloccount.so ]]; then
+	export RGBDS_BENCH_ALLOC_SHIM="$PWD/alloccount.so"
+fi
+
+work="$(mktemp -d)"
+# Immediate expansion is the desired behavior.
+# shellcheck disable=SC2064
+trap "rm -rf ${work@Q}" EXIT
+
+# Generating inputs is not timed; neither is assembling the ones meant for linking
+generate() {
+	echo "Generating $1 input (scale $scale)..." >&2
+	./benchgen "$1" "$work/$2" "$scale"
+}
+
+# Runs the benchmark, and prints its results
+measure() {
+	local name="$1"
+	shift
+	echo "Running $name..." >&2
+	./benchrun "$name" "$runs" "$@"
+}
+
+# Same as `measure`, with RGBLINK's statistics about its phases added to the results
+measureLink() {
+	local result
+	result="$(measure "$@")"
+	echo "${result%\}}, \"stats\": $("${@:2}" --stats=json 2>&1 >/dev/null | tr -d '\n\t')}"
+}
+
+runBenchmark() {
+	case "$1" in
+		asm-macros)
+			generate asm macros.asm
+			measure "$1" "$RGBASM" -o "$work"/macros.o "$work"/macros.asm
+			;;
+		asm-relocs)
+			generate relocs relocs.asm
+			measure "$1" "$RGBASM" -o "$work"/relocs.o "$work"/relocs.asm
+			;;
+		link-objects)
+			mkdir "$work"/objects
+			generate objects objects
+			for source in "$work"/objects/*.asm; do
+				"$RGBASM" -o "${source%.asm}.o" "$source"
+			done
+			measureLink "$1" "$RGBLINK" -o "$work"/objects.gb "$work"/objects/*.o
+			;;
+		link-layout)
+			generate layout layout.asm
+			"$RGBASM" -o "$work"/layout.o "$work"/layout.asm
+			measureLink "$1" "$RGBLINK" -o "$work"/layout.gb "$work"/layout.o
+			;;
+		link-sdcc)
+			mkdir "$work"/sdcc
+			generate sdcc sdcc
+			measureLink "$1" "$RGBLINK" -l "$work"/sdcc/script.link -o "$work"/sdcc.gb "$work"/sdcc/*.rel
+			;;
+		gfx-convert|gfx-dedup)
+			if [[ ! -e "$work"/image.png ]]; then
+				generate png image.png
+			fi
+			local flags=()
+			if [[ "$1" = gfx-dedup ]]; then
+				flags=(-m)
+			fi
+			measure "$1" "$RGBGFX" "${flags[@]}" -n 48 -o "$work"/image.2bpp -t "$work"/image.tilemap \
+				-p "$work"/image.pal "$work"/image.png
+			;;
+		fix-rom)
+			generate rom rom.gb
+			measure "$1" "$RGBFIX" -v -p 0xFF -o "$work"/fixed.gb "$work"/rom.gb
+			;;
+		*)
+			echo "Unknown benchmark \"$1\"" >&2
+			exit 1
+			;;
+	esac
+}
+
+results="{\"version\": \"$("$RGBASM" -V)\", \"scale\": $scale, \"benchmarks\": ["
+separator=
+for benchmark in "${selected[@]}"; do
+	results+="$separator"$'\n'"  $(runBenchmark "$benchmark")"
+	separator=,
+done
+results+=$'\n'"]}"
+
+if [[ -n "$output" ]]; then
+	echo "$results" >"$output"
+else
+	echo "$results"
+fi
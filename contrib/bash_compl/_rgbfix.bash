@@ -26,6 +26,10 @@ _rgbfix_completions() {
 		[r]="ram-size:unk"
 		[t]="title:unk"
 	)
+	# Same format, for options that only have a long form
+	declare -a long_opts=(
+		"jobs:unk"
+	)
 	# Parse command-line up to current word
 	local opt_ena=true
 	# Possible states:
@@ -73,7 +77,7 @@ _rgbfix_completions() {
 		# Check if it's a long option
 		if [[ "$word" = '--'* ]]; then
 			# If the option is unknown, assume it takes no arguments: keep the state at "normal"
-			for long_opt in "${opts[@]}"; do
+			for long_opt in "${opts[@]}" "${long_opts[@]}"; do
 				if [[ "$word" = "--${long_opt%%:*}" ]]; then
 					state="${long_opt#*:}"
 					# Check if the next word is just '='; if so, skip it, the argument must follow
@@ -115,7 +119,7 @@ _rgbfix_completions() {
 		# Is this a long option?
 		if [[ "$cur_word" = '--'* ]]; then
 			# It is, try to complete one
-			mapfile -t COMPREPLY < <(compgen -W "${opts[*]%%:*}" -P '--' -- "${cur_word#--}")
+			mapfile -t COMPREPLY < <(compgen -W "${opts[*]%%:*} ${long_opts[*]%%:*}" -P '--' -- "${cur_word#--}")
 			return 0
 		else
 			# Short options may be grouped, parse them to determine what to complete
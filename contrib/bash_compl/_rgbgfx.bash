@@ -24,6 +24,7 @@ _rgbgfx_completions() {
 		[c]="colors:unk"
 		[d]="depth:unk"
 		[i]="input-tileset:glob-*.2bpp"
+		[j]="jobs:unk"
 		[L]="slice:unk"
 		[N]="nb-tiles:unk"
 		[n]="nb-palettes:unk"
@@ -39,6 +40,15 @@ _rgbgfx_completions() {
 		[W]="warning:warning"
 		[x]="trim-end:unk"
 	)
+	# Same format, for options that only have a long form
+	declare -a long_opts=(
+		"batch:glob-*"
+		"shared-palettes:normal"
+		"shared-tileset:normal"
+		"pack-seed:unk"
+		"pack-tries:unk"
+		"cache-dir:dir"
+	)
 	# Parse command-line up to current word
 	local opt_ena=true
 	# Possible states:
@@ -86,7 +96,7 @@ _rgbgfx_completions() {
 		# Check if it's a long option
 		if [[ "$word" = '--'* ]]; then
 			# If the option is unknown, assume it takes no arguments: keep the state at "normal"
-			for long_opt in "${opts[@]}"; do
+			for long_opt in "${opts[@]}" "${long_opts[@]}"; do
 				if [[ "$word" = "--${long_opt%%:*}" ]]; then
 					state="${long_opt#*:}"
 					# Check if the next word is just '='; if so, skip it, the argument must follow
@@ -128,7 +138,7 @@ _rgbgfx_completions() {
 		# Is this a long option?
 		if [[ "$cur_word" = '--'* ]]; then
 			# It is, try to complete one
-			mapfile -t COMPREPLY < <(compgen -W "${opts[*]%%:*}" -P '--' -- "${cur_word#--}")
+			mapfile -t COMPREPLY < <(compgen -W "${opts[*]%%:*} ${long_opts[*]%%:*}" -P '--' -- "${cur_word#--}")
 			return 0
 		else
 			# Short options may be grouped, parse them to determine what to complete
@@ -10,10 +10,15 @@ _rgblink_completions() {
 		[V]="version:normal"
 		[h]="help:normal"
 		[d]="dmg:normal"
+		[F]="fold-sections:normal"
+		[g]="gc-sections:normal"
 		[t]="tiny:normal"
 		[v]="verbose:normal"
 		[w]="wramx:normal"
 		[x]="nopad:normal"
+		[a]="archive:glob-*.a"
+		[i]="incremental:glob-*"
+		[k]="keep:unk"
 		[l]="linkerscript:glob-*"
 		[M]="no-sym-in-map:normal"
 		[m]="map:glob-*.map"
@@ -23,6 +28,27 @@ _rgblink_completions() {
 		[p]="pad:unk"
 		[W]="warning:warning"
 	)
+	# Same format, for options that only have a long form
+	declare -a long_opts=(
+		"stats:normal"
+		"map-json:glob-*.json"
+		"color-only:normal"
+		"color-compatible:normal"
+		"fix-spec:unk"
+		"game-id:unk"
+		"non-japanese:normal"
+		"new-licensee:unk"
+		"logo:glob-*.1bpp"
+		"old-licensee:unk"
+		"mbc-type:unk"
+		"rom-version:unk"
+		"overwrite:normal"
+		"pad-value:unk"
+		"ram-size:unk"
+		"sgb-compatible:normal"
+		"title:unk"
+		"validate:normal"
+	)
 	# Parse command-line up to current word
 	local opt_ena=true
 	# Possible states:
@@ -70,7 +96,7 @@ _rgblink_completions() {
 		# Check if it's a long option
 		if [[ "$word" = '--'* ]]; then
 			# If the option is unknown, assume it takes no arguments: keep the state at "normal"
-			for long_opt in "${opts[@]}"; do
+			for long_opt in "${opts[@]}" "${long_opts[@]}"; do
 				if [[ "$word" = "--${long_opt%%:*}" ]]; then
 					state="${long_opt#*:}"
 					# Check if the next word is just '='; if so, skip it, the argument must follow
@@ -112,7 +138,7 @@ _rgblink_completions() {
 		# Is this a long option?
 		if [[ "$cur_word" = '--'* ]]; then
 			# It is, try to complete one
-			mapfile -t COMPREPLY < <(compgen -W "${opts[*]%%:*}" -P '--' -- "${cur_word#--}")
+			mapfile -t COMPREPLY < <(compgen -W "${opts[*]%%:*} ${long_opts[*]%%:*}" -P '--' -- "${cur_word#--}")
 			return 0
 		else
 			# Short options may be grouped, parse them to determine what to complete
@@ -12,15 +12,50 @@
 
 struct Symbol;
 
+// Why an expression's value is not known at assembly time.
+// This is only rendered into text if the expression is required to be constant.
+struct UnknownReason {
+	enum Kind : uint8_t {
+		SYMBOL,             // `sym` is not constant
+		SYMBOL_PURGED,      // `sym` is not constant; it was purged
+		PC,                 // PC is not constant
+		BANK_SYMBOL,        // `sym`'s bank is not known
+		BANK_SYMBOL_PURGED, // `sym`'s bank is not known; it was purged
+		BANK_SELF,          // The current section's bank is not known
+		BANK_SECTION,       // `sectName`'s bank is not known
+		SIZEOF_SECTION,     // `sectName`'s size is not known
+		STARTOF_SECTION,    // `sectName`'s start is not known
+		SIZEOF_SECTTYPE,    // A section type's size is not known
+		STARTOF_SECTTYPE,   // A section type's start is not known
+	} kind;
+	Symbol const *sym = nullptr;
+	char const *sectName = nullptr; // Sections may be referenced before they are defined
+
+	std::string describe() const;
+};
+
+// A node of an expression's tree; it is only flattened to RPN bytes when a patch or assertion
+// is created, so that building long expressions does not repeatedly copy their operands.
+struct RPNNode {
+	RPNCommand command;
+	uint8_t byte;         // Section type for `RPN_*_SECTTYPE`, mask for `RPN_BIT_INDEX`
+	uint32_t value;       // For `RPN_CONST`
+	Symbol *sym;          // For `RPN_SYM` and `RPN_BANK_SYM`
+	char const *sectName; // For `RPN_*_SECT`
+	uint32_t lhs;         // Index of the (first) operand in `rpnNodes`, `UINT32_MAX` if none
+	uint32_t rhs;         // Index of the second operand in `rpnNodes`, `UINT32_MAX` if none
+};
+
+// All expression nodes built during assembly, never freed since expressions may share them
+extern std::vector<RPNNode> rpnNodes;
+
 struct Expression {
 	std::variant<
-	    int32_t,    // If the expression's value is known, it's here
-	    std::string // Why the expression is not known, if it isn't
+	    int32_t,      // If the expression's value is known, it's here
+	    UnknownReason // Why the expression is not known, if it isn't
 	    >
 	    data = 0;
-	bool isSymbol = false; // Whether the expression represents a symbol suitable for const diffing
-	std::vector<uint8_t> rpn{}; // Bytes serializing the RPN expression
-	uint32_t rpnPatchSize = 0;  // Size the expression will take in the object file
+	uint32_t rpnRoot = UINT32_MAX; // Index of the expression's root in `rpnNodes`, if not known
 
 	bool isKnown() const { return std::holds_alternative<int32_t>(data); }
 	int32_t value() const { return std::get<int32_t>(data); }
@@ -48,8 +83,7 @@ struct Expression {
 
 private:
 	void clear();
-	uint8_t *reserveSpace(uint32_t size);
-	uint8_t *reserveSpace(uint32_t size, uint32_t patchSize);
+	void makeNode(RPNNode const &node);
 };
 
 bool checkNBit(int32_t v, uint8_t n, char const *name);
@@ -16,6 +16,16 @@
 #include "helpers.hpp"
 #include "itertools.hpp"
 
+// Where diagnostics are printed; `nullptr` means `stderr`.
+// RGBGFX's batch jobs each print to their own file, so that their diagnostics stay together.
+extern thread_local FILE *diagnosticsFile;
+static inline FILE *diagnosticsOutput() {
+	return diagnosticsFile ? diagnosticsFile : stderr;
+}
+
+// How many warnings `warnx` has printed on this thread
+extern thread_local uintmax_t nbWarnxPrinted;
+
 [[gnu::format(printf, 1, 2)]]
 void warnx(char const *fmt, ...);
 
@@ -0,0 +1,10 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_GFX_CACHE_HPP
+#define RGBDS_GFX_CACHE_HPP
+
+// Same as `process()`, but if an identical conversion is stored in `cacheDir`, its outputs are
+// copied from there instead; otherwise, the conversion's outputs get stored there.
+void processCached(char const *cacheDir);
+
+#endif // RGBDS_GFX_CACHE_HPP
@@ -47,6 +47,8 @@ struct Options {
 	std::array<uint16_t, 2> maxNbTiles{UINT16_MAX, 0}; // -N
 	uint16_t nbPalettes = 8;                           // -n
 	std::string output{};                              // -o
+	uint16_t packSeed = 0;                             // --pack-seed
+	uint16_t packTries = 1;                            // --pack-tries
 	std::string palettes{};                            // -p, -P
 	std::string palmap{};                              // -q, -Q
 	uint16_t reversedWidth = 0;                        // -r, in tiles
@@ -78,7 +80,7 @@ struct Options {
 	}
 };
 
-extern Options options;
+extern thread_local Options options;
 
 // Prints the error count, and exits with failure
 [[noreturn]]
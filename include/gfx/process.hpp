@@ -3,7 +3,14 @@
 #ifndef RGBDS_GFX_PROCESS_HPP
 #define RGBDS_GFX_PROCESS_HPP
 
+#include <vector>
+
+struct Options;
+
 void processPalettes();
 void process();
+// Converts several images, deduplicating all of their tiles into a single tileset.
+// Each image is converted with its own options, which must agree on those affecting the tileset.
+void processSharedTileset(std::vector<Options> const &images, bool sharedPalettes);
 
 #endif // RGBDS_GFX_PROCESS_HPP
@@ -3,7 +3,9 @@
 #ifndef RGBDS_GFX_PROTO_PALETTE_HPP
 #define RGBDS_GFX_PROTO_PALETTE_HPP
 
+#include <algorithm>
 #include <array>
+#include <iterator>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -28,11 +30,14 @@ public:
 	};
 	ComparisonResult compare(ProtoPalette const &other) const;
 
-	size_t size() const;
-	bool empty() const;
+	// These are called in the packing algorithms' innermost loops, so they are kept inline
+	size_t size() const { return std::distance(begin(), end()); }
+	bool empty() const { return _colorIndices[0] == UINT16_MAX; }
 
-	decltype(_colorIndices)::const_iterator begin() const;
-	decltype(_colorIndices)::const_iterator end() const;
+	decltype(_colorIndices)::const_iterator begin() const { return _colorIndices.begin(); }
+	decltype(_colorIndices)::const_iterator end() const {
+		return std::find(_colorIndices.begin(), _colorIndices.end(), UINT16_MAX);
+	}
 };
 
 #endif // RGBDS_GFX_PROTO_PALETTE_HPP
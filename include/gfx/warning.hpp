@@ -20,16 +20,31 @@ enum WarningID {
 	NB_WARNINGS = NB_PLAIN_WARNINGS,
 };
 
-extern Diagnostics<WarningLevel, WarningID> warnings;
+extern thread_local Diagnostics<WarningLevel, WarningID> warnings;
+
+// Thrown by failing conversions instead of exiting, while `isInBatchJob` is set, so that batch
+// jobs are isolated from each other (and everything the failed job allocated is released)
+struct JobAbort {};
+extern thread_local bool isInBatchJob;
 
 // Warns the user about problems that don't prevent valid graphics conversion
 [[gnu::format(printf, 2, 3)]]
 void warning(WarningID id, char const *fmt, ...);
 
+// Returns how many warnings (not counting errors) have been printed thus far on this thread
+uintmax_t nbWarningsPrinted();
+
+// Exits with failure, or throws `JobAbort` if in a batch job
+[[noreturn]]
+void abortConversion();
+
 // Prints the error count, and exits with failure
 [[noreturn]]
 void giveUp();
 
+// Forgets about the errors emitted thus far, e.g. by a previous batch job
+void resetErrors();
+
 // If any error has been emitted thus far, calls `giveUp()`
 void requireZeroErrors();
 
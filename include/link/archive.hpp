@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_LINK_ARCHIVE_HPP
+#define RGBDS_LINK_ARCHIVE_HPP
+
+// Archives bundle object files, whose members are only linked if they define a needed symbol
+// or section.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Write an archive of the given object files, indexing the symbols they export and the sections
+// they define.
+void ar_WriteArchive(char const *fileName, std::vector<char const *> const &memberNames);
+
+// Read an archive's index. Its contents must outlive the link, to read members from it later.
+void ar_ReadArchive(uint8_t const *data, size_t size, char const *fileName);
+
+// Read all archive members that define a symbol imported by an already-read object file, or a
+// piece of a section that one refers to by name, until no more are needed.
+void ar_LoadNeededMembers();
+
+// Read all archive members that define a piece of the section named `name`, along with the
+// members that they need in turn; for sections that the linker script places.
+void ar_LoadSectionMembers(std::string const &name);
+
+#endif // RGBDS_LINK_ARCHIVE_HPP
@@ -4,10 +4,20 @@
 #define RGBDS_LINK_ASSIGN_HPP
 
 #include <stdint.h>
+#include <vector>
+
+struct Section;
 
 extern uint64_t nbSectionsToAssign;
 
 // Assigns all sections a slice of the address space
 void assign_AssignSections();
 
+// Places a section at a given location, without checking that it is suitable
+void assign_PlaceSectionAt(Section &section, uint32_t bank, uint16_t org);
+
+// The sections placed so far, in the order they were placed (which the output files depend on,
+// for sections at the same address)
+std::vector<Section const *> const &assign_PlacedSections();
+
 #endif // RGBDS_LINK_ASSIGN_HPP
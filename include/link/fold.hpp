@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_LINK_FOLD_HPP
+#define RGBDS_LINK_FOLD_HPP
+
+// Replaces identical floating ROM sections by a single one of them
+void fold_FoldSections();
+
+// Gives folded sections the location of the section that replaced them
+void fold_PlaceFoldedSections();
+
+#endif // RGBDS_LINK_FOLD_HPP
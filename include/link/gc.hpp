@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_LINK_GC_HPP
+#define RGBDS_LINK_GC_HPP
+
+// Removes the sections that cannot be reached from any root section
+void gc_RemoveUnreferencedSections();
+
+#endif // RGBDS_LINK_GC_HPP
@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_LINK_INCREMENTAL_HPP
+#define RGBDS_LINK_INCREMENTAL_HPP
+
+// Places all sections where the previous link placed them, if nothing that affects placement
+// changed since then. Returns whether it did; otherwise, sections must be assigned normally.
+bool incr_ReuseLayout();
+
+// Saves the sections' placement, for the next link to reuse
+void incr_SaveLayout();
+
+#endif // RGBDS_LINK_INCREMENTAL_HPP
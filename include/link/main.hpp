@@ -12,9 +12,15 @@
 #include "linkdefs.hpp"
 
 // Variables related to CLI options
+extern char const *archiveName;
 extern bool isDmgMode;
+extern bool foldSections;
+extern bool gcSections;
+extern char const *incrementalStateName;
+extern std::vector<char const *> keepSymbols;
 extern char const *linkerScriptName;
 extern char const *mapFileName;
+extern char const *mapJSONFileName;
 extern bool noSymInMap;
 extern char const *symFileName;
 extern char const *overlayFileName;
@@ -24,6 +30,8 @@ extern bool hasPadValue;
 extern uint16_t scrambleROMX;
 extern uint8_t scrambleWRAMX;
 extern uint8_t scrambleSRAM;
+extern bool printStats;
+extern bool statsAsJSON;
 extern bool is32kMode;
 extern bool beVerbose;
 extern bool isWRAM0Mode;
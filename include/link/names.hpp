@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_LINK_NAMES_HPP
+#define RGBDS_LINK_NAMES_HPP
+
+// Symbol and section names are interned, so that they can be compared by ID.
+
+#include <stdint.h>
+#include <string_view>
+
+// Returns the ID of `name` (whose `hashName` is `hash`), interning it if it was not already.
+// Returns `UINT32_MAX` if `hash` is not `name`'s (e.g. when read from a corrupted file).
+uint32_t name_Intern(std::string_view name, uint64_t hash);
+
+// Returns the ID of `name`, or `UINT32_MAX` if it has not been interned.
+uint32_t name_Find(std::string_view name, uint64_t hash);
+
+#endif // RGBDS_LINK_NAMES_HPP
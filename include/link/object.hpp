@@ -3,9 +3,31 @@
 #ifndef RGBDS_LINK_OBJECT_HPP
 #define RGBDS_LINK_OBJECT_HPP
 
+#include <stddef.h>
+#include <stdint.h>
+
+struct Section;
+struct Symbol;
+
 // Read an object (.o) file, and add its info to the data structures.
 void obj_ReadFile(char const *fileName, unsigned int fileID);
 
+// Read an archive member, whose contents must outlive the link
+void obj_ReadMember(uint8_t const *data, size_t size, char const *memberName);
+
+// Read an object file's symbols and sections, and call the corresponding callback on each of them,
+// without linking them
+void obj_ReadIndex(
+    uint8_t const *data,
+    size_t size,
+    char const *fileName,
+    void (*onSymbol)(Symbol const &),
+    void (*onSection)(Section const &)
+);
+
+// Calls `callback` on each symbol of each object file, in the order they were read
+void obj_ForEachSymbol(void (*callback)(Symbol const &));
+
 // Sets up object file reading
 void obj_Setup(unsigned int nbFiles);
 
@@ -3,12 +3,14 @@
 #ifndef RGBDS_LINK_SDAS_OBJ_HPP
 #define RGBDS_LINK_SDAS_OBJ_HPP
 
-#include <stdio.h>
+#include <stddef.h>
 #include <vector>
 
 struct FileStackNode;
 struct Symbol;
 
-void sdobj_ReadFile(FileStackNode const &where, FILE *file, std::vector<Symbol> &fileSymbols);
+void sdobj_ReadFile(
+    FileStackNode const &where, char const *contents, size_t size, std::vector<Symbol> &fileSymbols
+);
 
 #endif // RGBDS_LINK_SDAS_OBJ_HPP
@@ -7,6 +7,7 @@
 
 #include <deque>
 #include <memory>
+#include <span>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -27,12 +28,13 @@ struct Patch {
 	uint32_t pcSectionID;
 	uint32_t pcOffset;
 	PatchType type;
-	std::vector<uint8_t> rpnExpression;
+	std::span<uint8_t const> rpnExpression; // Points into the object file's contents
 };
 
 struct Section {
 	// Info contained in the object files
 	std::string name;
+	uint32_t nameID; // Interned `name`
 	uint16_t size;
 	uint16_t offset;
 	SectionType type;
@@ -51,6 +53,8 @@ struct Section {
 	std::vector<uint8_t> data; // Array of size `size`, or 0 if `type` does not have data
 	std::vector<Patch> patches;
 	// Extra info computed during linking
+	bool isKept; // Whether the linker script places this section, so it may not be removed
+	Section const *foldedInto; // The identical section that replaces this one, if any
 	std::vector<Symbol> *fileSymbols;
 	std::vector<Symbol *> symbols;
 	std::unique_ptr<Section> nextu; // The next "component" of this unionized sect
@@ -72,8 +76,15 @@ void sect_ForEach(void (*callback)(Section &));
 // Registers a section to be processed.
 void sect_AddSection(std::unique_ptr<Section> &&section);
 
+// Removes the sections for which `isRemoved` returns true, and returns how many there were.
+size_t sect_RemoveSections(bool (*isRemoved)(Section const &));
+
+// Execute a callback for each section removed by `sect_RemoveSections`, in the order they were read.
+void sect_ForEachRemoved(void (*callback)(Section const &));
+
 // Finds a section by its name.
 Section *sect_GetSection(std::string const &name);
+Section *sect_GetSection(uint32_t nameID);
 
 // Checks if all sections meet reasonable criteria, such as max size
 void sect_DoSanityChecks();
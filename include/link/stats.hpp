@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_LINK_STATS_HPP
+#define RGBDS_LINK_STATS_HPP
+
+#include <stdint.h>
+
+// Counters that cannot be computed from the final state of the link, for `--stats`
+extern struct LinkStats {
+	uint32_t nbObjects;         // Object files and archive members read
+	uint64_t nbRPNBytes;        // Bytes of RPN expressions evaluated
+	uint64_t nbFreeSpaceChecks; // Free space blocks checked while placing sections
+} linkStats;
+
+// Ends the current phase, if any, and begins timing the next one.
+// The report is printed when the program exits, after the last phase ends.
+void stats_BeginPhase(char const *name);
+
+#endif // RGBDS_LINK_STATS_HPP
@@ -24,6 +24,7 @@ struct Label {
 struct Symbol {
 	// Info contained in the object files
 	std::string name;
+	uint32_t nameID; // Interned name, or `UINT32_MAX` for local symbols, which are never looked up
 	ExportLevel type;
 	FileStackNode const *src;
 	int32_t lineNo;
@@ -43,6 +44,7 @@ void sym_AddSymbol(Symbol &symbol);
 
 // Finds a symbol in all the defined symbols.
 Symbol *sym_GetSymbol(std::string const &name);
+Symbol *sym_GetSymbol(uint32_t nameID);
 
 void sym_DumpLocalAliasedSymbols(std::string const &name);
 
@@ -5,11 +5,17 @@
 
 #include <stdint.h>
 #include <string>
+#include <string_view>
 
 #include "helpers.hpp" // assume
 
-#define RGBDS_OBJECT_VERSION_STRING "RGB9"
-#define RGBDS_OBJECT_REV            12U
+#define RGBDS_OBJECT_VERSION_STRING   "RGB9"
+#define RGBDS_OBJECT_REV              15U
+#define RGBDS_OBJECT_REV_INLINE_NAMES 12U // The last revision without a string table
+#define RGBDS_OBJECT_REV_INLINE_DATA  13U // The last revision without a separate data area
+#define RGBDS_OBJECT_REV_NO_OFFSETS   14U // The last revision without the tables' offsets
+#define RGBDS_ARCHIVE_VERSION_STRING  "RGBA"
+#define RGBDS_ARCHIVE_REV             2U
 
 enum AssertionType { ASSERT_WARN, ASSERT_ERROR, ASSERT_FATAL };
 
@@ -116,6 +122,9 @@ extern char const * const sectionModNames[];
 
 enum ExportLevel { SYMTYPE_LOCAL, SYMTYPE_IMPORT, SYMTYPE_EXPORT };
 
+// Hashes a symbol or section name (64-bit FNV-1a), so that it can be computed only once
+uint64_t hashName(std::string_view name);
+
 enum PatchType {
 	PATCHTYPE_BYTE,
 	PATCHTYPE_WORD,
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_MAPPING_HPP
+#define RGBDS_MAPPING_HPP
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+// Maps a file's `size` bytes of contents in memory for reading, or returns `nullptr` if that is
+// not possible (e.g. for pipes). The mapping is released along with the last pointer to it.
+// If `verbose`, falling back to a shared mapping is reported.
+std::shared_ptr<char[]> mapFile(int fd, std::string const &path, size_t size, bool verbose);
+
+#endif // RGBDS_MAPPING_HPP
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef RGBDS_ROMHEADER_HPP
+#define RGBDS_ROMHEADER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The header-fixing options of RGBFIX, which RGBLINK also accepts to fix the ROM it outputs.
+
+static constexpr uint16_t UNSPECIFIED = 0x200;
+static_assert(UNSPECIFIED > 0xFF, "UNSPECIFIED should not be in byte range!");
+
+// Each program using this defines its own, which counts the error.
+[[gnu::format(printf, 1, 2)]]
+void error(char const *fmt, ...);
+
+// Parses one of RGBFIX's header options, given as RGBFIX's short option character; `optName` is
+// how the option is called in messages. Returns false if `option` is not a header option.
+bool header_ParseOption(char option, char const *arg, char const *optName);
+// Checks that the header options are consistent, and reads the logo.
+// Must be called after parsing all options, and before fixing any headers.
+void header_FinishOptions();
+
+// Whether any header option was given
+bool header_IsFixing();
+// The size of the header that the options may modify (TPP1's is larger)
+uint16_t header_Size();
+// The value that the ROM must be padded with, or `UNSPECIFIED` if it must not be padded
+uint16_t header_PadValue();
+// Whether the global checksum needs to be computed
+bool header_FixesGlobalSum();
+
+// Returns the sum of `len` bytes, modulo 65536 like the global checksum.
+uint16_t header_SumBytes(uint8_t const *data, size_t len);
+
+// Writes the header fields that the options specify to `rom0`, except for the ROM size and the
+// checksums, which depend on the rest of the ROM.
+void header_Overwrite(uint8_t *rom0);
+// Returns how many banks a ROM of `nbBanks` banks must be padded to, and writes that ROM size.
+uint32_t header_PadROMSize(uint8_t *rom0, uint32_t nbBanks);
+// Writes the checksums that the options ask for. `rom0` contains the ROM's first `rom0Len` bytes
+// (at least the header), and `restSum` is the sum of all the others, including any padding.
+void header_FixChecksums(uint8_t *rom0, size_t rom0Len, uint16_t restSum);
+
+#endif // RGBDS_ROMHEADER_HPP
@@ -10,9 +10,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "diagnostics.hpp"
-#include "helpers.hpp" // assume, Defer
+#include "helpers.hpp" // assume, clz, ctz, Defer
+#include "opmath.hpp"
 #include "platform.hpp"
 
 #include "asm/charmap.hpp"
@@ -39,19 +42,67 @@ static std::deque<Assertion> assertions;
 
 static std::deque<std::shared_ptr<FileStackNode>> fileStackNodes;
 
-static void putLong(uint32_t n, FILE *file) {
+// Symbol and section names, each written once to the object file
+static std::vector<std::string const *> objectStrings;
+static std::unordered_map<std::string_view, uint32_t> objectStringIDs; // Indexes into the above
+
+// The object file's tables are built in memory, so that the header can tell where each one starts
+using ObjectTable = std::vector<uint8_t>;
+
+static void putByte(uint8_t n, ObjectTable &table) {
+	table.push_back(n);
+}
+
+static void putLong(uint32_t n, ObjectTable &table) {
 	uint8_t bytes[] = {
 	    static_cast<uint8_t>(n),
 	    static_cast<uint8_t>(n >> 8),
 	    static_cast<uint8_t>(n >> 16),
 	    static_cast<uint8_t>(n >> 24),
 	};
-	fwrite(bytes, 1, sizeof(bytes), file);
+	table.insert(table.end(), RANGE(bytes));
+}
+
+static void putString(std::string const &s, ObjectTable &table) {
+	// Like `fputs`, stop at the first NUL
+	table.insert(table.end(), s.c_str(), s.c_str() + strlen(s.c_str()) + 1);
 }
 
-static void putString(std::string const &s, FILE *file) {
-	fputs(s.c_str(), file);
-	putc('\0', file);
+// Returns the ID of a string in the object file's string table, adding it if necessary
+static uint32_t getStringID(std::string const &s) {
+	auto [search, inserted] = objectStringIDs.try_emplace(s, objectStrings.size());
+	if (inserted) {
+		objectStrings.push_back(&s);
+	}
+	return search->second;
+}
+
+static void writeString(std::string const &s, ObjectTable &table) {
+	uint64_t hash = hashName(s.c_str()); // Only hash what `putString` will write
+
+	putLong(hash, table);
+	putLong(hash >> 32, table);
+	putString(s, table);
+}
+
+// Section data and RPN expressions are written to a separate area at the end of the object file,
+// each one aligned to 4 bytes, in the same order as the sections and assertions referring to them
+static uint32_t blobOffset;
+
+static uint32_t getBlobSize(size_t size) {
+	return (size + 3) & ~3;
+}
+
+static void putBlobOffset(size_t size, ObjectTable &table) {
+	putLong(blobOffset, table);
+	blobOffset += getBlobSize(size);
+}
+
+static void writeBlob(uint8_t const *data, size_t size, FILE *file) {
+	static uint8_t const padding[3] = {};
+
+	fwrite(data, 1, size, file);
+	fwrite(padding, 1, getBlobSize(size) - size, file);
 }
 
 void out_RegisterNode(std::shared_ptr<FileStackNode> node) {
@@ -80,61 +131,62 @@ static uint32_t getSectIDIfAny(Section *sect) {
 	fatal("Unknown section '%s'", sect->name.c_str()); // LCOV_EXCL_LINE
 }
 
-static void writePatch(Patch const &patch, FILE *file) {
+static void writePatch(Patch const &patch, ObjectTable &table) {
 	assume(patch.src->ID != UINT32_MAX);
 
-	putLong(patch.src->ID, file);
-	putLong(patch.lineNo, file);
-	putLong(patch.offset, file);
-	putLong(getSectIDIfAny(patch.pcSection), file);
-	putLong(patch.pcOffset, file);
-	putc(patch.type, file);
-	putLong(patch.rpn.size(), file);
-	fwrite(patch.rpn.data(), 1, patch.rpn.size(), file);
+	putLong(patch.src->ID, table);
+	putLong(patch.lineNo, table);
+	putLong(patch.offset, table);
+	putLong(getSectIDIfAny(patch.pcSection), table);
+	putLong(patch.pcOffset, table);
+	putByte(patch.type, table);
+	putLong(patch.rpn.size(), table);
+	putBlobOffset(patch.rpn.size(), table);
 }
 
-static void writeSection(Section const &sect, FILE *file) {
+// Writes a section to the section table, and its patches to the patch table
+static void writeSection(Section const &sect, ObjectTable &table, ObjectTable &patchTable) {
 	assume(sect.src->ID != UINT32_MAX);
 
-	putString(sect.name, file);
+	putLong(getStringID(sect.name), table);
 
-	putLong(sect.src->ID, file);
-	putLong(sect.fileLine, file);
+	putLong(sect.src->ID, table);
+	putLong(sect.fileLine, table);
 
-	putLong(sect.size, file);
+	putLong(sect.size, table);
 
 	bool isUnion = sect.modifier == SECTION_UNION;
 	bool isFragment = sect.modifier == SECTION_FRAGMENT;
 
-	putc(sect.type | isUnion << 7 | isFragment << 6, file);
+	putByte(sect.type | isUnion << 7 | isFragment << 6, table);
 
-	putLong(sect.org, file);
-	putLong(sect.bank, file);
-	putc(sect.align, file);
-	putLong(sect.alignOfs, file);
+	putLong(sect.org, table);
+	putLong(sect.bank, table);
+	putByte(sect.align, table);
+	putLong(sect.alignOfs, table);
 
 	if (sect_HasData(sect.type)) {
-		fwrite(sect.data.data(), 1, sect.size, file);
-		putLong(sect.patches.size(), file);
+		putBlobOffset(sect.size, table);
+		putLong(sect.patches.size(), table);
 
 		for (Patch const &patch : sect.patches) {
-			writePatch(patch, file);
+			writePatch(patch, patchTable);
 		}
 	}
 }
 
-static void writeSymbol(Symbol const &sym, FILE *file) {
-	putString(sym.name, file);
+static void writeSymbol(Symbol const &sym, ObjectTable &table) {
+	putLong(getStringID(sym.name), table);
 	if (!sym.isDefined()) {
-		putc(SYMTYPE_IMPORT, file);
+		putByte(SYMTYPE_IMPORT, table);
 	} else {
 		assume(sym.src->ID != UINT32_MAX);
 
-		putc(sym.isExported ? SYMTYPE_EXPORT : SYMTYPE_LOCAL, file);
-		putLong(sym.src->ID, file);
-		putLong(sym.fileLine, file);
-		putLong(getSectIDIfAny(sym.getSection()), file);
-		putLong(sym.getOutputValue(), file);
+		putByte(sym.isExported ? SYMTYPE_EXPORT : SYMTYPE_LOCAL, table);
+		putLong(sym.src->ID, table);
+		putLong(sym.fileLine, table);
+		putLong(getSectIDIfAny(sym.getSection()), table);
+		putLong(sym.getOutputValue(), table);
 	}
 }
 
@@ -147,101 +199,76 @@ static void registerUnregisteredSymbol(Symbol &sym) {
 	}
 }
 
-static void writeRpn(std::vector<uint8_t> &rpnexpr, std::vector<uint8_t> const &rpn) {
-	std::string symName;
-	size_t rpnptr = 0;
-
-	for (size_t offset = 0; offset < rpn.size();) {
-		uint8_t rpndata = rpn[offset++];
+static void putRpnLong(std::vector<uint8_t> &rpnexpr, uint32_t value) {
+	rpnexpr.push_back(value & 0xFF);
+	rpnexpr.push_back(value >> 8);
+	rpnexpr.push_back(value >> 16);
+	rpnexpr.push_back(value >> 24);
+}
 
-		switch (rpndata) {
-			Symbol *sym;
-			uint32_t value;
-			uint8_t b;
+// Flattens an expression's tree into RPN bytes, operands first
+static void writeRpn(std::vector<uint8_t> &rpnexpr, uint32_t root) {
+	// Iterate instead of recursing, since long expressions make for deep trees.
+	// The stack is `static` so that its storage is reused by every patch.
+	static std::vector<std::pair<uint32_t, bool>> stack;
+	stack.assign({{root, false}});
+
+	while (!stack.empty()) {
+		auto [index, operandsWritten] = stack.back();
+		RPNNode const &node = rpnNodes[index];
+
+		if (!operandsWritten) {
+			stack.back().second = true;
+			if (node.rhs != UINT32_MAX) {
+				stack.emplace_back(node.rhs, false);
+			}
+			if (node.lhs != UINT32_MAX) {
+				stack.emplace_back(node.lhs, false);
+			}
+			continue;
+		}
+		stack.pop_back();
 
+		switch (node.command) {
 		case RPN_CONST:
-			rpnexpr[rpnptr++] = RPN_CONST;
-			rpnexpr[rpnptr++] = rpn[offset++];
-			rpnexpr[rpnptr++] = rpn[offset++];
-			rpnexpr[rpnptr++] = rpn[offset++];
-			rpnexpr[rpnptr++] = rpn[offset++];
+			rpnexpr.push_back(RPN_CONST);
+			putRpnLong(rpnexpr, node.value);
 			break;
 
 		case RPN_SYM:
-			symName.clear();
-			for (;;) {
-				uint8_t c = rpn[offset++];
-				if (c == 0) {
-					break;
-				}
-				symName += c;
-			}
-
-			// The symbol name is always written expanded
-			sym = sym_FindExactSymbol(symName);
-			if (sym->isConstant()) {
-				rpnexpr[rpnptr++] = RPN_CONST;
-				value = sym->getConstantValue();
+			if (node.sym->isConstant()) {
+				rpnexpr.push_back(RPN_CONST);
+				putRpnLong(rpnexpr, node.sym->getConstantValue());
 			} else {
-				rpnexpr[rpnptr++] = RPN_SYM;
-				registerUnregisteredSymbol(*sym); // Ensure that `sym->ID` is set
-				value = sym->ID;
+				rpnexpr.push_back(RPN_SYM);
+				registerUnregisteredSymbol(*node.sym); // Ensure that `sym->ID` is set
+				putRpnLong(rpnexpr, node.sym->ID);
 			}
-
-			rpnexpr[rpnptr++] = value & 0xFF;
-			rpnexpr[rpnptr++] = value >> 8;
-			rpnexpr[rpnptr++] = value >> 16;
-			rpnexpr[rpnptr++] = value >> 24;
 			break;
 
 		case RPN_BANK_SYM:
-			symName.clear();
-			for (;;) {
-				uint8_t c = rpn[offset++];
-				if (c == 0) {
-					break;
-				}
-				symName += c;
-			}
-
-			// The symbol name is always written expanded
-			sym = sym_FindExactSymbol(symName);
-			registerUnregisteredSymbol(*sym); // Ensure that `sym->ID` is set
-			value = sym->ID;
-
-			rpnexpr[rpnptr++] = RPN_BANK_SYM;
-			rpnexpr[rpnptr++] = value & 0xFF;
-			rpnexpr[rpnptr++] = value >> 8;
-			rpnexpr[rpnptr++] = value >> 16;
-			rpnexpr[rpnptr++] = value >> 24;
+			rpnexpr.push_back(RPN_BANK_SYM);
+			registerUnregisteredSymbol(*node.sym); // Ensure that `sym->ID` is set
+			putRpnLong(rpnexpr, node.sym->ID);
 			break;
 
 		case RPN_BANK_SECT:
-			rpnexpr[rpnptr++] = RPN_BANK_SECT;
-			do {
-				b = rpn[offset++];
-				rpnexpr[rpnptr++] = b;
-			} while (b != 0);
-			break;
-
 		case RPN_SIZEOF_SECT:
-			rpnexpr[rpnptr++] = RPN_SIZEOF_SECT;
-			do {
-				b = rpn[offset++];
-				rpnexpr[rpnptr++] = b;
-			} while (b != 0);
+		case RPN_STARTOF_SECT:
+			rpnexpr.push_back(node.command);
+			// Include the terminating NUL
+			rpnexpr.insert(rpnexpr.end(), node.sectName, node.sectName + strlen(node.sectName) + 1);
 			break;
 
-		case RPN_STARTOF_SECT:
-			rpnexpr[rpnptr++] = RPN_STARTOF_SECT;
-			do {
-				b = rpn[offset++];
-				rpnexpr[rpnptr++] = b;
-			} while (b != 0);
+		case RPN_SIZEOF_SECTTYPE:
+		case RPN_STARTOF_SECTTYPE:
+		case RPN_BIT_INDEX:
+			rpnexpr.push_back(node.command);
+			rpnexpr.push_back(node.byte);
 			break;
 
 		default:
-			rpnexpr[rpnptr++] = rpndata;
+			rpnexpr.push_back(node.command);
 			break;
 		}
 	}
@@ -259,16 +286,10 @@ static void initPatch(Patch &patch, uint32_t type, Expression const &expr, uint3
 
 	if (expr.isKnown()) {
 		// If the RPN expr's value is known, output a constant directly
-		uint32_t val = expr.value();
-		patch.rpn.resize(5);
-		patch.rpn[0] = RPN_CONST;
-		patch.rpn[1] = val & 0xFF;
-		patch.rpn[2] = val >> 8;
-		patch.rpn[3] = val >> 16;
-		patch.rpn[4] = val >> 24;
+		patch.rpn.push_back(RPN_CONST);
+		putRpnLong(patch.rpn, expr.value());
 	} else {
-		patch.rpn.resize(expr.rpnPatchSize);
-		writeRpn(patch.rpn, expr.rpn);
+		writeRpn(patch.rpn, expr.rpnRoot);
 	}
 }
 
@@ -293,24 +314,374 @@ void out_CreateAssert(
 	assertion.message = message;
 }
 
-static void writeAssert(Assertion const &assert, FILE *file) {
-	writePatch(assert.patch, file);
-	putString(assert.message, file);
+// A value computed at the end of assembly. If `section` is set, `value` is an offset relative to
+// that floating section's start, which only RGBLINK can know, so only differences are constant.
+struct ResolvedValue {
+	int32_t value;
+	Section const *section;
+};
+
+static uint32_t readResolveLong(std::vector<uint8_t> const &rpn, size_t &offset) {
+	uint32_t value = 0;
+	for (uint8_t shift = 0; shift < 32; shift += 8) {
+		value |= rpn[offset++] << shift;
+	}
+	return value;
+}
+
+static Section const *readResolveSection(std::vector<uint8_t> const &rpn, size_t &offset) {
+	char const *name = reinterpret_cast<char const *>(&rpn[offset]);
+	offset += strlen(name) + 1;
+	return sect_FindSectionByName(name);
+}
+
+// RGBLINK adds a fragment's offset to the PC of the patches it contains, but not to the PC of
+// assertions, nor of patches whose PC is in another section (i.e. within a `LOAD` block).
+// `owner` is the section containing the patch, or `nullptr` for assertions.
+static bool isPCConsistent(Patch const &patch, Section const *owner) {
+	if (!patch.pcSection) {
+		return false;
+	}
+	return patch.pcSection == owner
+	       || (patch.pcSection->modifier != SECTION_FRAGMENT
+	           && (!owner || owner->modifier != SECTION_FRAGMENT));
 }
 
-static void writeFileStackNode(FileStackNode const &node, FILE *file) {
-	putLong(node.parent ? node.parent->ID : UINT32_MAX, file);
-	putLong(node.lineNo, file);
-	putc(node.type, file);
+// Re-evaluates a patch's RPN, now that every symbol of the file is defined.
+// Returns false if RGBLINK is still needed, either because the value depends on placement, or
+// because evaluating it would report a diagnostic (which is then left to RGBLINK to report).
+static bool resolvePatchValue(Patch const &patch, Section const *owner, ResolvedValue &result) {
+	static std::vector<ResolvedValue> stack; // `static` so that every patch reuses its storage
+	stack.clear();
+
+	for (size_t offset = 0; offset < patch.rpn.size();) {
+		RPNCommand command = static_cast<RPNCommand>(patch.rpn[offset++]);
+		ResolvedValue value{.value = 0, .section = nullptr};
+
+		switch (command) {
+		case RPN_CONST:
+			value.value = readResolveLong(patch.rpn, offset);
+			break;
+
+		case RPN_SYM:
+			if (uint32_t id = readResolveLong(patch.rpn, offset); id == UINT32_MAX) {
+				if (!isPCConsistent(patch, owner)) {
+					return false;
+				} else if (patch.pcSection->org != UINT32_MAX) {
+					value.value = patch.pcSection->org + patch.pcOffset;
+				} else {
+					value.value = patch.pcOffset;
+					value.section = patch.pcSection;
+				}
+			} else if (Symbol const *sym = objectSymbols[id]; sym->isConstant()) {
+				value.value = sym->getValue();
+			} else if (sym->type == SYM_LABEL && sym->getSection()) {
+				value.value = sym->getOutputValue();
+				value.section = sym->getSection();
+			} else {
+				return false;
+			}
+			break;
+
+		case RPN_BANK_SYM:
+			if (Symbol const *sym = objectSymbols[readResolveLong(patch.rpn, offset)];
+			    sym->type == SYM_LABEL && sym->getSection()
+			    && sym->getSection()->bank != UINT32_MAX) {
+				value.value = sym->getSection()->bank;
+			} else {
+				return false;
+			}
+			break;
+
+		case RPN_BANK_SECT:
+			if (Section const *sect = readResolveSection(patch.rpn, offset);
+			    sect && sect->bank != UINT32_MAX) {
+				value.value = sect->bank;
+			} else {
+				return false;
+			}
+			break;
+
+		case RPN_BANK_SELF:
+			if (!patch.pcSection || patch.pcSection->bank == UINT32_MAX) {
+				return false;
+			}
+			value.value = patch.pcSection->bank;
+			break;
+
+		case RPN_SIZEOF_SECT:
+			// Other files may contribute to a `SECTION UNION` or `SECTION FRAGMENT`
+			if (Section const *sect = readResolveSection(patch.rpn, offset);
+			    sect && sect->modifier == SECTION_NORMAL) {
+				value.value = sect->size;
+			} else {
+				return false;
+			}
+			break;
+
+		case RPN_STARTOF_SECT:
+			if (Section const *sect = readResolveSection(patch.rpn, offset);
+			    sect && sect->org != UINT32_MAX) {
+				value.value = sect->org;
+			} else {
+				return false;
+			}
+			break;
+
+		case RPN_STARTOF_SECTTYPE:
+			if (uint8_t type = patch.rpn[offset++]; type < SECTTYPE_INVALID) {
+				value.value = sectionTypeInfo[type].startAddr;
+			} else {
+				return false; // LCOV_EXCL_LINE
+			}
+			break;
+
+		case RPN_SIZEOF_SECTTYPE:
+			// Section type sizes can be changed by RGBLINK's flags
+			return false;
+
+		default: {
+			bool isUnary = command == RPN_NEG || command == RPN_NOT || command == RPN_LOGNOT
+			               || command == RPN_HIGH || command == RPN_LOW || command == RPN_BITWIDTH
+			               || command == RPN_TZCOUNT || command == RPN_HRAM || command == RPN_RST
+			               || command == RPN_BIT_INDEX;
+			if (stack.size() < (isUnary ? 1 : 2)) {
+				return false; // LCOV_EXCL_LINE
+			}
+			ResolvedValue rhs = stack.back();
+			stack.pop_back();
+			ResolvedValue lhs = rhs;
+			if (!isUnary) {
+				lhs = stack.back();
+				stack.pop_back();
+			}
+
+			// Only additive operations can involve section-relative values
+			if (command == RPN_ADD && (!lhs.section || !rhs.section)) {
+				value.value = static_cast<uint32_t>(lhs.value) + static_cast<uint32_t>(rhs.value);
+				value.section = lhs.section ? lhs.section : rhs.section;
+				break;
+			} else if (command == RPN_SUB && (!rhs.section || lhs.section == rhs.section)) {
+				value.value = static_cast<uint32_t>(lhs.value) - static_cast<uint32_t>(rhs.value);
+				value.section = rhs.section ? nullptr : lhs.section;
+				break;
+			} else if (lhs.section || rhs.section) {
+				return false;
+			}
+
+			int32_t lval = lhs.value, rval = rhs.value;
+			uint32_t ulval = static_cast<uint32_t>(lval), urval = static_cast<uint32_t>(rval);
+			switch (command) {
+			case RPN_MUL:
+				value.value = static_cast<int32_t>(ulval * urval);
+				break;
+			case RPN_DIV:
+				if (rval == 0 || (lval == INT32_MIN && rval == -1)) {
+					return false;
+				}
+				value.value = op_divide(lval, rval);
+				break;
+			case RPN_MOD:
+				if (rval == 0) {
+					return false;
+				}
+				value.value = lval == INT32_MIN && rval == -1 ? 0 : op_modulo(lval, rval);
+				break;
+			case RPN_EXP:
+				if (rval < 0) {
+					return false;
+				}
+				value.value = op_exponent(lval, rval);
+				break;
+			case RPN_OR:
+				value.value = lval | rval;
+				break;
+			case RPN_AND:
+				value.value = lval & rval;
+				break;
+			case RPN_XOR:
+				value.value = lval ^ rval;
+				break;
+			case RPN_LOGAND:
+				value.value = lval && rval;
+				break;
+			case RPN_LOGOR:
+				value.value = lval || rval;
+				break;
+			case RPN_LOGEQ:
+				value.value = lval == rval;
+				break;
+			case RPN_LOGNE:
+				value.value = lval != rval;
+				break;
+			case RPN_LOGGT:
+				value.value = lval > rval;
+				break;
+			case RPN_LOGLT:
+				value.value = lval < rval;
+				break;
+			case RPN_LOGGE:
+				value.value = lval >= rval;
+				break;
+			case RPN_LOGLE:
+				value.value = lval <= rval;
+				break;
+			case RPN_SHL:
+			case RPN_SHR:
+			case RPN_USHR:
+				if (rval < 0 || rval >= 32 || (command == RPN_SHR && lval < 0)) {
+					return false;
+				}
+				value.value = command == RPN_SHL   ? op_shift_left(lval, rval)
+				              : command == RPN_SHR ? op_shift_right(lval, rval)
+				                                   : op_shift_right_unsigned(lval, rval);
+				break;
+			case RPN_NEG:
+				value.value = static_cast<int32_t>(-urval);
+				break;
+			case RPN_NOT:
+				value.value = ~rval;
+				break;
+			case RPN_LOGNOT:
+				value.value = !rval;
+				break;
+			case RPN_HIGH:
+				value.value = urval >> 8 & 0xFF;
+				break;
+			case RPN_LOW:
+				value.value = rval & 0xFF;
+				break;
+			case RPN_BITWIDTH:
+				value.value = rval != 0 ? 32 - clz(urval) : 0;
+				break;
+			case RPN_TZCOUNT:
+				value.value = rval != 0 ? ctz(urval) : 32;
+				break;
+			case RPN_HRAM:
+				if (rval < 0xFF00 || rval > 0xFFFF) {
+					return false;
+				}
+				value.value = rval & 0xFF;
+				break;
+			case RPN_RST:
+				if (rval & ~0x38) {
+					return false;
+				}
+				value.value = rval | 0xC7;
+				break;
+			case RPN_BIT_INDEX:
+				if (rval & ~0x07) {
+					return false;
+				}
+				value.value = patch.rpn[offset++] | rval << 3;
+				break;
+			default:
+				return false; // LCOV_EXCL_LINE
+			}
+			break;
+		}
+		}
+
+		stack.push_back(value);
+	}
+
+	if (stack.size() != 1) {
+		return false; // LCOV_EXCL_LINE
+	}
+	result = stack.back();
+	return true;
+}
+
+// Writes a patch's value into its section's data if it is known by now, mirroring what RGBLINK
+// would do; returns whether the patch can be dropped
+static bool tryResolvePatch(Patch const &patch, Section &sect) {
+	ResolvedValue resolved;
+	if (!resolvePatchValue(patch, &sect, resolved)) {
+		return false;
+	}
+
+	int32_t value = resolved.value;
+	if (patch.type == PATCHTYPE_JR) {
+		// A JR target only needs to be known relative to the PC
+		if (!isPCConsistent(patch, &sect)) {
+			return false;
+		} else if (resolved.section != patch.pcSection) {
+			if (resolved.section || patch.pcSection->org == UINT32_MAX) {
+				return false;
+			}
+			value -= patch.pcSection->org;
+		}
+		// Offset is relative to the byte *after* the operand
+		int16_t jumpOffset = value - (patch.pcOffset + 2);
+		if (jumpOffset < -128 || jumpOffset > 127 || patch.offset >= sect.data.size()) {
+			return false;
+		}
+		sect.data[patch.offset] = jumpOffset & 0xFF;
+		return true;
+	}
+
+	static struct {
+		uint8_t size;
+		int32_t min;
+		int32_t max;
+	} const types[PATCHTYPE_JR] = {
+	    {1, -128,      255      }, // PATCHTYPE_BYTE
+	    {2, -32768,    65536    }, // PATCHTYPE_WORD
+	    {4, INT32_MIN, INT32_MAX}, // PATCHTYPE_LONG
+	};
+	auto const &type = types[patch.type];
+
+	// Out-of-range values are left for RGBLINK to warn about
+	if (resolved.section || value < type.min || value > type.max
+	    || patch.offset + type.size > sect.data.size()) {
+		return false;
+	}
+	for (uint8_t i = 0; i < type.size; i++) {
+		sect.data[patch.offset + i] = value & 0xFF;
+		value >>= 8;
+	}
+	return true;
+}
+
+// Folds patches and assertions whose values became known after they were created (forward
+// references, label differences, etc.), so that they need not be written to the object file
+static void resolvePatches() {
+	size_t nbResolved = 0;
+
+	for (Section &sect : sectionList) {
+		nbResolved += std::erase_if(sect.patches, [&sect](Patch const &patch) {
+			return tryResolvePatch(patch, sect);
+		});
+	}
+
+	// Assertions that now pass can be dropped; failing ones are reported by RGBLINK
+	nbResolved += std::erase_if(assertions, [](Assertion const &assert) {
+		ResolvedValue resolved;
+		return resolvePatchValue(assert.patch, nullptr, resolved) && !resolved.section
+		       && resolved.value != 0;
+	});
+
+	verbosePrint("Resolved %zu patches at assembly time\n", nbResolved); // LCOV_EXCL_LINE
+}
+
+static void writeAssert(Assertion const &assert, ObjectTable &table) {
+	writePatch(assert.patch, table);
+	putString(assert.message, table);
+}
+
+static void writeFileStackNode(FileStackNode const &node, ObjectTable &table) {
+	putLong(node.parent ? node.parent->ID : UINT32_MAX, table);
+	putLong(node.lineNo, table);
+	putByte(node.type, table);
 	if (node.type != NODE_REPT) {
-		putString(node.name(), file);
+		putString(node.name(), table);
 	} else {
 		std::vector<uint32_t> const &nodeIters = node.iters();
 
-		putLong(nodeIters.size(), file);
+		putLong(nodeIters.size(), table);
 		// Iters are stored by decreasing depth, so reverse the order for output
 		for (uint32_t i = nodeIters.size(); i--;) {
-			putLong(nodeIters[i], file);
+			putLong(nodeIters[i], table);
 		}
 	}
 }
@@ -335,37 +706,94 @@ void out_WriteObject() {
 	}
 	Defer closeFile{[&] { fclose(file); }};
 
+	resolvePatches();
+
 	// Also write symbols that weren't written above
 	sym_ForEach(registerUnregisteredSymbol);
 
-	fputs(RGBDS_OBJECT_VERSION_STRING, file);
-	putLong(RGBDS_OBJECT_REV, file);
+	// Names are registered in the order they are written below
+	for (Symbol const *sym : objectSymbols) {
+		getStringID(sym->name);
+	}
+	for (Section const &sect : sectionList) {
+		getStringID(sect.name);
+	}
 
-	putLong(objectSymbols.size(), file);
-	putLong(sectionList.size(), file);
+	ObjectTable nodeTable, stringTable, symbolTable, sectionTable, patchTable, assertTable;
+	uint32_t nbPatches = 0;
 
-	putLong(fileStackNodes.size(), file);
+	blobOffset = 0; // Offsets are written along with what refers to them
 	for (auto it = fileStackNodes.begin(); it != fileStackNodes.end(); it++) {
 		FileStackNode const &node = **it;
 
-		writeFileStackNode(node, file);
+		writeFileStackNode(node, nodeTable);
 
 		// The list is supposed to have decrementing IDs
 		assume(it + 1 == fileStackNodes.end() || it[1]->ID == node.ID - 1);
 	}
-
+	for (std::string const *str : objectStrings) {
+		writeString(*str, stringTable);
+	}
 	for (Symbol const *sym : objectSymbols) {
-		writeSymbol(*sym, file);
+		writeSymbol(*sym, symbolTable);
 	}
-
 	for (Section const &sect : sectionList) {
-		writeSection(sect, file);
+		writeSection(sect, sectionTable, patchTable);
+		if (sect_HasData(sect.type)) {
+			nbPatches += sect.patches.size();
+		}
+	}
+	for (Assertion const &assert : assertions) {
+		writeAssert(assert, assertTable);
 	}
 
-	putLong(assertions.size(), file);
+	// The header says how many entries each table has, and where it starts
+	struct {
+		uint32_t count;
+		ObjectTable const &table;
+	} tables[] = {
+	    {static_cast<uint32_t>(fileStackNodes.size()), nodeTable},
+	    {static_cast<uint32_t>(objectStrings.size()), stringTable},
+	    {static_cast<uint32_t>(objectSymbols.size()), symbolTable},
+	    {static_cast<uint32_t>(sectionList.size()), sectionTable},
+	    {nbPatches, patchTable},
+	    {static_cast<uint32_t>(assertions.size()), assertTable},
+	};
+	ObjectTable header;
+	size_t offset = literal_strlen(RGBDS_OBJECT_VERSION_STRING) + 4 + 8 * (std::size(tables) + 1);
+
+	putLong(RGBDS_OBJECT_REV, header);
+	for (auto const &[count, table] : tables) {
+		putLong(count, header);
+		putLong(offset, header);
+		offset += table.size();
+	}
+	// The data area is last, aligned so that its contents can be read in place
+	size_t padding = getBlobSize(offset) - offset;
+	putLong(blobOffset, header);
+	putLong(offset + padding, header);
+	if (offset + padding + blobOffset > UINT32_MAX) {
+		fatal("Object file '%s' would be too large", objectFileName.c_str()); // LCOV_EXCL_LINE
+	}
 
+	fputs(RGBDS_OBJECT_VERSION_STRING, file);
+	fwrite(header.data(), 1, header.size(), file);
+	for (auto const &[count, table] : tables) {
+		if (!table.empty()) { // An empty table's `data()` may be null
+			fwrite(table.data(), 1, table.size(), file);
+		}
+	}
+	fwrite("\0\0\0", 1, padding, file);
+	for (Section const &sect : sectionList) {
+		if (sect_HasData(sect.type)) {
+			writeBlob(sect.data.data(), sect.size, file);
+			for (Patch const &patch : sect.patches) {
+				writeBlob(patch.rpn.data(), patch.rpn.size(), file);
+			}
+		}
+	}
 	for (Assertion const &assert : assertions) {
-		writeAssert(assert, file);
+		writeBlob(assert.patch.rpn.data(), assert.patch.rpn.size(), file);
 	}
 }
 
@@ -2,6 +2,7 @@
 
 #include "asm/rpn.hpp"
 
+#include <deque>
 #include <inttypes.h>
 #include <limits.h>
 #include <stdio.h>
@@ -19,37 +20,83 @@
 
 using namespace std::literals;
 
+std::vector<RPNNode> rpnNodes;
+
+// Names of sections referenced by expressions (`std::deque` keeps them at stable addresses)
+static std::deque<std::string> rpnSectNames;
+
 void Expression::clear() {
 	data = 0;
-	isSymbol = false;
-	rpn.clear();
-	rpnPatchSize = 0;
+	rpnRoot = UINT32_MAX;
+}
+
+void Expression::makeNode(RPNNode const &node) {
+	rpnRoot = rpnNodes.size();
+	rpnNodes.push_back(node);
 }
 
-uint8_t *Expression::reserveSpace(uint32_t size) {
-	return reserveSpace(size, size);
+// Returns a node without operands, to be filled in
+static RPNNode leafNode(RPNCommand command) {
+	return {
+	    .command = command,
+	    .byte = 0,
+	    .value = 0,
+	    .sym = nullptr,
+	    .sectName = nullptr,
+	    .lhs = UINT32_MAX,
+	    .rhs = UINT32_MAX,
+	};
 }
 
-uint8_t *Expression::reserveSpace(uint32_t size, uint32_t patchSize) {
-	rpnPatchSize += patchSize;
-	size_t curSize = rpn.size();
-	rpn.resize(curSize + size);
-	return &rpn[curSize];
+// Adds a constant node, returning its index
+static uint32_t makeConstNode(int32_t value) {
+	RPNNode node = leafNode(RPN_CONST);
+	node.value = static_cast<uint32_t>(value);
+	rpnNodes.push_back(node);
+	return rpnNodes.size() - 1;
+}
+
+std::string UnknownReason::describe() const {
+	switch (kind) {
+	case SYMBOL:
+		return "'"s + sym->name + "' is not constant at assembly time";
+	case SYMBOL_PURGED:
+		return "'"s + sym->name + "' is not constant at assembly time; it was purged";
+	case PC:
+		return "PC is not constant at assembly time";
+	case BANK_SYMBOL:
+		return "\""s + sym->name + "\"'s bank is not known";
+	case BANK_SYMBOL_PURGED:
+		return "\""s + sym->name + "\"'s bank is not known; it was purged";
+	case BANK_SELF:
+		return "Current section's bank is not known";
+	case BANK_SECTION:
+		return "Section \""s + sectName + "\"'s bank is not known";
+	case SIZEOF_SECTION:
+		return "Section \""s + sectName + "\"'s size is not known";
+	case STARTOF_SECTION:
+		return "Section \""s + sectName + "\"'s start is not known";
+	case SIZEOF_SECTTYPE:
+		return "Section type's size is not known";
+	case STARTOF_SECTTYPE:
+		return "Section type's start is not known";
+	}
+	unreachable_(); // LCOV_EXCL_LINE
 }
 
 int32_t Expression::getConstVal() const {
 	if (!isKnown()) {
-		error("Expected constant expression: %s", std::get<std::string>(data).c_str());
+		error("Expected constant expression: %s", std::get<UnknownReason>(data).describe().c_str());
 		return 0;
 	}
 	return value();
 }
 
 Symbol const *Expression::symbolOf() const {
-	if (!isSymbol) {
+	if (rpnRoot == UINT32_MAX || rpnNodes[rpnRoot].command != RPN_SYM) {
 		return nullptr;
 	}
-	return sym_FindScopedSymbol(reinterpret_cast<char const *>(&rpn[1]));
+	return rpnNodes[rpnRoot].sym;
 }
 
 bool Expression::isDiffConstant(Symbol const *sym) const {
@@ -79,20 +126,15 @@ void Expression::makeSymbol(std::string const &symName) {
 		error("'%s' is not a numeric symbol", symName.c_str());
 		data = 0;
 	} else if (!sym || !sym->isConstant()) {
-		isSymbol = true;
-
-		data = sym_IsPC(sym) ? "PC is not constant at assembly time"
-		       : sym_IsPurgedScoped(symName)
-		           ? "'"s + symName + "' is not constant at assembly time; it was purged"
-		           : "'"s + symName + "' is not constant at assembly time";
+		UnknownReason::Kind kind = sym_IsPC(sym)                  ? UnknownReason::PC
+		                           : sym_IsPurgedScoped(symName) ? UnknownReason::SYMBOL_PURGED
+		                                                          : UnknownReason::SYMBOL;
 		sym = sym_Ref(symName);
+		data = UnknownReason{.kind = kind, .sym = sym};
 
-		size_t nameLen = sym->name.length() + 1; // Don't forget NUL!
-
-		// 1-byte opcode + 4-byte symbol ID
-		uint8_t *ptr = reserveSpace(nameLen + 1, 5);
-		*ptr++ = RPN_SYM;
-		memcpy(ptr, sym->name.c_str(), nameLen);
+		RPNNode node = leafNode(RPN_SYM);
+		node.sym = sym;
+		makeNode(node);
 	} else {
 		data = static_cast<int32_t>(sym->getConstantValue());
 	}
@@ -100,15 +142,14 @@ void Expression::makeSymbol(std::string const &symName) {
 
 void Expression::makeBankSymbol(std::string const &symName) {
 	clear();
-	if (Symbol const *sym = sym_FindScopedSymbol(symName); sym_IsPC(sym)) {
+	if (Symbol *sym = sym_FindScopedSymbol(symName); sym_IsPC(sym)) {
 		// The @ symbol is treated differently.
 		if (!currentSection) {
 			error("PC has no bank outside of a section");
 			data = 1;
 		} else if (currentSection->bank == UINT32_MAX) {
-			data = "Current section's bank is not known";
-
-			*reserveSpace(1) = RPN_BANK_SELF;
+			data = UnknownReason{.kind = UnknownReason::BANK_SELF};
+			makeNode(leafNode(RPN_BANK_SELF));
 		} else {
 			data = static_cast<int32_t>(currentSection->bank);
 		}
@@ -124,16 +165,15 @@ void Expression::makeBankSymbol(std::string const &symName) {
 			// Symbol's section is known and bank is fixed
 			data = static_cast<int32_t>(sym->getSection()->bank);
 		} else {
-			data = sym_IsPurgedScoped(symName)
-			           ? "\""s + symName + "\"'s bank is not known; it was purged"
-			           : "\""s + symName + "\"'s bank is not known";
-
-			size_t nameLen = sym->name.length() + 1; // Room for NUL!
+			data = UnknownReason{
+			    .kind = sym_IsPurgedScoped(symName) ? UnknownReason::BANK_SYMBOL_PURGED
+			                                        : UnknownReason::BANK_SYMBOL,
+			    .sym = sym,
+			};
 
-			// 1-byte opcode + 4-byte sect ID
-			uint8_t *ptr = reserveSpace(nameLen + 1, 5);
-			*ptr++ = RPN_BANK_SYM;
-			memcpy(ptr, sym->name.c_str(), nameLen);
+			RPNNode node = leafNode(RPN_BANK_SYM);
+			node.sym = sym;
+			makeNode(node);
 		}
 	}
 }
@@ -143,13 +183,10 @@ void Expression::makeBankSection(std::string const &sectName) {
 	if (Section *sect = sect_FindSectionByName(sectName); sect && sect->bank != UINT32_MAX) {
 		data = static_cast<int32_t>(sect->bank);
 	} else {
-		data = "Section \""s + sectName + "\"'s bank is not known";
-
-		size_t nameLen = sectName.length() + 1; // Room for NUL!
-
-		uint8_t *ptr = reserveSpace(nameLen + 1);
-		*ptr++ = RPN_BANK_SECT;
-		memcpy(ptr, sectName.data(), nameLen);
+		RPNNode node = leafNode(RPN_BANK_SECT);
+		node.sectName = rpnSectNames.emplace_back(sectName).c_str();
+		makeNode(node);
+		data = UnknownReason{.kind = UnknownReason::BANK_SECTION, .sectName = node.sectName};
 	}
 }
 
@@ -158,13 +195,10 @@ void Expression::makeSizeOfSection(std::string const &sectName) {
 	if (Section *sect = sect_FindSectionByName(sectName); sect && sect->isSizeKnown()) {
 		data = static_cast<int32_t>(sect->size);
 	} else {
-		data = "Section \""s + sectName + "\"'s size is not known";
-
-		size_t nameLen = sectName.length() + 1; // Room for NUL!
-
-		uint8_t *ptr = reserveSpace(nameLen + 1);
-		*ptr++ = RPN_SIZEOF_SECT;
-		memcpy(ptr, sectName.data(), nameLen);
+		RPNNode node = leafNode(RPN_SIZEOF_SECT);
+		node.sectName = rpnSectNames.emplace_back(sectName).c_str();
+		makeNode(node);
+		data = UnknownReason{.kind = UnknownReason::SIZEOF_SECTION, .sectName = node.sectName};
 	}
 }
 
@@ -173,32 +207,29 @@ void Expression::makeStartOfSection(std::string const &sectName) {
 	if (Section *sect = sect_FindSectionByName(sectName); sect && sect->org != UINT32_MAX) {
 		data = static_cast<int32_t>(sect->org);
 	} else {
-		data = "Section \""s + sectName + "\"'s start is not known";
-
-		size_t nameLen = sectName.length() + 1; // Room for NUL!
-
-		uint8_t *ptr = reserveSpace(nameLen + 1);
-		*ptr++ = RPN_STARTOF_SECT;
-		memcpy(ptr, sectName.data(), nameLen);
+		RPNNode node = leafNode(RPN_STARTOF_SECT);
+		node.sectName = rpnSectNames.emplace_back(sectName).c_str();
+		makeNode(node);
+		data = UnknownReason{.kind = UnknownReason::STARTOF_SECTION, .sectName = node.sectName};
 	}
 }
 
 void Expression::makeSizeOfSectionType(SectionType type) {
 	clear();
-	data = "Section type's size is not known";
+	data = UnknownReason{.kind = UnknownReason::SIZEOF_SECTTYPE};
 
-	uint8_t *ptr = reserveSpace(2);
-	*ptr++ = RPN_SIZEOF_SECTTYPE;
-	*ptr = type;
+	RPNNode node = leafNode(RPN_SIZEOF_SECTTYPE);
+	node.byte = type;
+	makeNode(node);
 }
 
 void Expression::makeStartOfSectionType(SectionType type) {
 	clear();
-	data = "Section type's start is not known";
+	data = UnknownReason{.kind = UnknownReason::STARTOF_SECTTYPE};
 
-	uint8_t *ptr = reserveSpace(2);
-	*ptr++ = RPN_STARTOF_SECTTYPE;
-	*ptr = type;
+	RPNNode node = leafNode(RPN_STARTOF_SECTTYPE);
+	node.byte = type;
+	makeNode(node);
 }
 
 static bool tryConstZero(Expression const &lhs, Expression const &rhs) {
@@ -336,11 +367,11 @@ void Expression::makeUnaryOp(RPNCommand op, Expression &&src) {
 	} else if (int32_t constVal; op == RPN_LOW && (constVal = tryConstLow(src)) != -1) {
 		data = constVal;
 	} else {
-		// If it's not known, just reuse its RPN buffer and append the operator
-		rpnPatchSize = src.rpnPatchSize;
-		std::swap(rpn, src.rpn);
+		// If it's not known, just apply the operator to its tree
+		RPNNode node = leafNode(op);
+		node.lhs = src.rpnRoot;
+		makeNode(node);
 		data = std::move(src.data);
-		*reserveSpace(1) = op;
 	}
 }
 
@@ -482,62 +513,22 @@ void Expression::makeBinaryOp(RPNCommand op, Expression &&src1, Expression const
 	} else if (int32_t constVal; op == RPN_AND && (constVal = tryConstMask(src1, src2)) != -1) {
 		data = constVal;
 	} else {
-		// If it's not known, start computing the RPN expression
-
-		// Convert the left-hand expression if it's constant
-		if (src1.isKnown()) {
-			uint32_t lval = src1.value();
-			uint8_t bytes[] = {
-			    RPN_CONST,
-			    static_cast<uint8_t>(lval),
-			    static_cast<uint8_t>(lval >> 8),
-			    static_cast<uint8_t>(lval >> 16),
-			    static_cast<uint8_t>(lval >> 24),
-			};
-			rpn.clear();
-			rpnPatchSize = 0;
-			memcpy(reserveSpace(sizeof(bytes)), bytes, sizeof(bytes));
-
-			// Use the other expression's un-const reason
-			data = std::move(src2.data);
-		} else {
-			// Otherwise just reuse its RPN buffer
-			rpnPatchSize = src1.rpnPatchSize;
-			std::swap(rpn, src1.rpn);
-			data = std::move(src1.data);
-		}
-
-		// Now, merge the right expression into the left one
-		if (src2.isKnown()) {
-			// If the right expression is constant, append a shim instead
-			uint32_t rval = src2.value();
-			uint8_t bytes[] = {
-			    RPN_CONST,
-			    static_cast<uint8_t>(rval),
-			    static_cast<uint8_t>(rval >> 8),
-			    static_cast<uint8_t>(rval >> 16),
-			    static_cast<uint8_t>(rval >> 24),
-			};
-			uint8_t *ptr = reserveSpace(sizeof(bytes) + 1, sizeof(bytes) + 1);
-			memcpy(ptr, bytes, sizeof(bytes));
-			ptr[sizeof(bytes)] = op;
-		} else {
-			// Copy the right RPN and append the operator
-			uint32_t rightRpnSize = src2.rpn.size();
-			uint8_t *ptr = reserveSpace(rightRpnSize + 1, src2.rpnPatchSize + 1);
-			if (rightRpnSize > 0) {
-				// If `rightRpnSize == 0`, then `memcpy(ptr, nullptr, rightRpnSize)` would be UB
-				memcpy(ptr, src2.rpn.data(), rightRpnSize);
-			}
-			ptr[rightRpnSize] = op;
-		}
+		// If it's not known, build a tree from both operands, converting constant ones to nodes
+		RPNNode node = leafNode(op);
+		node.lhs = src1.isKnown() ? makeConstNode(src1.value()) : src1.rpnRoot;
+		node.rhs = src2.isKnown() ? makeConstNode(src2.value()) : src2.rpnRoot;
+		makeNode(node);
+
+		// Use the un-const reason of the leftmost unknown operand
+		data = src1.isKnown() ? src2.data : std::move(src1.data);
 	}
 }
 
 bool Expression::makeCheckHRAM() {
-	isSymbol = false;
 	if (!isKnown()) {
-		*reserveSpace(1) = RPN_HRAM;
+		RPNNode node = leafNode(RPN_HRAM);
+		node.lhs = rpnRoot;
+		makeNode(node);
 	} else if (int32_t val = value(); val >= 0xFF00 && val <= 0xFFFF) {
 		// That range is valid, but only keep the lower byte
 		data = val & 0xFF;
@@ -552,7 +543,9 @@ bool Expression::makeCheckHRAM() {
 
 void Expression::makeCheckRST() {
 	if (!isKnown()) {
-		*reserveSpace(1) = RPN_RST;
+		RPNNode node = leafNode(RPN_RST);
+		node.lhs = rpnRoot;
+		makeNode(node);
 	} else if (int32_t val = value(); val & ~0x38) {
 		// A valid RST address must be masked with 0x38
 		error("Invalid address $%" PRIx32 " for RST", val);
@@ -563,9 +556,10 @@ void Expression::makeCheckBitIndex(uint8_t mask) {
 	assume((mask & 0xC0) != 0x00); // The high two bits must correspond to BIT, RES, or SET
 
 	if (!isKnown()) {
-		uint8_t *ptr = reserveSpace(2);
-		*ptr++ = RPN_BIT_INDEX;
-		*ptr = mask;
+		RPNNode node = leafNode(RPN_BIT_INDEX);
+		node.byte = mask;
+		node.lhs = rpnRoot;
+		makeNode(node);
 	} else if (int32_t val = value(); val & ~0x07) {
 		// A valid bit index must be masked with 0x07
 		static char const *instructions[4] = {"instruction", "BIT", "RES", "SET"};
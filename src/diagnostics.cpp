@@ -1,12 +1,17 @@
 #include "diagnostics.hpp"
 
+thread_local FILE *diagnosticsFile = nullptr;
+
+thread_local uintmax_t nbWarnxPrinted = 0;
+
 void warnx(char const *fmt, ...) {
 	va_list ap;
-	fputs("warning: ", stderr);
+	fputs("warning: ", diagnosticsOutput());
 	va_start(ap, fmt);
-	vfprintf(stderr, fmt, ap);
+	vfprintf(diagnosticsOutput(), fmt, ap);
 	va_end(ap);
-	putc('\n', stderr);
+	putc('\n', diagnosticsOutput());
+	++nbWarnxPrinted;
 }
 
 void WarningState::update(WarningState other) {
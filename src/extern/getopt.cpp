@@ -11,13 +11,15 @@
 #include <string.h>
 #include <wchar.h>
 
+#include "diagnostics.hpp"
+
 char *musl_optarg;
 int musl_optind = 1, musl_opterr = 1, musl_optopt;
 int musl_optreset = 0;
 static int musl_optpos;
 
 static void musl_getopt_msg(char const *a, char const *b, char const *c, size_t l) {
-	FILE *f = stderr;
+	FILE *f = diagnosticsOutput();
 
 	if (fputs(a, f) >= 0 && fwrite(b, strlen(b), 1, f) && fwrite(c, 1, l, f) == l) {
 		putc('\n', f);
@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: MIT
+
+#include "gfx/cache.hpp"
+
+#include <array>
+#include <chrono>
+#include <errno.h>
+#include <filesystem>
+#include <functional>
+#include <inttypes.h>
+#include <optional>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include "diagnostics.hpp"
+#include "version.hpp"
+
+#include "gfx/main.hpp"
+#include "gfx/process.hpp"
+#include "gfx/warning.hpp"
+
+// A cache entry is a single file, named after a hash of the conversion's key. The entry begins
+// with the key itself, so that hash collisions are merely cache misses; then come the contents of
+// each of the conversion's outputs, in the order of `outputPaths()`.
+// Entries are written to a temporary file, which is then renamed over the entry's name, so that
+// concurrent builds never see a partial entry; at worst, they both store the same one.
+
+static constexpr std::string_view entryMagic = "RGBGFX cache v1\n";
+
+static std::array<std::string const *, 5> outputPaths() {
+	return {&options.output, &options.tilemap, &options.attrmap, &options.palmap, &options.palettes};
+}
+
+static bool readFile(std::string const &path, std::string &contents) {
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file) {
+		return false;
+	}
+
+	contents.clear();
+	char buf[4096];
+	for (size_t len; (len = fread(buf, 1, sizeof(buf), file)) != 0;) {
+		contents.append(buf, len);
+	}
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+static void addNumber(std::string &key, uint64_t value) {
+	for (uint8_t i = 0; i < 8; ++i) {
+		key.push_back(static_cast<char>(value & 0xFF));
+		value >>= 8;
+	}
+}
+
+static void addBytes(std::string &key, std::string_view bytes) {
+	addNumber(key, bytes.size());
+	key.append(bytes);
+}
+
+static void addColor(std::string &key, std::optional<Rgba> const &color) {
+	addNumber(key, color ? color->toCSS() : UINT64_MAX);
+}
+
+// Returns everything that the conversion's outputs depend on, or nothing if the conversion cannot
+// be cached (because it reads from standard input, or writes to standard output).
+static std::optional<std::string> conversionKey() {
+	if (options.input == "-") {
+		return std::nullopt;
+	}
+	for (std::string const *path : outputPaths()) {
+		if (*path == "-") {
+			return std::nullopt;
+		}
+	}
+
+	std::string key;
+	addBytes(key, get_package_version_string());
+
+	std::string contents;
+	if (!readFile(options.input, contents)) {
+		return std::nullopt; // Let `process()` report the error
+	}
+	addBytes(key, contents);
+	addNumber(key, !options.inputTileset.empty());
+	if (!options.inputTileset.empty()) {
+		if (!readFile(options.inputTileset, contents)) {
+			return std::nullopt;
+		}
+		addBytes(key, contents);
+	}
+
+	// Paths themselves do not matter, only which outputs are generated
+	for (std::string const *path : outputPaths()) {
+		addNumber(key, !path->empty());
+	}
+
+	// Keep this in sync with the options that affect conversion!
+	addNumber(key, options.useColorCurve);
+	addNumber(key, options.allowDedup);
+	addNumber(key, options.allowMirroringX);
+	addNumber(key, options.allowMirroringY);
+	addNumber(key, options.columnMajor);
+	addColor(key, options.bgColor);
+	addNumber(key, options.baseTileIDs[0]);
+	addNumber(key, options.baseTileIDs[1]);
+	addNumber(key, options.palSpecType);
+	addNumber(key, options.palSpec.size());
+	for (std::array<std::optional<Rgba>, 4> const &palette : options.palSpec) {
+		for (std::optional<Rgba> const &color : palette) {
+			addColor(key, color);
+		}
+	}
+	addNumber(key, options.palSpecDmg);
+	addNumber(key, options.bitDepth);
+	addNumber(key, options.inputSlice.left);
+	addNumber(key, options.inputSlice.top);
+	addNumber(key, options.inputSlice.width);
+	addNumber(key, options.inputSlice.height);
+	addNumber(key, options.basePalID);
+	addNumber(key, options.maxNbTiles[0]);
+	addNumber(key, options.maxNbTiles[1]);
+	addNumber(key, options.nbPalettes);
+	addNumber(key, options.packSeed);
+	addNumber(key, options.packTries);
+	addNumber(key, options.nbColorsPerPal);
+	addNumber(key, options.trim);
+	for (uint8_t value : options.dmgColors) {
+		addNumber(key, value);
+	}
+
+	// Warnings turned into errors can make the conversion fail
+	for (uint8_t id = 0; id < NB_WARNINGS; ++id) {
+		addNumber(key, warnings.getWarningBehavior(static_cast<WarningID>(id)));
+	}
+
+	return key;
+}
+
+// FNV-1a, which is plenty for naming entries, since they also store their full key
+static uint64_t hashKey(std::string_view key) {
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
+	for (char c : key) {
+		hash = (hash ^ static_cast<uint8_t>(c)) * UINT64_C(0x100000001b3);
+	}
+	return hash;
+}
+
+static void writeOutput(std::string const &path, std::string_view contents) {
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file) {
+		fatal("Failed to create \"%s\": %s", path.c_str(), strerror(errno));
+	}
+	if (fwrite(contents.data(), 1, contents.size(), file) != contents.size()) {
+		fatal("Failed to write \"%s\": %s", path.c_str(), strerror(errno));
+	}
+	if (fclose(file) != 0) {
+		fatal("Failed to write \"%s\": %s", path.c_str(), strerror(errno));
+	}
+}
+
+// If the entry at `path` is that of the conversion, writes its outputs and returns true
+static bool restoreEntry(std::string const &path, std::string const &key) {
+	std::string entry;
+	if (!readFile(path, entry) || !entry.starts_with(entryMagic)) {
+		return false;
+	}
+
+	size_t ofs = entryMagic.size();
+	auto readBytes = [&](std::string_view &bytes) {
+		if (entry.size() - ofs < 8) {
+			return false;
+		}
+		uint64_t len = 0;
+		for (uint8_t i = 0; i < 8; ++i) {
+			len |= uint64_t(static_cast<uint8_t>(entry[ofs++])) << (i * 8);
+		}
+		if (entry.size() - ofs < len) {
+			return false;
+		}
+		bytes = std::string_view(entry).substr(ofs, len);
+		ofs += len;
+		return true;
+	};
+
+	// Check the whole entry before writing anything, so that a bad one does not clobber outputs
+	std::string_view storedKey;
+	if (!readBytes(storedKey) || storedKey != key) {
+		return false;
+	}
+	std::array<std::string_view, 5> contents;
+	std::array<std::string const *, 5> paths = outputPaths();
+	for (size_t i = 0; i < paths.size(); ++i) {
+		if (!paths[i]->empty() && !readBytes(contents[i])) {
+			return false;
+		}
+	}
+	if (ofs != entry.size()) {
+		return false;
+	}
+
+	for (size_t i = 0; i < paths.size(); ++i) {
+		if (!paths[i]->empty()) {
+			writeOutput(*paths[i], contents[i]);
+		}
+	}
+	return true;
+}
+
+// Stores the conversion's outputs, which have just been written, in the entry at `path`.
+// Failing to do so only warns, since the conversion itself succeeded.
+static void storeEntry(char const *cacheDir, std::string const &path, std::string const &key) {
+	std::string entry{entryMagic};
+	addBytes(entry, key);
+	std::string contents;
+	for (std::string const *output : outputPaths()) {
+		if (output->empty()) {
+			continue;
+		}
+		if (!readFile(*output, contents)) {
+			warnx("Failed to read back \"%s\" to cache it: %s", output->c_str(), strerror(errno));
+			return;
+		}
+		addBytes(entry, contents);
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(cacheDir, ec);
+	if (ec) {
+		warnx("Failed to create cache directory \"%s\": %s", cacheDir, ec.message().c_str());
+		return;
+	}
+
+	// Other processes and threads may be storing the same entry, so pick a name that they won't;
+	// and creating the file exclusively guarantees that even if the odds were to fail us.
+	uint64_t unique = std::random_device{}();
+	unique ^= std::hash<std::thread::id>{}(std::this_thread::get_id());
+	unique ^= std::chrono::steady_clock::now().time_since_epoch().count();
+	char suffix[sizeof(".0123456789abcdef.tmp")];
+	snprintf(suffix, sizeof(suffix), ".%016" PRIx64 ".tmp", unique);
+	std::string tmpPath = path + suffix;
+
+	FILE *file = fopen(tmpPath.c_str(), "wbx");
+	if (!file) {
+		warnx("Failed to create cache entry \"%s\": %s", tmpPath.c_str(), strerror(errno));
+		return;
+	}
+	bool written = fwrite(entry.data(), 1, entry.size(), file) == entry.size();
+	if (fclose(file) != 0 || !written) {
+		warnx("Failed to write cache entry \"%s\": %s", tmpPath.c_str(), strerror(errno));
+		remove(tmpPath.c_str());
+		return;
+	}
+
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		// Most likely, another build is reading the same entry (which Windows forbids replacing)
+		options.verbosePrint(
+		    Options::VERB_LOG_ACT, "Not replacing cache entry: %s\n", ec.message().c_str()
+		);
+		remove(tmpPath.c_str());
+	}
+}
+
+void processCached(char const *cacheDir) {
+	std::optional<std::string> key = conversionKey();
+	if (!key) {
+		options.verbosePrint(Options::VERB_LOG_ACT, "Not using the cache for this conversion\n");
+		process();
+		return;
+	}
+
+	char name[sizeof("0123456789abcdef")];
+	snprintf(name, sizeof(name), "%016" PRIx64, hashKey(*key));
+	std::string path = std::string(cacheDir) + '/' + name;
+
+	if (restoreEntry(path, *key)) {
+		options.verbosePrint(
+		    Options::VERB_LOG_ACT, "Copied outputs from cache entry \"%s\"\n", path.c_str()
+		);
+		return;
+	}
+
+	uintmax_t nbWarnings = nbWarningsPrinted();
+	process();
+	// Cache hits do not print anything, so conversions that warned are not cached; otherwise,
+	// their warnings would only be printed by the first build
+	if (nbWarningsPrinted() != nbWarnings) {
+		options.verbosePrint(Options::VERB_LOG_ACT, "Not caching conversion, as it warned\n");
+		return;
+	}
+	options.verbosePrint(
+	    Options::VERB_LOG_ACT, "Storing outputs in cache entry \"%s\"\n", path.c_str()
+	);
+	storeEntry(cacheDir, path, *key);
+}
@@ -3,7 +3,9 @@
 #include "gfx/main.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <ctype.h>
+#include <errno.h>
 #include <inttypes.h>
 #include <ios>
 #include <limits>
@@ -12,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "diagnostics.hpp"
@@ -20,6 +23,7 @@
 #include "platform.hpp"
 #include "version.hpp"
 
+#include "gfx/cache.hpp"
 #include "gfx/pal_spec.hpp"
 #include "gfx/process.hpp"
 #include "gfx/reverse.hpp"
@@ -27,9 +31,10 @@
 
 using namespace std::literals::string_view_literals;
 
-Options options;
+thread_local Options options;
 
-static struct LocalOptions {
+struct LocalOptions {
+	char const *cacheDir; // --cache-dir
 	char const *externalPalSpec;
 	bool autoAttrmap;
 	bool autoTilemap;
@@ -37,7 +42,14 @@ static struct LocalOptions {
 	bool autoPalmap;
 	bool groupOutputs;
 	bool reverse;
-} localOptions;
+};
+static thread_local LocalOptions localOptions;
+
+static char const *batchManifest = nullptr; // --batch
+static uint16_t nbBatchThreads = 0;         // -j; 0 means "auto" = one per hardware thread
+static bool sharedTileset = false;          // --shared-tileset
+static bool sharedPalettes = false;         // --shared-palettes
+static bool parsingBatchJob = false;
 
 void Options::verbosePrint(uint8_t level, char const *fmt, ...) const {
 	// LCOV_EXCL_START
@@ -45,14 +57,14 @@ void Options::verbosePrint(uint8_t level, char const *fmt, ...) const {
 		va_list ap;
 
 		va_start(ap, fmt);
-		vfprintf(stderr, fmt, ap);
+		vfprintf(diagnosticsOutput(), fmt, ap);
 		va_end(ap);
 	}
 	// LCOV_EXCL_STOP
 }
 
 // Short options
-static char const *optstring = "-Aa:B:b:Cc:d:hi:L:l:mN:n:Oo:Pp:Qq:r:s:Tt:U:uVvW:wXx:YZ";
+static char const *optstring = "-Aa:B:b:Cc:d:hi:j:L:l:mN:n:Oo:Pp:Qq:r:s:Tt:U:uVvW:wXx:YZ";
 
 // Equivalent long options
 // Please keep in the same order as short opts.
@@ -61,16 +73,21 @@ static char const *optstring = "-Aa:B:b:Cc:d:hi:L:l:mN:n:Oo:Pp:Qq:r:s:Tt:U:uVvW:
 // except if it doesn't create any ambiguity (`verbose` versus `version`).
 // This is because long opt matching, even to a single char, is prioritized
 // over short opt matching.
+static int longOpt; // Long-only options
+
 static option const longopts[] = {
     {"auto-attr-map",    no_argument,       nullptr, 'A'},
     {"attr-map",         required_argument, nullptr, 'a'},
     {"background-color", required_argument, nullptr, 'B'},
     {"base-tiles",       required_argument, nullptr, 'b'},
+    {"batch",            required_argument, &longOpt, 'b'},
+    {"cache-dir",        required_argument, &longOpt, 'c'},
     {"color-curve",      no_argument,       nullptr, 'C'},
     {"colors",           required_argument, nullptr, 'c'},
     {"depth",            required_argument, nullptr, 'd'},
     {"help",             no_argument,       nullptr, 'h'},
     {"input-tileset",    required_argument, nullptr, 'i'},
+    {"jobs",             required_argument, nullptr, 'j'},
     {"slice",            required_argument, nullptr, 'L'},
     {"base-palette",     required_argument, nullptr, 'l'},
     {"mirror-tiles",     no_argument,       nullptr, 'm'},
@@ -78,12 +95,16 @@ static option const longopts[] = {
     {"nb-palettes",      required_argument, nullptr, 'n'},
     {"group-outputs",    no_argument,       nullptr, 'O'},
     {"output",           required_argument, nullptr, 'o'},
+    {"pack-seed",        required_argument, &longOpt, 's'},
+    {"pack-tries",       required_argument, &longOpt, 'n'},
     {"auto-palette",     no_argument,       nullptr, 'P'},
     {"palette",          required_argument, nullptr, 'p'},
     {"auto-palette-map", no_argument,       nullptr, 'Q'},
     {"palette-map",      required_argument, nullptr, 'q'},
     {"reverse",          required_argument, nullptr, 'r'},
     {"palette-size",     required_argument, nullptr, 's'},
+    {"shared-palettes",  no_argument,       &longOpt, 'p'},
+    {"shared-tileset",   no_argument,       &longOpt, 't'},
     {"auto-tilemap",     no_argument,       nullptr, 'T'},
     {"tilemap",          required_argument, nullptr, 't'},
     {"unit-size",        required_argument, nullptr, 'U'},
@@ -106,6 +127,8 @@ static void printUsage() {
 	    "       [-L <slice>] [-l <base_pal>] [-N <nb_tiles>] [-n <nb_pals>]\n"
 	    "       [-o <out_file>] [-p <pal_file> | -P] [-q <pal_map> | -Q]\n"
 	    "       [-s <nb_colors>] [-t <tile_map> | -T] [-x <nb_tiles>] <file>\n"
+	    "       rgbgfx [options] --batch <manifest> [-j <nb_jobs>]\n"
+	    "              [--shared-tileset [--shared-palettes]]\n"
 	    "Useful options:\n"
 	    "    -m, --mirror-tiles    optimize out mirrored tiles\n"
 	    "    -o, --output <path>   output the tile data to this path\n"
@@ -114,7 +137,7 @@ static void printUsage() {
 	    "    -V, --version         print RGBGFX version and exit\n"
 	    "\n"
 	    "For help, use `man rgbgfx' or go to https://rgbds.gbdev.io/docs/\n",
-	    stderr
+	    diagnosticsOutput()
 	);
 }
 // LCOV_EXCL_STOP
@@ -122,14 +145,14 @@ static void printUsage() {
 [[gnu::format(printf, 1, 2), noreturn]]
 static void fatalWithUsage(char const *fmt, ...) {
 	va_list ap;
-	fputs("FATAL: ", stderr);
+	fputs("FATAL: ", diagnosticsOutput());
 	va_start(ap, fmt);
-	vfprintf(stderr, fmt, ap);
+	vfprintf(diagnosticsOutput(), fmt, ap);
 	va_end(ap);
-	putc('\n', stderr);
+	putc('\n', diagnosticsOutput());
 
 	printUsage();
-	exit(1);
+	abortConversion();
 }
 
 // Parses a number at the beginning of a string, moving the pointer to skip the parsed characters.
@@ -221,8 +244,17 @@ static void registerInput(char const *arg) {
 	}
 }
 
+// A non-empty line of an at-file, and the index of its first argument
+struct AtFileLine {
+	uint32_t lineNo;
+	size_t firstArg;
+};
+
 // Turn an at-file's contents into an argv that `getopt` can handle, appending them to `argPool`.
-static std::vector<size_t> readAtFile(std::string const &path, std::vector<char> &argPool) {
+// If `lines` is provided, the lines that contain arguments are also appended to it.
+static std::vector<size_t> readAtFile(
+    std::string const &path, std::vector<char> &argPool, std::vector<AtFileLine> *lines = nullptr
+) {
 	File file;
 	if (!file.open(path, std::ios_base::in)) {
 		fatal("Error reading @%s: %s", file.c_str(path), strerror(errno));
@@ -234,10 +266,13 @@ static std::vector<size_t> readAtFile(std::string const &path, std::vector<char>
 	    "isblank(std::streambuf::traits_type::eof()) is UB!"
 	);
 	std::vector<size_t> argvOfs;
+	uint32_t lineNo = 0;
 
 	for (;;) {
 		int c;
 
+		++lineNo;
+
 		// First, discard any leading whitespace
 		do {
 			c = file->sbumpc();
@@ -263,6 +298,9 @@ static std::vector<size_t> readAtFile(std::string const &path, std::vector<char>
 		}
 
 		// Alright, now we can parse the line
+		if (lines) {
+			lines->push_back({.lineNo = lineNo, .firstArg = argvOfs.size()});
+		}
 		do {
 			// Read one argument (until the next whitespace char).
 			// We know there is one because we already have its first character in `c`.
@@ -275,7 +313,7 @@ static std::vector<size_t> readAtFile(std::string const &path, std::vector<char>
 				if (c == EOF || c == '\n' || isblank(c)) {
 					break;
 				} else if (c == '\r') {
-					file->sbumpc(); // Discard the '\n'
+					c = file->sbumpc(); // Read the '\n'
 					break;
 				}
 				argPool.push_back(c);
@@ -389,6 +427,14 @@ static char *parseArgv(int argc, char *argv[]) {
 			}
 			options.inputTileset = musl_optarg;
 			break;
+		case 'j':
+			nbBatchThreads = parseNumber(arg, "Number of jobs", 0);
+			if (*arg != '\0') {
+				error("Number of jobs (-j) must be a valid number, not \"%s\"", musl_optarg);
+			} else if (nbBatchThreads == 0) {
+				error("Number of jobs (-j) may not be 0!");
+			}
+			break;
 		case 'L':
 			options.inputSlice.left = parseNumber(arg, "Input slice left coordinate");
 			if (options.inputSlice.left > INT16_MAX) {
@@ -582,6 +628,52 @@ static char *parseArgv(int argc, char *argv[]) {
 		case 'Z':
 			options.columnMajor = true;
 			break;
+		case 0:
+			if (parsingBatchJob && longOpt != 'c' && longOpt != 'n' && longOpt != 's') {
+				error(
+				    "Batch jobs cannot use `--batch`, `--shared-tileset`, or `--shared-palettes`"
+				);
+				break;
+			}
+			switch (longOpt) {
+			case 'c':
+				localOptions.cacheDir = musl_optarg;
+				break;
+			case 'n':
+				number = parseNumber(arg, "Number of packing tries", 0);
+				if (*arg != '\0') {
+					error(
+					    "Number of packing tries (--pack-tries) must be a valid number, not \"%s\"",
+					    musl_optarg
+					);
+				} else if (number == 0) {
+					error("Number of packing tries (--pack-tries) may not be 0!");
+				} else {
+					options.packTries = number;
+				}
+				break;
+			case 's':
+				options.packSeed = parseNumber(arg, "Packing seed", 0);
+				if (*arg != '\0') {
+					error(
+					    "Packing seed (--pack-seed) must be a valid number, not \"%s\"", musl_optarg
+					);
+				}
+				break;
+			case 'b':
+				if (batchManifest) {
+					warnx("Overriding batch manifest %s", batchManifest);
+				}
+				batchManifest = musl_optarg;
+				break;
+			case 'p':
+				sharedPalettes = true;
+				break;
+			case 't':
+				sharedTileset = true;
+				break;
+			}
+			break;
 		case 1: // Positional argument, requested by leading `-` in opt string
 			if (musl_optarg[0] == '@') {
 				// Instruct the caller to process that at-file
@@ -593,7 +685,7 @@ static char *parseArgv(int argc, char *argv[]) {
 		default:
 			// LCOV_EXCL_START
 			printUsage();
-			exit(1);
+			abortConversion();
 			// LCOV_EXCL_STOP
 		}
 	}
@@ -602,10 +694,10 @@ static char *parseArgv(int argc, char *argv[]) {
 }
 
 static void verboseOutputConfig() {
-	fprintf(stderr, "rgbgfx %s\n", get_package_version_string());
+	fprintf(diagnosticsOutput(), "rgbgfx %s\n", get_package_version_string());
 
 	if (options.verbosity >= Options::VERB_VVVVVV) {
-		putc('\n', stderr);
+		putc('\n', diagnosticsOutput());
 		// clang-format off: vertically align values
 		static std::array<uint16_t, 21> gfx{
 		    0b0111111110,
@@ -640,42 +732,50 @@ static void verboseOutputConfig() {
 			uint16_t row = gfx[i];
 			for (uint8_t _ = 0; _ < 10; ++_) {
 				unsigned char c = row & 1 ? '0' : ' ';
-				putc(c, stderr);
+				putc(c, diagnosticsOutput());
 				// Double the pixel horizontally, otherwise the aspect ratio looks wrong
-				putc(c, stderr);
+				putc(c, diagnosticsOutput());
 				row >>= 1;
 			}
 			if (i < textbox.size()) {
-				fputs(textbox[i], stderr);
+				fputs(textbox[i], diagnosticsOutput());
 			}
-			putc('\n', stderr);
+			putc('\n', diagnosticsOutput());
 		}
-		putc('\n', stderr);
+		putc('\n', diagnosticsOutput());
 	}
 
-	fputs("Options:\n", stderr);
+	fputs("Options:\n", diagnosticsOutput());
 	if (options.columnMajor) {
-		fputs("\tVisit image in column-major order\n", stderr);
+		fputs("\tVisit image in column-major order\n", diagnosticsOutput());
 	}
 	if (options.allowDedup) {
-		fputs("\tAllow deduplicating tiles\n", stderr);
+		fputs("\tAllow deduplicating tiles\n", diagnosticsOutput());
 	}
 	if (options.allowMirroringX) {
-		fputs("\tAllow deduplicating horizontally mirrored tiles\n", stderr);
+		fputs("\tAllow deduplicating horizontally mirrored tiles\n", diagnosticsOutput());
 	}
 	if (options.allowMirroringY) {
-		fputs("\tAllow deduplicating vertically mirrored tiles\n", stderr);
+		fputs("\tAllow deduplicating vertically mirrored tiles\n", diagnosticsOutput());
 	}
 	if (options.useColorCurve) {
-		fputs("\tUse color curve\n", stderr);
+		fputs("\tUse color curve\n", diagnosticsOutput());
 	}
-	fprintf(stderr, "\tBit depth: %" PRIu8 "bpp\n", options.bitDepth);
+	fprintf(diagnosticsOutput(), "\tBit depth: %" PRIu8 "bpp\n", options.bitDepth);
 	if (options.trim != 0) {
-		fprintf(stderr, "\tTrim the last %" PRIu64 " tiles\n", options.trim);
+		fprintf(diagnosticsOutput(), "\tTrim the last %" PRIu64 " tiles\n", options.trim);
 	}
-	fprintf(stderr, "\tMaximum %" PRIu16 " palettes\n", options.nbPalettes);
-	fprintf(stderr, "\tPalettes contain %" PRIu8 " colors\n", options.nbColorsPerPal);
-	fprintf(stderr, "\t%s palette spec\n", [] {
+	fprintf(diagnosticsOutput(), "\tMaximum %" PRIu16 " palettes\n", options.nbPalettes);
+	if (options.packTries > 1) {
+		fprintf(
+		    diagnosticsOutput(),
+		    "\tPack palettes %" PRIu16 " times, with seed %" PRIu16 "\n",
+		    options.packTries,
+		    options.packSeed
+		);
+	}
+	fprintf(diagnosticsOutput(), "\tPalettes contain %" PRIu8 " colors\n", options.nbColorsPerPal);
+	fprintf(diagnosticsOutput(), "\t%s palette spec\n", [] {
 		switch (options.palSpecType) {
 		case Options::NO_SPEC:
 			return "No";
@@ -689,22 +789,22 @@ static void verboseOutputConfig() {
 		return "???";
 	}());
 	if (options.palSpecType == Options::EXPLICIT) {
-		fputs("\t[\n", stderr);
+		fputs("\t[\n", diagnosticsOutput());
 		for (auto const &pal : options.palSpec) {
-			fputs("\t\t", stderr);
+			fputs("\t\t", diagnosticsOutput());
 			for (auto const &color : pal) {
 				if (color) {
-					fprintf(stderr, "#%06x, ", color->toCSS() >> 8);
+					fprintf(diagnosticsOutput(), "#%06x, ", color->toCSS() >> 8);
 				} else {
-					fputs("#none, ", stderr);
+					fputs("#none, ", diagnosticsOutput());
 				}
 			}
-			putc('\n', stderr);
+			putc('\n', diagnosticsOutput());
 		}
-		fputs("\t]\n", stderr);
+		fputs("\t]\n", diagnosticsOutput());
 	}
 	fprintf(
-	    stderr,
+	    diagnosticsOutput(),
 	    "\tInput image slice: %" PRIu16 "x%" PRIu16 " pixels starting at (%" PRIu16 ", %" PRIu16
 	    ")\n",
 	    options.inputSlice.width,
@@ -713,21 +813,21 @@ static void verboseOutputConfig() {
 	    options.inputSlice.top
 	);
 	fprintf(
-	    stderr,
+	    diagnosticsOutput(),
 	    "\tBase tile IDs: [%" PRIu8 ", %" PRIu8 "]\n",
 	    options.baseTileIDs[0],
 	    options.baseTileIDs[1]
 	);
-	fprintf(stderr, "\tBase palette ID: %" PRIu8 "\n", options.basePalID);
+	fprintf(diagnosticsOutput(), "\tBase palette ID: %" PRIu8 "\n", options.basePalID);
 	fprintf(
-	    stderr,
+	    diagnosticsOutput(),
 	    "\tMaximum %" PRIu16 " tiles in bank 0, %" PRIu16 " in bank 1\n",
 	    options.maxNbTiles[0],
 	    options.maxNbTiles[1]
 	);
 	auto printPath = [](char const *name, std::string const &path) {
 		if (!path.empty()) {
-			fprintf(stderr, "\t%s: %s\n", name, path.c_str());
+			fprintf(diagnosticsOutput(), "\t%s: %s\n", name, path.c_str());
 		}
 	};
 	printPath("Input image", options.input);
@@ -735,10 +835,15 @@ static void verboseOutputConfig() {
 	printPath("Output tilemap", options.tilemap);
 	printPath("Output attrmap", options.attrmap);
 	printPath("Output palettes", options.palettes);
-	fputs("Ready.\n", stderr);
+	if (localOptions.cacheDir) {
+		fprintf(diagnosticsOutput(), "\tCache directory: %s\n", localOptions.cacheDir);
+	}
+	fputs("Ready.\n", diagnosticsOutput());
 }
 
-int main(int argc, char *argv[]) {
+// Parses a command line, including the at-files that it references.
+// Their contents are appended to `argPools`, which must outlive `localOptions`.
+static void parseCommandLine(int argc, char *argv[], std::vector<std::vector<char>> &argPools) {
 	struct AtFileStackEntry {
 		int parentInd;            // Saved offset into parent argv
 		std::vector<char *> argv; // This context's arg pointer vec
@@ -750,7 +855,7 @@ int main(int argc, char *argv[]) {
 
 	int curArgc = argc;
 	char **curArgv = argv;
-	std::vector<std::vector<char>> argPools;
+	musl_optreset = 1; // Batch jobs parse several command lines
 	for (;;) {
 		char *atFileName = parseArgv(curArgc, curArgv);
 		if (atFileName) {
@@ -802,7 +907,10 @@ int main(int argc, char *argv[]) {
 			curArgv = vec.data();
 		}
 	}
+}
 
+// Processes the options that depend on others, once they have all been parsed
+static void finishOptions() {
 	if (options.nbColorsPerPal == 0) {
 		options.nbColorsPerPal = 1u << options.bitDepth;
 	} else if (options.nbColorsPerPal > 1u << options.bitDepth) {
@@ -864,10 +972,15 @@ int main(int argc, char *argv[]) {
 
 	// Do not do anything if option parsing went wrong.
 	requireZeroErrors();
+}
 
+// Performs the conversion that the options ask for
+static void convert() {
 	if (!options.input.empty()) {
 		if (localOptions.reverse) {
 			reverse();
+		} else if (localOptions.cacheDir) {
+			processCached(localOptions.cacheDir);
 		} else {
 			process();
 		}
@@ -877,6 +990,269 @@ int main(int argc, char *argv[]) {
 	} else {
 		fatalWithUsage("No input image specified");
 	}
+}
+
+// Where part of a batch job printed its diagnostics
+struct JobOutput {
+	FILE *file = nullptr;
+	long begin = 0;
+	long end = 0;
+};
+
+struct BatchJob {
+	uint32_t lineNo;          // In the manifest
+	std::vector<char *> argv; // The job's arguments, as if on their own command line
+	Options options;
+	LocalOptions localOptions;
+	DiagnosticsState<WarningID> warningState;
+	bool failed = false;
+	JobOutput outputs[2]; // While parsing the job's options, then while converting
+};
+
+// Runs one step of a batch job, printing its diagnostics to `file`.
+// Returns whether the step succeeded; unlike outside of batches, failing does not exit.
+template<typename F>
+static bool runJobStep(FILE *file, JobOutput &output, F step) {
+	bool succeeded;
+
+	output.file = file;
+	output.begin = ftell(file);
+	diagnosticsFile = file;
+	isInBatchJob = true;
+	try {
+		resetErrors();
+		step();
+		requireZeroErrors();
+		succeeded = true;
+	} catch (JobAbort const &) {
+		succeeded = false;
+	}
+	isInBatchJob = false;
+	diagnosticsFile = nullptr;
+	output.end = ftell(file);
+	return succeeded;
+}
+
+static void printJobOutput(JobOutput const &output) {
+	char buf[4096];
+
+	fseek(output.file, output.begin, SEEK_SET);
+	for (long left = output.end - output.begin; left > 0;) {
+		size_t nbRead = fread(buf, 1, std::min<long>(left, sizeof(buf)), output.file);
+		if (nbRead == 0) {
+			break;
+		}
+		fwrite(buf, 1, nbRead, stderr);
+		left -= nbRead;
+	}
+}
+
+// Converts the jobs whose options could be parsed, spreading them across threads.
+// Each thread prints its jobs' diagnostics to its own file.
+static void convertJobs(std::vector<BatchJob> &jobs, std::vector<FILE *> const &files) {
+	std::atomic<size_t> nextJob = 0;
+	auto convertNextJobs = [&](FILE *file) {
+		for (size_t i; (i = nextJob++) < jobs.size();) {
+			BatchJob &job = jobs[i];
+			if (job.failed) {
+				continue;
+			}
+			job.failed = !runJobStep(file, job.outputs[1], [&job] {
+				options = job.options;
+				localOptions = job.localOptions;
+				warnings.state = job.warningState;
+				convert();
+			});
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < files.size(); ++i) {
+		threads.emplace_back(convertNextJobs, files[i]);
+	}
+	convertNextJobs(files[0]);
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+}
+
+// Prints the jobs' diagnostics in the manifest's order, regardless of which finished first.
+// Returns how many jobs failed.
+static size_t printJobOutputs(std::vector<BatchJob> const &jobs) {
+	size_t nbFailed = 0;
+	for (BatchJob const &job : jobs) {
+		if (std::any_of(RANGE(job.outputs), [](JobOutput const &output) {
+			    return output.end != output.begin;
+		    })) {
+			fprintf(stderr, "In batch job at %s(%" PRIu32 "):\n", batchManifest, job.lineNo);
+			for (JobOutput const &output : job.outputs) {
+				if (output.file) {
+					printJobOutput(output);
+				}
+			}
+		}
+		if (job.failed) {
+			++nbFailed;
+		}
+	}
+	return nbFailed;
+}
+
+// Checks that an image of a shared tileset can be converted along with the `first` one, i.e. that
+// they agree on the options that apply to the whole tileset (and to the palettes, if shared too).
+static void checkSharedTilesetImage(Options const *first) {
+	if (localOptions.reverse) {
+		error("Shared tilesets cannot be used in reverse mode");
+	} else if (options.input.empty()) {
+		error("No input image specified for the shared tileset");
+	}
+	if (!options.allowDedup) {
+		error("Shared tilesets require deduplicating tiles (`-u`, `-m`, `-X`, or `-Y`)");
+	}
+	if (!first) {
+		return;
+	}
+
+	auto check = [](bool same, char const *flag) {
+		if (!same) {
+			error("`%s` must be the same for all images of a shared tileset", flag);
+		}
+	};
+	check(options.allowMirroringX == first->allowMirroringX, "-X");
+	check(options.allowMirroringY == first->allowMirroringY, "-Y");
+	check(options.baseTileIDs == first->baseTileIDs, "-b");
+	check(options.bitDepth == first->bitDepth, "-d");
+	check(options.inputTileset == first->inputTileset, "-i");
+	check(options.maxNbTiles == first->maxNbTiles, "-N");
+	check(options.output == first->output, "-o");
+	check(options.trim == first->trim, "-x");
+	check(options.columnMajor == first->columnMajor, "-Z");
+	if (sharedPalettes) {
+		check(options.useColorCurve == first->useColorCurve, "-C");
+		check(
+		    options.palSpecType == first->palSpecType && options.palSpec == first->palSpec
+		        && options.palSpecDmg == first->palSpecDmg,
+		    "-c"
+		);
+		check(options.nbPalettes == first->nbPalettes, "-n");
+		check(options.palettes == first->palettes, "-p");
+		check(options.packSeed == first->packSeed, "--pack-seed");
+		check(options.packTries == first->packTries, "--pack-tries");
+		check(options.nbColorsPerPal == first->nbColorsPerPal, "-s");
+	}
+}
+
+// Runs each line of the batch manifest as its own conversion, on top of the command line's
+// options. Jobs are spread across threads; a job failing does not prevent the others from running.
+// With `--shared-tileset`, the lines are instead the images of a single conversion.
+static int runBatch() {
+	std::vector<char> argPool;
+	std::vector<AtFileLine> lines;
+	std::vector<size_t> offsets = readAtFile(batchManifest, argPool, &lines);
+
+	std::vector<BatchJob> jobs(lines.size());
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		BatchJob &job = jobs[i];
+		size_t end = i + 1 < lines.size() ? lines[i + 1].firstArg : offsets.size();
+
+		job.lineNo = lines[i].lineNo;
+		// Copy `argv[0]` for error reporting, and because option parsing skips it
+		job.argv.push_back(const_cast<char *>(batchManifest));
+		for (size_t arg = lines[i].firstArg; arg < end; ++arg) {
+			job.argv.push_back(&argPool.data()[offsets[arg]]);
+		}
+		job.argv.push_back(nullptr);
+	}
+
+	size_t nbThreads = nbBatchThreads;
+	if (nbThreads == 0) {
+		nbThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	nbThreads = sharedTileset ? 1 : std::clamp<size_t>(jobs.size(), 1, nbThreads);
+	// Each thread prints its jobs' diagnostics to its own file, so that each job's stay together
+	std::vector<FILE *> files(nbThreads);
+	for (FILE *&file : files) {
+		file = tmpfile();
+		if (!file) {
+			fatal("Failed to create a temporary file: %s", strerror(errno));
+		}
+	}
+
+	// Option parsing is not thread-safe, so parse all jobs' options up front
+	Options const defaultOptions = options;
+	LocalOptions const defaultLocalOptions = localOptions;
+	DiagnosticsState<WarningID> const defaultWarningState = warnings.state;
+	std::vector<std::vector<char>> argPools;
+	Options const *firstImage = nullptr;
+	parsingBatchJob = true;
+	for (BatchJob &job : jobs) {
+		job.failed = !runJobStep(files[0], job.outputs[0], [&] {
+			options = defaultOptions;
+			localOptions = defaultLocalOptions;
+			warnings.state = defaultWarningState;
+			parseCommandLine(job.argv.size() - 1, job.argv.data(), argPools);
+			finishOptions();
+			if (sharedTileset) {
+				checkSharedTilesetImage(firstImage);
+			}
+		});
+		job.options = options;
+		job.localOptions = localOptions;
+		job.warningState = warnings.state;
+		if (!job.failed && !firstImage) {
+			firstImage = &job.options;
+		}
+	}
+
+	// A shared tileset's images are all converted together, once all of them have been checked
+	if (!sharedTileset) {
+		convertJobs(jobs, files);
+	}
+
+	size_t nbFailed = printJobOutputs(jobs);
+	for (FILE *file : files) {
+		fclose(file);
+	}
+	if (nbFailed != 0) {
+		fprintf(
+		    stderr,
+		    "%zu of %zu batch job%s failed\n",
+		    nbFailed,
+		    jobs.size(),
+		    jobs.size() == 1 ? "" : "s"
+		);
+		return 1;
+	}
+
+	if (sharedTileset && !jobs.empty()) {
+		std::vector<Options> images;
+		for (BatchJob const &job : jobs) {
+			images.push_back(job.options);
+		}
+		warnings.state = defaultWarningState;
+		processSharedTileset(images, sharedPalettes);
+		requireZeroErrors();
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	std::vector<std::vector<char>> argPools;
+	parseCommandLine(argc, argv, argPools);
+
+	if (sharedTileset && !batchManifest) {
+		fatalWithUsage("`--shared-tileset` requires `--batch`");
+	} else if (sharedPalettes && !sharedTileset) {
+		fatalWithUsage("`--shared-palettes` requires `--shared-tileset`");
+	}
+
+	if (batchManifest) {
+		// Do not do anything if option parsing went wrong.
+		requireZeroErrors();
+		return runBatch();
+	}
+
+	finishOptions();
+	convert();
 
 	requireZeroErrors();
 	return 0;
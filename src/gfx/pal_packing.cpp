@@ -3,16 +3,20 @@
 #include "gfx/pal_packing.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <deque>
 #include <inttypes.h>
 #include <numeric>
 #include <optional>
 #include <queue>
+#include <random>
 #include <stdint.h>
+#include <thread>
 #include <type_traits>
-#include <unordered_set>
 #include <utility>
 
+#include "diagnostics.hpp"
 #include "helpers.hpp"
 
 #include "gfx/main.hpp"
@@ -27,6 +31,48 @@
 //  Tile | Proto-palette
 //  Page | Palette
 
+// A set of colors, as a bitset; colors are numbered by rank among all of the proto-palettes' colors
+// (see `overloadAndRemove`), so that the set only takes a few words even if the image is colorful
+class ColorSet {
+	std::vector<uint64_t> _words;
+
+public:
+	explicit ColorSet(size_t nbColors) : _words((nbColors + 63) / 64) {}
+
+	void add(uint16_t color) { _words[color / 64] |= uint64_t(1) << (color % 64); }
+	void add(ProtoPalette const &protoPal) {
+		for (uint16_t color : protoPal) {
+			add(color);
+		}
+	}
+	void remove(uint16_t color) { _words[color / 64] &= ~(uint64_t(1) << (color % 64)); }
+	void clear() { std::fill(RANGE(_words), 0); }
+
+	bool contains(uint16_t color) const {
+		return _words[color / 64] & uint64_t(1) << (color % 64);
+	}
+	bool intersects(ProtoPalette const &protoPal) const {
+		return std::any_of(RANGE(protoPal), [this](uint16_t color) { return contains(color); });
+	}
+
+	size_t size() const {
+		size_t size = 0;
+		for (uint64_t word : _words) {
+			size += std::popcount(word);
+		}
+		return size;
+	}
+	// Returns the size of the union of both sets, without building it
+	size_t unionSize(ColorSet const &other) const {
+		assume(other._words.size() == _words.size());
+		size_t size = 0;
+		for (size_t i = 0; i < _words.size(); ++i) {
+			size += std::popcount(_words[i] | other._words[i]);
+		}
+		return size;
+	}
+};
+
 // A reference to a proto-palette, and attached attributes for sorting purposes
 struct ProtoPalAttrs {
 	size_t protoPalIndex;
@@ -53,11 +99,54 @@ class AssignedProtos {
 	std::vector<std::optional<ProtoPalAttrs>> _assigned;
 	// For resolving proto-palette indices
 	std::vector<ProtoPalette> const *_protoPals;
+	// All colors of the assigned proto-palettes
+	ColorSet _colors;
+	// How many of the assigned proto-palettes each of those colors belongs to
+	// There are few of them (a palette is only ever overloaded by a few colors), so a flat list of
+	// (color, multiplicity) pairs is faster to search than any map
+	std::vector<std::pair<uint16_t, uint32_t>> _multiplicities;
+
+	void addColors(ProtoPalette const &protoPal) {
+		for (uint16_t color : protoPal) {
+			auto iter = std::find_if(RANGE(_multiplicities), [&color](auto const &entry) {
+				return entry.first == color;
+			});
+			if (iter == _multiplicities.end()) {
+				_multiplicities.emplace_back(color, 1);
+				_colors.add(color);
+			} else {
+				++iter->second;
+			}
+		}
+	}
+	void removeColors(ProtoPalette const &protoPal) {
+		for (uint16_t color : protoPal) {
+			auto iter = std::find_if(RANGE(_multiplicities), [&color](auto const &entry) {
+				return entry.first == color;
+			});
+			assume(iter != _multiplicities.end());
+			if (--iter->second == 0) {
+				*iter = _multiplicities.back();
+				_multiplicities.pop_back();
+				_colors.remove(color);
+			}
+		}
+	}
+	uint32_t multiplicityOf(uint16_t color) const {
+		auto iter = std::find_if(RANGE(_multiplicities), [&color](auto const &entry) {
+			return entry.first == color;
+		});
+		return iter == _multiplicities.end() ? 0 : iter->second;
+	}
 
 public:
 	template<typename... Ts>
-	AssignedProtos(std::vector<ProtoPalette> const &protoPals, Ts &&...elems)
-	    : _assigned{std::forward<Ts>(elems)...}, _protoPals{&protoPals} {}
+	AssignedProtos(std::vector<ProtoPalette> const &protoPals, size_t nbColors, Ts &&...elems)
+	    : _assigned{std::forward<Ts>(elems)...}, _protoPals{&protoPals}, _colors(nbColors) {
+		for (ProtoPalAttrs const &attrs : *this) {
+			addColors((*_protoPals)[attrs.protoPalIndex]);
+		}
+	}
 
 private:
 	template<typename Inner, template<typename> typename Constness>
@@ -131,16 +220,20 @@ public:
 			    return slot.has_value();
 		    });
 
-		if (freeSlot == _assigned.end()) { // We are full, use a new slot
-			_assigned.emplace_back(std::forward<Ts>(args)...);
-		} else { // Reuse a free slot
-			freeSlot->emplace(std::forward<Ts>(args)...);
-		}
+		ProtoPalAttrs &attrs = freeSlot == _assigned.end()
+		                           ? *_assigned.emplace_back(std::forward<Ts>(args)...) // Full
+		                           : freeSlot->emplace(std::forward<Ts>(args)...); // Reuse a slot
+		addColors((*_protoPals)[attrs.protoPalIndex]);
 	}
 	void remove(iterator const &iter) {
+		removeColors((*_protoPals)[iter->protoPalIndex]);
 		iter._iter->reset(); // This time, we want to access the `optional` itself
 	}
-	void clear() { _assigned.clear(); }
+	void clear() {
+		_assigned.clear();
+		_colors.clear();
+		_multiplicities.clear();
+	}
 
 	bool empty() const {
 		return std::find_if(
@@ -151,36 +244,14 @@ public:
 	}
 	size_t nbProtoPals() const { return std::distance(RANGE(*this)); }
 
-private:
-	template<typename Iter>
-	static void addUniqueColors(
-	    std::unordered_set<uint16_t> &colors,
-	    Iter iter,
-	    Iter const &end,
-	    std::vector<ProtoPalette> const &protoPals
-	) {
-		for (; iter != end; ++iter) {
-			ProtoPalette const &protoPal = protoPals[iter->protoPalIndex];
-			colors.insert(RANGE(protoPal));
-		}
-	}
-	// This function should stay private because it returns a reference to a unique object
-	std::unordered_set<uint16_t> &uniqueColors() const {
-		// We check for *distinct* colors by stuffing them into a `set`; this should be
-		// faster than "back-checking" on every element (O(n²))
-		static std::unordered_set<uint16_t> colors;
-
-		colors.clear();
-		addUniqueColors(colors, RANGE(*this), *_protoPals);
-		return colors;
-	}
-public:
 	// Returns the number of distinct colors
-	size_t volume() const { return uniqueColors().size(); }
+	size_t volume() const { return _multiplicities.size(); }
 	bool canFit(ProtoPalette const &protoPal) const {
-		std::unordered_set<uint16_t> &colors = uniqueColors();
-		colors.insert(RANGE(protoPal));
-		return colors.size() <= options.maxOpaqueColors();
+		size_t volume = _multiplicities.size();
+		for (uint16_t color : protoPal) {
+			volume += !_colors.contains(color);
+		}
+		return volume <= options.maxOpaqueColors();
 	}
 
 	// The `relSizeOf` method below should compute the sum, for each color in `protoPal`, of
@@ -202,16 +273,10 @@ public:
 	// Computes the "relative size" of a proto-palette on this palette;
 	// it's a measure of how much this proto-palette would "cost" to introduce.
 	uint32_t relSizeOf(ProtoPalette const &protoPal) const {
-		// NOTE: this function must not call `uniqueColors`, or one of its callers will break!
-
 		uint32_t relSize = 0;
 		for (uint16_t color : protoPal) {
 			// How many of our proto-palettes does this color also belong to?
-			uint32_t multiplicity =
-			    std::count_if(RANGE(*this), [this, &color](ProtoPalAttrs const &attrs) {
-				    ProtoPalette const &pal = (*_protoPals)[attrs.protoPalIndex];
-				    return std::find(RANGE(pal), color) != pal.end();
-			    });
+			uint32_t multiplicity = _colors.contains(color) ? multiplicityOf(color) : 0;
 			// We increase the denominator by 1 here; the reference code does this,
 			// but the paper does not. Not adding 1 makes a multiplicity of 0 cause a division by 0
 			// (that is, if the color is not found in any proto-palette), and adding 1 still seems
@@ -224,40 +289,36 @@ public:
 		return relSize;
 	}
 
-	// Computes the "relative size" of a set of proto-palettes on this palette
-	template<typename Iter>
-	size_t combinedVolume(Iter &&begin, Iter const &end, std::vector<ProtoPalette> const &protoPals)
-	    const {
-		std::unordered_set<uint16_t> &colors = uniqueColors();
-		addUniqueColors(colors, std::forward<Iter>(begin), end, protoPals);
-		return colors.size();
+	// Computes the "relative size" of another palette's proto-palettes on this palette
+	size_t combinedVolume(AssignedProtos const &other) const {
+		return _colors.unionSize(other._colors);
 	}
 	// Computes the "relative size" of a set of colors on this palette
-	template<typename Iter>
-	size_t combinedVolume(Iter &&begin, Iter &&end) const {
-		std::unordered_set<uint16_t> &colors = uniqueColors();
-		colors.insert(std::forward<Iter>(begin), std::forward<Iter>(end));
-		return colors.size();
-	}
+	size_t combinedVolume(ColorSet const &colors) const { return _colors.unionSize(colors); }
 };
 
+// `colors` maps the proto-palettes' colors, which are ranks, back to the image's colors
 static void verboseOutputAssignments(
-    std::vector<AssignedProtos> const &assignments, std::vector<ProtoPalette> const &protoPalettes
+    std::vector<AssignedProtos> const &assignments,
+    std::vector<ProtoPalette> const &protoPalettes,
+    std::vector<uint16_t> const &colors
 ) {
 	for (AssignedProtos const &assignment : assignments) {
-		fputs("{ ", stderr);
+		fputs("{ ", diagnosticsOutput());
 		for (ProtoPalAttrs const &attrs : assignment) {
-			fprintf(stderr, "[%zu] ", attrs.protoPalIndex);
-			for (uint16_t colorIndex : protoPalettes[attrs.protoPalIndex]) {
-				fprintf(stderr, "%04" PRIx16 ", ", colorIndex);
+			fprintf(diagnosticsOutput(), "[%zu] ", attrs.protoPalIndex);
+			for (uint16_t color : protoPalettes[attrs.protoPalIndex]) {
+				fprintf(diagnosticsOutput(), "%04" PRIx16 ", ", colors[color]);
 			}
 		}
-		fprintf(stderr, "} (volume = %zu)\n", assignment.volume());
+		fprintf(diagnosticsOutput(), "} (volume = %zu)\n", assignment.volume());
 	}
 }
 
 static void decant(
-    std::vector<AssignedProtos> &assignments, std::vector<ProtoPalette> const &protoPalettes
+    std::vector<AssignedProtos> &assignments,
+    std::vector<ProtoPalette> const &protoPalettes,
+    size_t nbColors
 ) {
 	// "Decanting" is the process of moving all *things* that can fit in a lower index there
 	auto decantOn = [&assignments](auto const &tryDecanting) {
@@ -287,9 +348,9 @@ static void decant(
 	);
 
 	// Decant on palettes
-	decantOn([&protoPalettes](AssignedProtos &to, AssignedProtos &from) {
+	decantOn([](AssignedProtos &to, AssignedProtos &from) {
 		// If the entire palettes can be merged, move all of `from`'s proto-palettes
-		if (to.combinedVolume(RANGE(from), protoPalettes) <= options.maxOpaqueColors()) {
+		if (to.combinedVolume(from) <= options.maxOpaqueColors()) {
 			for (ProtoPalAttrs &attrs : from) {
 				to.assign(attrs.protoPalIndex);
 			}
@@ -301,13 +362,13 @@ static void decant(
 	);
 
 	// Decant on "components" (= proto-pals sharing colors)
-	decantOn([&protoPalettes](AssignedProtos &to, AssignedProtos &from) {
+	decantOn([&protoPalettes, &nbColors](AssignedProtos &to, AssignedProtos &from) {
 		// We need to iterate on all the "components", which are groups of proto-palettes sharing at
 		// least one color with another proto-palettes in the group.
 		// We do this by adding the first available proto-palette, and then looking for palettes
 		// with common colors. (As an optimization, we know we can skip palettes already scanned.)
 		std::vector<bool> processed(from.nbProtoPals(), false);
-		std::unordered_set<uint16_t> colors;
+		ColorSet colors(nbColors);
 		std::vector<size_t> members;
 		while (true) {
 			auto iter = std::find(RANGE(processed), true);
@@ -324,9 +385,8 @@ static void decant(
 			do {
 				ProtoPalette const &protoPal = protoPalettes[attrs->protoPalIndex];
 				// If this is the first proto-pal, or if at least one color matches, add it
-				if (members.empty()
-				    || std::find_first_of(RANGE(colors), RANGE(protoPal)) != colors.end()) {
-					colors.insert(RANGE(protoPal));
+				if (members.empty() || colors.intersects(protoPal)) {
+					colors.add(protoPal);
 					members.push_back(iter - processed.begin());
 					*iter = true; // Mark that proto-pal as processed
 				}
@@ -334,7 +394,7 @@ static void decant(
 				++attrs;
 			} while (iter != processed.end());
 
-			if (to.combinedVolume(RANGE(colors)) <= options.maxOpaqueColors()) {
+			if (to.combinedVolume(colors) <= options.maxOpaqueColors()) {
 				// Iterate through the component's proto-palettes, and transfer them
 				auto member = from.begin();
 				size_t curIndex = 0;
@@ -365,28 +425,16 @@ static void decant(
 	);
 }
 
-std::tuple<std::vector<size_t>, size_t>
-    overloadAndRemove(std::vector<ProtoPalette> const &protoPalettes) {
-	options.verbosePrint(
-	    Options::VERB_LOG_ACT, "Paginating palettes using \"overload-and-remove\" strategy...\n"
-	);
-
-	// Sort the proto-palettes by size, which improves the packing algorithm's efficiency
-	auto const indexOfLargestProtoPalFirst = [&protoPalettes](size_t left, size_t right) {
-		ProtoPalette const &lhs = protoPalettes[left];
-		ProtoPalette const &rhs = protoPalettes[right];
-		return lhs.size() > rhs.size(); // We want the proto-pals to be sorted *largest first*!
-	};
-	std::vector<size_t> sortedProtoPalIDs;
-	sortedProtoPalIDs.reserve(protoPalettes.size());
-	for (size_t i = 0; i < protoPalettes.size(); ++i) {
-		sortedProtoPalIDs.insert(
-		    std::lower_bound(RANGE(sortedProtoPalIDs), i, indexOfLargestProtoPalFirst), i
-		);
-	}
+// Packs the proto-palettes into palettes, inserting them in the given order
+static std::vector<AssignedProtos> packProtoPalettes(
+    std::vector<ProtoPalette> const &protoPalettes,
+    std::vector<uint16_t> const &colors,
+    std::vector<size_t> const &order
+) {
+	size_t nbColors = colors.size();
 
 	// Begin with all proto-palettes queued up for insertion
-	std::queue<ProtoPalAttrs> queue(std::deque<ProtoPalAttrs>(RANGE(sortedProtoPalIDs)));
+	std::queue<ProtoPalAttrs> queue(std::deque<ProtoPalAttrs>(RANGE(order)));
 	// Begin with no pages
 	std::vector<AssignedProtos> assignments{};
 
@@ -431,7 +479,7 @@ std::tuple<std::vector<size_t>, size_t>
 			    attrs.protoPalIndex,
 			    bestPalIndex
 			);
-			assignments.emplace_back(protoPalettes, std::move(attrs));
+			assignments.emplace_back(protoPalettes, nbColors, std::move(attrs));
 		} else {
 			options.verbosePrint(
 			    Options::VERB_TRACE,
@@ -531,14 +579,14 @@ std::tuple<std::vector<size_t>, size_t>
 	for (AssignedProtos &pal : assignments) {
 		if (pal.volume() > options.maxOpaqueColors()) {
 			for (ProtoPalAttrs &attrs : pal) {
-				overloadQueue.emplace(
-				    std::lower_bound(RANGE(overloadQueue), attrs, largestProtoPalFirst),
-				    std::move(attrs)
-				);
+				overloadQueue.push_back(std::move(attrs));
 			}
 			pal.clear();
 		}
 	}
+	// Among proto-palettes of the same size, the last ones queued go first
+	std::reverse(RANGE(overloadQueue));
+	std::stable_sort(RANGE(overloadQueue), largestProtoPalFirst);
 	// Place back any proto-palettes now in the queue via first-fit
 	for (ProtoPalAttrs const &attrs : overloadQueue) {
 		ProtoPalette const &protoPal = protoPalettes[attrs.protoPalIndex];
@@ -552,7 +600,7 @@ std::tuple<std::vector<size_t>, size_t>
 			    assignments.size(),
 			    attrs.protoPalIndex
 			);
-			assignments.emplace_back(protoPalettes, std::move(attrs));
+			assignments.emplace_back(protoPalettes, nbColors, std::move(attrs));
 		} else {
 			options.verbosePrint(
 			    Options::VERB_DEBUG,
@@ -566,20 +614,139 @@ std::tuple<std::vector<size_t>, size_t>
 
 	// LCOV_EXCL_START
 	if (options.verbosity >= Options::VERB_INTERM) {
-		verboseOutputAssignments(assignments, protoPalettes);
+		verboseOutputAssignments(assignments, protoPalettes, colors);
 	}
 	// LCOV_EXCL_STOP
 
 	// "Decant" the result
-	decant(assignments, protoPalettes);
+	decant(assignments, protoPalettes, nbColors);
 	// Note that the result does not contain any empty palettes
 
 	// LCOV_EXCL_START
 	if (options.verbosity >= Options::VERB_INTERM) {
-		verboseOutputAssignments(assignments, protoPalettes);
+		verboseOutputAssignments(assignments, protoPalettes, colors);
 	}
 	// LCOV_EXCL_STOP
 
+	return assignments;
+}
+
+// Returns the order in which try #`tryID` inserts the proto-palettes, derived from the seed.
+// Odd tries still insert the largest proto-palettes first, only breaking ties differently;
+// even ones ignore their size entirely.
+static std::vector<size_t> shuffledOrder(
+    std::vector<ProtoPalette> const &protoPalettes,
+    std::vector<size_t> const &sortedProtoPalIDs,
+    size_t tryID
+) {
+	std::seed_seq seq{uint32_t(options.packSeed), uint32_t(tryID)};
+	std::mt19937 rng(seq); // Its output is fully specified by the standard, unlike distributions'
+	std::vector<size_t> order = sortedProtoPalIDs;
+	// `std::shuffle` is not specified either, so shuffle by hand for portable results
+	for (size_t i = order.size(); i > 1; --i) {
+		std::swap(order[i - 1], order[rng() % i]);
+	}
+	if (tryID % 2 == 1) {
+		std::stable_sort(RANGE(order), [&protoPalettes](size_t left, size_t right) {
+			return protoPalettes[left].size() > protoPalettes[right].size();
+		});
+	}
+	return order;
+}
+
+// Packs the proto-palettes in `options.packTries - 1` more orders, spreading them across threads,
+// and keeps whichever packing uses the fewest palettes (the earliest one, in case of a tie).
+// The result thus only depends on the seed and number of tries, not on the threads' timing.
+static void packInOtherOrders(
+    std::vector<AssignedProtos> &assignments,
+    std::vector<ProtoPalette> const &protoPalettes,
+    std::vector<uint16_t> const &colors,
+    std::vector<size_t> const &sortedProtoPalIDs
+) {
+	std::vector<std::vector<AssignedProtos>> results(options.packTries);
+	results[0] = std::move(assignments);
+
+	std::atomic<size_t> nextTry = 1;
+	auto packNextTries = [&] {
+		for (size_t i; (i = nextTry++) < results.size();) {
+			results[i] = packProtoPalettes(
+			    protoPalettes, colors, shuffledOrder(protoPalettes, sortedProtoPalIDs, i)
+			);
+		}
+	};
+	// Only the first try gets logged; `options` is per-thread, so the other threads need a copy
+	Options quietOptions = options;
+	quietOptions.verbosity = Options::VERB_NONE;
+	std::vector<std::thread> threads;
+	size_t nbThreads = std::min<size_t>(std::thread::hardware_concurrency(), results.size() - 1);
+	for (size_t i = 1; i < nbThreads; ++i) {
+		threads.emplace_back([&] {
+			options = quietOptions;
+			packNextTries();
+		});
+	}
+	uint8_t verbosity = options.verbosity;
+	options.verbosity = Options::VERB_NONE;
+	packNextTries();
+	options.verbosity = verbosity;
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	auto best = std::min_element(
+	    RANGE(results),
+	    [](std::vector<AssignedProtos> const &lhs, std::vector<AssignedProtos> const &rhs) {
+		    return lhs.size() < rhs.size();
+	    }
+	);
+	options.verbosePrint(
+	    Options::VERB_DEBUG,
+	    "Keeping try %zu of %zu, with %zu palettes (the first try had %zu)\n",
+	    best - results.begin() + 1,
+	    results.size(),
+	    best->size(),
+	    results[0].size()
+	);
+	assignments = std::move(*best);
+}
+
+std::tuple<std::vector<size_t>, size_t>
+    overloadAndRemove(std::vector<ProtoPalette> const &protoPalettes) {
+	options.verbosePrint(
+	    Options::VERB_LOG_ACT, "Paginating palettes using \"overload-and-remove\" strategy...\n"
+	);
+
+	// Number the colors by rank, so that sets of them only need as many bits as there are colors.
+	// This preserves their order, so the proto-palettes' colors stay sorted the same way.
+	std::vector<uint16_t> colors;
+	for (ProtoPalette const &protoPal : protoPalettes) {
+		colors.insert(colors.end(), RANGE(protoPal));
+	}
+	std::sort(RANGE(colors));
+	colors.erase(std::unique(RANGE(colors)), colors.end());
+	std::vector<ProtoPalette> rankedProtoPals(protoPalettes.size());
+	for (size_t i = 0; i < protoPalettes.size(); ++i) {
+		for (uint16_t color : protoPalettes[i]) {
+			rankedProtoPals[i].add(std::lower_bound(RANGE(colors), color) - colors.begin());
+		}
+	}
+
+	// Sort the proto-palettes by size, which improves the packing algorithm's efficiency
+	std::vector<size_t> sortedProtoPalIDs(protoPalettes.size());
+	std::iota(RANGE(sortedProtoPalIDs), 0);
+	std::sort(RANGE(sortedProtoPalIDs), [&protoPalettes](size_t left, size_t right) {
+		size_t lhsSize = protoPalettes[left].size();
+		size_t rhsSize = protoPalettes[right].size();
+		// We want the proto-pals to be sorted *largest first*, and the last ones first among equals
+		return lhsSize != rhsSize ? lhsSize > rhsSize : left > right;
+	});
+
+	std::vector<AssignedProtos> assignments =
+	    packProtoPalettes(rankedProtoPals, colors, sortedProtoPalIDs);
+	if (options.packTries > 1) {
+		packInOtherOrders(assignments, rankedProtoPals, colors, sortedProtoPalIDs);
+	}
+
 	std::vector<size_t> mappings(protoPalettes.size());
 	for (size_t i = 0; i < assignments.size(); ++i) {
 		for (ProtoPalAttrs const &attrs : assignments[i]) {
@@ -67,18 +67,18 @@ void parseInlinePalSpec(char const * const rawArg) {
 
 		error("%s", msg); // `format_` and `-Wformat-security` would complain about `error(msg);`
 		fprintf(
-		    stderr,
+		    diagnosticsOutput(),
 		    "In inline palette spec: %s\n"
 		    "                        ",
 		    rawArg
 		);
 		for (size_t i = ofs; i; --i) {
-			putc(' ', stderr);
+			putc(' ', diagnosticsOutput());
 		}
 		for (size_t i = len; i; --i) {
-			putc('^', stderr);
+			putc('^', diagnosticsOutput());
 		}
-		putc('\n', stderr);
+		putc('\n', diagnosticsOutput());
 	};
 
 	options.palSpec.clear();
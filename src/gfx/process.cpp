@@ -3,6 +3,7 @@
 #include "gfx/process.hpp"
 
 #include <algorithm>
+#include <deque>
 #include <errno.h>
 #include <inttypes.h>
 #include <optional>
@@ -40,10 +41,10 @@ public:
 	// If the newly inserted color "conflicts" with another one (different color, but same CGB
 	// color), then the other color is returned. Otherwise, `nullptr` is returned.
 	[[nodiscard]]
-	Rgba const *registerColor(Rgba const &rgba) {
-		std::optional<Rgba> &slot = _colors[rgba.cgbColor()];
+	Rgba const *registerColor(Rgba const &rgba, uint16_t cgbColor) {
+		std::optional<Rgba> &slot = _colors[cgbColor];
 
-		if (rgba.cgbColor() == Rgba::transparent && !isBgColorTransparent()) {
+		if (cgbColor == Rgba::transparent && !isBgColorTransparent()) {
 			options.hasTransparentPixels = true;
 		}
 
@@ -63,19 +64,110 @@ public:
 	}
 	decltype(_colors) const &raw() const { return _colors; }
 
+	// Adds the other palette's colors; conflicting ones are left as they are
+	void merge(ImagePalette const &other) {
+		for (auto [slot, otherSlot] : zip(_colors, other._colors)) {
+			if (!slot.has_value()) {
+				slot = otherSlot;
+			}
+		}
+	}
+
+	bool isSuitableForGrayscale() const {
+		// Check that all of the grays don't fall into the same "bin"
+		if (size() > options.maxOpaqueColors()) { // Apply the Pigeonhole Principle
+			options.verbosePrint(
+			    Options::VERB_DEBUG,
+			    "Too many colors for grayscale sorting (%zu > %" PRIu8 ")\n",
+			    size(),
+			    options.maxOpaqueColors()
+			);
+			return false;
+		}
+		uint8_t bins = 0;
+		for (std::optional<Rgba> const &color : _colors) {
+			if (!color.has_value() || color->isTransparent()) {
+				continue;
+			}
+			if (!color->isGray()) {
+				options.verbosePrint(
+				    Options::VERB_DEBUG,
+				    "Found non-gray color #%08x, not using grayscale sorting\n",
+				    color->toCSS()
+				);
+				return false;
+			}
+			uint8_t mask = 1 << color->grayIndex();
+			if (bins & mask) { // Two in the same bin!
+				options.verbosePrint(
+				    Options::VERB_DEBUG,
+				    "Color #%08x conflicts with another one, not using grayscale sorting\n",
+				    color->toCSS()
+				);
+				return false;
+			}
+			bins |= mask;
+		}
+		return true;
+	}
+
 	auto begin() const { return _colors.begin(); }
 	auto end() const { return _colors.end(); }
 };
 
+// Once read, tiles are only kept in this compact form: their first 4 distinct colors (tiles with
+// more are invalid anyway), and 2bpp tile data indexing those instead of a palette.
+// This is a fifth of the size of the tile's pixels, and only needs 8 rows of pixels at a time.
+struct CompactTile {
+	std::array<uint16_t, 4> colors{}; // CGB colors, in order of first appearance
+	std::array<uint8_t, 16> data{};   // Indices into `colors`, as 2bpp tile data
+	uint8_t nbColors = 0;             // Distinct colors, including those that did not fit
+	bool hasTransparent = false;      // Whether one of the colors is `Rgba::transparent`
+
+	CompactTile() = default;
+	// Reads a tile's pixels (as CGB colors), whose rows are `stride` pixels apart
+	CompactTile(uint16_t const *pixels, size_t stride) {
+		std::array<uint16_t, 64> allColors;
+		for (uint32_t y = 0; y < 8; ++y, pixels += stride) {
+			uint64_t indices = 0; // One per byte, leftmost pixel in the top byte
+			for (uint32_t x = 0; x < 8; ++x) {
+				uint16_t color = pixels[x];
+				auto iter = std::find(allColors.begin(), allColors.begin() + nbColors, color);
+				if (iter == allColors.begin() + nbColors) {
+					allColors[nbColors++] = color;
+					hasTransparent |= color == Rgba::transparent;
+				}
+				// Indices past 3 get mangled, but they only occur in invalid tiles
+				indices = indices << 8 | ((iter - allColors.begin()) & 0b11);
+			}
+
+			// Pack each bitplane in one go: the multiplication moves the low bit of byte N to
+			// bit 56 + N, without any carries, so the top byte is the bitplane
+			constexpr uint64_t lowBits = 0x0101'0101'0101'0101, gather = 0x0102'0408'1020'4080;
+			data[y * 2] = (indices & lowBits) * gather >> 56;
+			data[y * 2 + 1] = (indices >> 1 & lowBits) * gather >> 56;
+		}
+		std::copy_n(allColors.begin(), std::min<size_t>(nbColors, colors.size()), colors.begin());
+	}
+};
+
 class Png {
 	std::string const &path;
 	File file{};
 	png_structp png = nullptr;
 	png_infop info = nullptr;
+	// Destroys `png` and `info`; unlike `~Png()`, this also happens if the constructor fails
+	struct ReadStructsOwner {
+		Png &self;
+		~ReadStructsOwner() { png_destroy_read_struct(&self.png, &self.info, nullptr); }
+	} readStructsOwner{*this};
 
 	// These are cached for speed
 	uint32_t width, height;
-	std::vector<Rgba> pixels;
+	// Only the tiles within the input slice are kept, in row-major order, and in compact form
+	// (see `CompactTile`), so that memory usage is proportional to the tile count, not pixel count
+	uint32_t nbTilesWide, nbTilesHigh;
+	std::vector<CompactTile> tiles;
 	ImagePalette colors;
 	int colorType;
 	int nbColors;
@@ -126,57 +218,22 @@ public:
 
 	uint32_t getHeight() const { return height; }
 
-	Rgba &pixel(uint32_t x, uint32_t y) { return pixels[y * width + x]; }
-
-	Rgba const &pixel(uint32_t x, uint32_t y) const { return pixels[y * width + x]; }
+	CompactTile const &tileAt(uint32_t x, uint32_t y) const {
+		uint32_t tileX = (x - options.inputSlice.left) / 8;
+		uint32_t tileY = (y - options.inputSlice.top) / 8;
+		return tiles[tileY * nbTilesWide + tileX];
+	}
 
 	char const *c_str() const { return file.c_str(path); }
 
-	bool isSuitableForGrayscale() const {
-		// Check that all of the grays don't fall into the same "bin"
-		if (colors.size() > options.maxOpaqueColors()) { // Apply the Pigeonhole Principle
-			options.verbosePrint(
-			    Options::VERB_DEBUG,
-			    "Too many colors for grayscale sorting (%zu > %" PRIu8 ")\n",
-			    colors.size(),
-			    options.maxOpaqueColors()
-			);
-			return false;
-		}
-		uint8_t bins = 0;
-		for (std::optional<Rgba> const &color : colors) {
-			if (!color.has_value() || color->isTransparent()) {
-				continue;
-			}
-			if (!color->isGray()) {
-				options.verbosePrint(
-				    Options::VERB_DEBUG,
-				    "Found non-gray color #%08x, not using grayscale sorting\n",
-				    color->toCSS()
-				);
-				return false;
-			}
-			uint8_t mask = 1 << color->grayIndex();
-			if (bins & mask) { // Two in the same bin!
-				options.verbosePrint(
-				    Options::VERB_DEBUG,
-				    "Color #%08x conflicts with another one, not using grayscale sorting\n",
-				    color->toCSS()
-				);
-				return false;
-			}
-			bins |= mask;
-		}
-		return true;
-	}
-
 	// Reads a PNG and notes all of its colors
 	//
 	// This code is more complicated than strictly necessary, but that's because of the API
 	// being used: the "high-level" interface doesn't provide all the transformations we need,
 	// so we use the "lower-level" one instead.
-	// We also use that occasion to only read the PNG one line at a time, since we store all of
-	// the pixel data in `pixels`, which saves on memory allocations.
+	// We also use that occasion to only read the PNG one line at a time, converting each pixel
+	// to a CGB color right away, and each row of tiles to `CompactTile`s as soon as it is complete.
+	// This way, only 8 rows of pixels are held in memory (except for interlaced images).
 	explicit Png(std::string const &filePath) : path(filePath), colors() {
 		if (file.open(path, std::ios_base::in | std::ios_base::binary) == nullptr) {
 			fatal("Failed to open input image (\"%s\"): %s", file.c_str(path), strerror(errno));
@@ -203,10 +260,7 @@ public:
 
 		info = png_create_info_struct(png);
 		if (!info) {
-			// LCOV_EXCL_START
-			png_destroy_read_struct(&png, nullptr, nullptr);
-			fatal("Failed to create PNG info structure: %s", strerror(errno));
-			// LCOV_EXCL_STOP
+			fatal("Failed to create PNG info structure: %s", strerror(errno)); // LCOV_EXCL_LINE
 		}
 
 		png_set_read_fn(png, this, readData);
@@ -240,7 +294,7 @@ public:
 			);
 			if (options.inputSlice.width % 8 == 0 && options.inputSlice.height % 8 == 0) {
 				fprintf(
-				    stderr,
+				    diagnosticsOutput(),
 				    "note: Did you mean the slice \"%" PRIu32 ",%" PRIu32 ":%" PRId32 ",%" PRId32
 				    "\"? (width and height are in tiles, not pixels!)\n",
 				    options.inputSlice.left,
@@ -252,7 +306,11 @@ public:
 			giveUp();
 		}
 
-		pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+		uint32_t sliceWidth = options.inputSlice.width ? options.inputSlice.width * 8 : width;
+		uint32_t sliceHeight = options.inputSlice.height ? options.inputSlice.height * 8 : height;
+		nbTilesWide = sliceWidth / 8;
+		nbTilesHigh = sliceHeight / 8;
+		tiles.resize(static_cast<size_t>(nbTilesWide) * static_cast<size_t>(nbTilesHigh));
 
 		auto colorTypeName = [this]() {
 			switch (colorType) {
@@ -365,9 +423,11 @@ public:
 		// Holds colors whose alpha value is ambiguous
 		std::vector<uint32_t> indeterminates;
 
-		// Assign a color to the given position, and register it in the image palette as well
-		auto assignColor =
-		    [this, &conflicts, &indeterminates](png_uint_32 x, png_uint_32 y, Rgba &&color) {
+		// Convert a color at the given position, and register it in the image palette as well
+		auto convertColor = [this, &conflicts, &indeterminates](
+		                        png_uint_32 x, png_uint_32 y, Rgba &&color
+		                    ) -> uint16_t {
+			    uint16_t cgbColor;
 			    if (!color.isTransparent() && !color.isOpaque()) {
 				    uint32_t css = color.toCSS();
 				    if (std::find(RANGE(indeterminates), css) == indeterminates.end()) {
@@ -382,7 +442,10 @@ public:
 					    );
 					    indeterminates.push_back(css);
 				    }
-			    } else if (Rgba const *other = colors.registerColor(color); other) {
+				    // Processing goes on after the error, so treat the color as opaque
+				    cgbColor = Rgba(color.red, color.green, color.blue, 0xFF).cgbColor();
+			    } else if (cgbColor = color.cgbColor();
+			               Rgba const *other = colors.registerColor(color, cgbColor)) {
 				    std::tuple conflicting{color.toCSS(), other->toCSS()};
 				    // Do not report combinations twice
 				    if (std::find(RANGE(conflicts), conflicting) == conflicts.end()) {
@@ -391,7 +454,7 @@ public:
 					        "at x: %" PRIu32 ", y: %" PRIu32 "]",
 					        std::get<0>(conflicting),
 					        std::get<1>(conflicting),
-					        color.cgbColor(),
+					        cgbColor,
 					        x,
 					        y
 					    );
@@ -400,21 +463,43 @@ public:
 				    }
 			    }
 
-			    pixel(x, y) = color;
+			    return cgbColor;
 		    };
 
+		// Compact a row of tiles, given its top-left pixel within rows `stride` pixels apart
+		auto compactTiles = [this](uint16_t const *pixels, size_t stride, uint32_t tileY) {
+			for (uint32_t tileX = 0; tileX < nbTilesWide; ++tileX) {
+				tiles[tileY * nbTilesWide + tileX] = CompactTile(&pixels[tileX * 8], stride);
+			}
+		};
+		uint32_t left = options.inputSlice.left, top = options.inputSlice.top;
+
 		if (interlaceType == PNG_INTERLACE_NONE) {
+			// Only keep the current row of tiles
+			std::vector<uint16_t> strip(static_cast<size_t>(sliceWidth) * 8);
+
 			for (png_uint_32 y = 0; y < height; ++y) {
 				png_read_row(png, row.data(), nullptr);
 
+				bool inSlice = y >= top && y - top < sliceHeight;
+				uint16_t *stripRow = &strip[(y - top) % 8 * sliceWidth];
 				for (png_uint_32 x = 0; x < width; ++x) {
-					assignColor(
+					uint16_t cgbColor = convertColor(
 					    x, y, Rgba(row[x * 4], row[x * 4 + 1], row[x * 4 + 2], row[x * 4 + 3])
 					);
+					if (inSlice && x >= left && x - left < sliceWidth) {
+						stripRow[x - left] = cgbColor;
+					}
+				}
+
+				if (inSlice && (y - top) % 8 == 7) {
+					compactTiles(strip.data(), sliceWidth, (y - top) / 8);
 				}
 			}
 		} else {
 			assume(interlaceType == PNG_INTERLACE_ADAM7);
+			// Rows are spread across all passes, so the whole image must be kept until the end
+			std::vector<uint16_t> pixels(static_cast<size_t>(width) * static_cast<size_t>(height));
 
 			// For interlace to work properly, we must read the image `nbPasses` times
 			for (int pass = 0; pass < PNG_INTERLACE_ADAM7_PASSES; ++pass) {
@@ -431,19 +516,22 @@ public:
 					png_read_row(png, ptr, nullptr);
 
 					for (png_uint_32 x = PNG_PASS_START_COL(pass); x < width; x += xStep) {
-						assignColor(x, y, Rgba(ptr[0], ptr[1], ptr[2], ptr[3]));
+						pixels[y * width + x] =
+						    convertColor(x, y, Rgba(ptr[0], ptr[1], ptr[2], ptr[3]));
 						ptr += 4;
 					}
 				}
 			}
+
+			for (uint32_t tileY = 0; tileY < nbTilesHigh; ++tileY) {
+				compactTiles(&pixels[(top + tileY * 8) * width + left], width, tileY);
+			}
 		}
 
 		// We don't care about chunks after the image data (comments, etc.)
 		png_read_end(png, nullptr);
 	}
 
-	~Png() { png_destroy_read_struct(&png, &info, nullptr); }
-
 	class TilesVisitor {
 		Png const &_png;
 		bool const _columnMajor;
@@ -461,9 +549,7 @@ public:
 
 			Tile(Png const &png, uint32_t x_, uint32_t y_) : _png(png), x(x_), y(y_) {}
 
-			Rgba pixel(uint32_t xOfs, uint32_t yOfs) const {
-				return _png.pixel(x + xOfs, y + yOfs);
-			}
+			CompactTile const &compact() const { return _png.tileAt(x, y); }
 		};
 
 	private:
@@ -574,8 +660,10 @@ static void generatePalSpec(Png const &png) {
 	}
 }
 
-static std::tuple<std::vector<size_t>, std::vector<Palette>>
-    generatePalettes(std::vector<ProtoPalette> const &protoPalettes, Png const &png) {
+// The colors are passed separately from the image, as they may be several images' colors
+static std::tuple<std::vector<size_t>, std::vector<Palette>> generatePalettes(
+    std::vector<ProtoPalette> const &protoPalettes, ImagePalette const &colors, Png const &png
+) {
 	// Run a "pagination" problem solver
 	auto [mappings, nbPalettes] = overloadAndRemove(protoPalettes);
 	assume(mappings.size() == protoPalettes.size());
@@ -583,13 +671,13 @@ static std::tuple<std::vector<size_t>, std::vector<Palette>>
 	// LCOV_EXCL_START
 	if (options.verbosity >= Options::VERB_INTERM) {
 		fprintf(
-		    stderr,
+		    diagnosticsOutput(),
 		    "Proto-palette mappings: (%zu palette%s)\n",
 		    nbPalettes,
 		    nbPalettes != 1 ? "s" : ""
 		);
 		for (size_t i = 0; i < mappings.size(); ++i) {
-			fprintf(stderr, "%zu -> %zu\n", i, mappings[i]);
+			fprintf(diagnosticsOutput(), "%zu -> %zu\n", i, mappings[i]);
 		}
 	}
 	// LCOV_EXCL_STOP
@@ -612,7 +700,7 @@ static std::tuple<std::vector<size_t>, std::vector<Palette>>
 
 	// "Sort" colors in the generated palettes, see the man page for the flowchart
 	if (options.palSpecType == Options::DMG) {
-		sortGrayscale(palettes, png.getColors().raw());
+		sortGrayscale(palettes, colors.raw());
 	} else if (auto [embPalSize, embPalRGB, embPalAlphaSize, embPalAlpha] = png.getEmbeddedPal();
 	           embPalRGB != nullptr) {
 		warning(
@@ -620,8 +708,8 @@ static std::tuple<std::vector<size_t>, std::vector<Palette>>
 		    "Sorting palette colors by PNG's embedded PLTE chunk without '-c/--colors embedded'"
 		);
 		sortIndexed(palettes, embPalSize, embPalRGB, embPalAlphaSize, embPalAlpha);
-	} else if (png.isSuitableForGrayscale()) {
-		sortGrayscale(palettes, png.getColors().raw());
+	} else if (colors.isSuitableForGrayscale()) {
+		sortGrayscale(palettes, colors.raw());
 	} else {
 		sortRgb(palettes);
 	}
@@ -642,7 +730,7 @@ static std::tuple<std::vector<size_t>, std::vector<Palette>>
 	}
 
 	auto listColors = [](auto const &list) {
-		static char buf[sizeof(", $XXXX, $XXXX, $XXXX, $XXXX")];
+		static thread_local char buf[sizeof(", $XXXX, $XXXX, $XXXX, $XXXX")];
 		char *ptr = buf;
 		for (uint16_t cgbColor : list) {
 			ptr += snprintf(ptr, sizeof(", $XXXX"), ", $%04x", cgbColor);
@@ -672,12 +760,12 @@ static std::tuple<std::vector<size_t>, std::vector<Palette>>
 	}
 	if (bad) {
 		fprintf(
-		    stderr,
+		    diagnosticsOutput(),
 		    "note: The following palette%s specified:\n",
 		    palettes.size() == 1 ? " was" : "s were"
 		);
 		for (Palette const &pal : palettes) {
-			fprintf(stderr, "        [%s]\n", listColors(pal));
+			fprintf(diagnosticsOutput(), "        [%s]\n", listColors(pal));
 		}
 		giveUp();
 	}
@@ -689,11 +777,11 @@ static void outputPalettes(std::vector<Palette> const &palettes) {
 	// LCOV_EXCL_START
 	if (options.verbosity >= Options::VERB_INTERM) {
 		for (Palette const &palette : palettes) {
-			fputs("{ ", stderr);
+			fputs("{ ", diagnosticsOutput());
 			for (uint16_t colorIndex : palette) {
-				fprintf(stderr, "%04" PRIx16 ", ", colorIndex);
+				fprintf(diagnosticsOutput(), "%04" PRIx16 ", ", colorIndex);
 			}
-			fputs("}\n", stderr);
+			fputs("}\n", diagnosticsOutput());
 		}
 	}
 	// LCOV_EXCL_STOP
@@ -755,21 +843,38 @@ public:
 	// of altering the element's hash, but the tile ID is not part of it.
 	mutable uint16_t tileID;
 
-	static uint16_t
-	    rowBitplanes(Png::TilesVisitor::Tile const &tile, Palette const &palette, uint32_t y) {
-		uint16_t row = 0;
-		for (uint32_t x = 0; x < 8; ++x) {
-			row <<= 1;
-			uint8_t index = palette.indexOf(tile.pixel(x, y).cgbColor());
-			assume(index < palette.size()); // The color should be in the palette
-			if (index & 1) {
-				row |= 1;
-			}
-			if (index & 2) {
-				row |= 0x100;
+	// Converts a tile's data from indexing its own colors to indexing the palette's
+	static std::array<uint8_t, 16> remap(CompactTile const &tile, Palette const &palette) {
+		assume(tile.nbColors <= tile.colors.size()); // Only valid tiles are remapped
+		std::array<uint8_t, 4> indices{};
+		for (uint8_t i = 0; i < tile.nbColors; ++i) {
+			indices[i] = palette.indexOf(tile.colors[i]);
+			assume(indices[i] < palette.size()); // The color should be in the palette
+		}
+
+		std::array<uint8_t, 16> data;
+		for (size_t y = 0; y < 8; ++y) {
+			uint8_t lo = tile.data[y * 2], hi = tile.data[y * 2 + 1];
+			// Which of the row's pixels use each of the tile's colors (all 8 pixels at once)
+			std::array<uint8_t, 4> masks{
+			    static_cast<uint8_t>(~lo & ~hi),
+			    static_cast<uint8_t>(lo & ~hi),
+			    static_cast<uint8_t>(~lo & hi),
+			    static_cast<uint8_t>(lo & hi),
+			};
+			uint8_t bitplane0 = 0, bitplane1 = 0;
+			for (size_t i = 0; i < masks.size(); ++i) {
+				if (indices[i] & 1) {
+					bitplane0 |= masks[i];
+				}
+				if (indices[i] & 2) {
+					bitplane1 |= masks[i];
+				}
 			}
+			data[y * 2] = bitplane0;
+			data[y * 2 + 1] = bitplane1;
 		}
-		return row;
+		return data;
 	}
 
 	TileData(std::array<uint8_t, 16> &&raw) : _data(raw), _hash(0) {
@@ -779,17 +884,6 @@ public:
 		}
 	}
 
-	TileData(Png::TilesVisitor::Tile const &tile, Palette const &palette) : _hash(0) {
-		size_t writeIndex = 0;
-		for (uint32_t y = 0; y < 8; ++y) {
-			uint16_t bitplanes = rowBitplanes(tile, palette, y);
-			hashBitplanes(bitplanes, _hash);
-
-			_data[writeIndex++] = bitplanes & 0xFF;
-			_data[writeIndex++] = bitplanes >> 8;
-		}
-	}
-
 	std::array<uint8_t, 16> const &data() const { return _data; }
 	uint16_t hash() const { return _hash; }
 
@@ -888,16 +982,13 @@ static void outputUnoptimizedTileData(
 		// If the tile is fully transparent, this defaults to palette 0.
 		Palette const &palette = palettes[attr.getPalID(mappings)];
 
-		bool empty = true;
-		for (uint32_t y = 0; y < 8; ++y) {
-			uint16_t bitplanes = TileData::rowBitplanes(tile, palette, y);
-			if (bitplanes != 0) {
-				empty = false;
-			}
-			if (tileIdx < nbKeptTiles) {
-				output->sputc(bitplanes & 0xFF);
+		std::array<uint8_t, 16> data = TileData::remap(tile.compact(), palette);
+		bool empty = std::all_of(RANGE(data), [](uint8_t byte) { return byte == 0; });
+		if (tileIdx < nbKeptTiles) {
+			for (uint32_t y = 0; y < 8; ++y) {
+				output->sputc(data[y * 2]);
 				if (options.bitDepth == 2) {
-					output->sputc(bitplanes >> 8);
+					output->sputc(data[y * 2 + 1]);
 				}
 			}
 		}
@@ -991,11 +1082,53 @@ struct UniqueTiles {
 	auto end() const { return tiles.end(); }
 };
 
+// Adds the input tileset's tiles first, so that they keep their IDs
+static void loadInputTileset(UniqueTiles &tiles) {
+	File inputTileset;
+	if (!inputTileset.open(options.inputTileset, std::ios::in | std::ios::binary)) {
+		fatal("Failed to open \"%s\": %s", options.inputTileset.c_str(), strerror(errno));
+	}
+
+	std::array<uint8_t, 16> tile;
+	size_t const tileSize = options.bitDepth * 8;
+	for (;;) {
+		// It's okay to cast between character types.
+		size_t len = inputTileset->sgetn(reinterpret_cast<char *>(tile.data()), tileSize);
+		if (len == 0) { // EOF!
+			break;
+		} else if (len != tileSize) {
+			fatal(
+			    "\"%s\" does not contain a multiple of %zu bytes; is it actually tile data?",
+			    options.inputTileset.c_str(),
+			    tileSize
+			);
+		} else if (len == 8) {
+			// Expand the tile data to 2bpp.
+			for (size_t i = 8; i--;) {
+				tile[i * 2 + 1] = 0;
+				tile[i * 2] = tile[i];
+			}
+		}
+
+		auto [tileID, matchType] = tiles.addTile(std::move(tile));
+
+		if (matchType != TileData::NOPE) {
+			error(
+			    "The input tileset's tile #%hu was deduplicated; please check that your "
+			    "deduplication flags (`-u`, `-m`) are consistent with what was used to "
+			    "generate the input tileset",
+			    tileID
+			);
+		}
+	}
+}
+
 // Generate tile data while deduplicating unique tiles (via mirroring if enabled)
 // Additionally, while we have the info handy, convert from the 16-bit "global" tile IDs to
 // 8-bit tile IDs + the bank bit; this will save the work when we output the data later (potentially
 // twice)
-static UniqueTiles dedupTiles(
+static void dedupTiles(
+    UniqueTiles &tiles,
     Png const &png,
     std::vector<AttrmapEntry> &attrmap,
     std::vector<Palette> const &palettes,
@@ -1004,48 +1137,6 @@ static UniqueTiles dedupTiles(
 	// Iterate throughout the image, generating tile data as we go
 	// (We don't need the full tile data to be able to dedup tiles, but we don't lose anything
 	// by caching the full tile data anyway, so we might as well.)
-	UniqueTiles tiles;
-
-	if (!options.inputTileset.empty()) {
-		File inputTileset;
-		if (!inputTileset.open(options.inputTileset, std::ios::in | std::ios::binary)) {
-			fatal("Failed to open \"%s\": %s", options.inputTileset.c_str(), strerror(errno));
-		}
-
-		std::array<uint8_t, 16> tile;
-		size_t const tileSize = options.bitDepth * 8;
-		for (;;) {
-			// It's okay to cast between character types.
-			size_t len = inputTileset->sgetn(reinterpret_cast<char *>(tile.data()), tileSize);
-			if (len == 0) { // EOF!
-				break;
-			} else if (len != tileSize) {
-				fatal(
-				    "\"%s\" does not contain a multiple of %zu bytes; is it actually tile data?",
-				    options.inputTileset.c_str(),
-				    tileSize
-				);
-			} else if (len == 8) {
-				// Expand the tile data to 2bpp.
-				for (size_t i = 8; i--;) {
-					tile[i * 2 + 1] = 0;
-					tile[i * 2] = tile[i];
-				}
-			}
-
-			auto [tileID, matchType] = tiles.addTile(std::move(tile));
-
-			if (matchType != TileData::NOPE) {
-				error(
-				    "The input tileset's tile #%hu was deduplicated; please check that your "
-				    "deduplication flags (`-u`, `-m`) are consistent with what was used to "
-				    "generate the input tileset",
-				    tileID
-				);
-			}
-		}
-	}
-
 	bool inputWithoutOutput = !options.inputTileset.empty() && options.output.empty();
 	for (auto [tile, attr] : zip(png.visitAsTiles(), attrmap)) {
 		if (attr.isBackgroundTile()) {
@@ -1054,8 +1145,9 @@ static UniqueTiles dedupTiles(
 			attr.bank = 0;
 			attr.tileID = 0;
 		} else {
-			auto [tileID, matchType] =
-			    tiles.addTile({tile, palettes[mappings[attr.protoPaletteID]]});
+			auto [tileID, matchType] = tiles.addTile(
+			    TileData::remap(tile.compact(), palettes[attr.getPalID(mappings)])
+			);
 
 			if (inputWithoutOutput && matchType == TileData::NOPE) {
 				error(
@@ -1073,9 +1165,6 @@ static UniqueTiles dedupTiles(
 			              + options.baseTileIDs[attr.bank];
 		}
 	}
-
-	// Copy elision should prevent the contained `unordered_set` from being re-constructed
-	return tiles;
 }
 
 static void outputTileData(UniqueTiles const &tiles) {
@@ -1156,26 +1245,20 @@ void processPalettes() {
 	outputPalettes(palettes);
 }
 
-void process() {
-	options.verbosePrint(Options::VERB_CFG, "Using libpng %s\n", png_get_libpng_ver(nullptr));
-
-	options.verbosePrint(Options::VERB_LOG_ACT, "Reading tiles...\n");
-	Png png(options.input); // This also sets `hasTransparentPixels` as a side effect
-	ImagePalette const &colors = png.getColors();
-
-	// Now, we have all the image's colors in `colors`
-	// The next step is to order the palette
-
+// Checks the image's colors, and sorts its tiles into proto-palettes, which are added to the
+// given ones (several images can thus share their proto-palettes)
+static std::vector<AttrmapEntry>
+    makeProtoPalettes(Png const &png, std::vector<ProtoPalette> &protoPalettes) {
 	// LCOV_EXCL_START
 	if (options.verbosity >= Options::VERB_INTERM) {
-		fputs("Image colors: [ ", stderr);
-		for (std::optional<Rgba> const &slot : colors) {
+		fputs("Image colors: [ ", diagnosticsOutput());
+		for (std::optional<Rgba> const &slot : png.getColors()) {
 			if (!slot.has_value()) {
 				continue;
 			}
-			fprintf(stderr, "#%08x, ", slot->toCSS());
+			fprintf(diagnosticsOutput(), "#%08x, ", slot->toCSS());
 		}
-		fputs("]\n", stderr);
+		fputs("]\n", diagnosticsOutput());
 	}
 	// LCOV_EXCL_STOP
 
@@ -1185,7 +1268,7 @@ void process() {
 			    "Image contains transparent pixels, not compatible with a DMG palette specification"
 			);
 		}
-		if (!png.isSuitableForGrayscale()) {
+		if (!png.getColors().isSuitableForGrayscale()) {
 			fatal("Image contains too many or non-gray colors, not compatible with a DMG palette "
 			      "specification");
 		}
@@ -1195,34 +1278,37 @@ void process() {
 	// We do this unconditionally because this performs the image validation (which we want to
 	// perform even if no output is requested), and because it's necessary to generate any
 	// output (with the exception of an un-duplicated tilemap, but that's an acceptable loss.)
-	std::vector<ProtoPalette> protoPalettes;
 	std::vector<AttrmapEntry> attrmap{};
 
 	for (auto tile : png.visitAsTiles()) {
 		AttrmapEntry &attrs = attrmap.emplace_back();
 
-		// Count the unique non-transparent colors for packing
-		std::unordered_set<uint16_t> tileColors;
-		for (uint32_t y = 0; y < 8; ++y) {
-			for (uint32_t x = 0; x < 8; ++x) {
-				if (Rgba color = tile.pixel(x, y);
-				    !color.isTransparent() || !options.hasTransparentPixels) {
-					tileColors.insert(color.cgbColor());
-				}
-			}
-		}
+		CompactTile const &compact = tile.compact();
 
-		if (tileColors.size() > options.maxOpaqueColors()) {
+		// Count the unique non-transparent colors for packing
+		size_t nbTileColors =
+		    compact.nbColors - (compact.hasTransparent && options.hasTransparentPixels);
+		if (nbTileColors > options.maxOpaqueColors()) {
 			fatal(
 			    "Tile at (%" PRIu32 ", %" PRIu32 ") has %zu colors, more than %" PRIu8 "!",
 			    tile.x,
 			    tile.y,
-			    tileColors.size(),
+			    nbTileColors,
 			    options.maxOpaqueColors()
 			);
 		}
 
-		if (tileColors.empty()) {
+		// Since the tile is valid, all of its colors were kept
+		assume(compact.nbColors <= compact.colors.size());
+		std::array<uint16_t, 4> tileColors;
+		nbTileColors = 0;
+		for (uint8_t i = 0; i < compact.nbColors; ++i) {
+			if (compact.colors[i] != Rgba::transparent || !options.hasTransparentPixels) {
+				tileColors[nbTileColors++] = compact.colors[i];
+			}
+		}
+
+		if (nbTileColors == 0) {
 			// "Empty" proto-palettes screw with the packing process, so discard those
 			assume(!isBgColorTransparent());
 			attrs.protoPaletteID = AttrmapEntry::transparent;
@@ -1230,13 +1316,15 @@ void process() {
 		}
 
 		ProtoPalette protoPalette;
-		for (uint16_t cgbColor : tileColors) {
-			protoPalette.add(cgbColor);
+		for (size_t i = 0; i < nbTileColors; ++i) {
+			protoPalette.add(tileColors[i]);
 		}
 
+		auto tileColorsEnd = tileColors.begin() + nbTileColors;
 		if (options.bgColor.has_value()
-		    && std::find(RANGE(tileColors), options.bgColor->cgbColor()) != tileColors.end()) {
-			if (tileColors.size() == 1) {
+		    && std::find(tileColors.begin(), tileColorsEnd, options.bgColor->cgbColor())
+		           != tileColorsEnd) {
+			if (nbTileColors == 1) {
 				// The tile contains just the background color, skip it.
 				attrs.protoPaletteID = AttrmapEntry::background;
 				continue;
@@ -1279,6 +1367,13 @@ void process() {
 continue_visiting_tiles:;
 	}
 
+	return attrmap;
+}
+
+// Generates the palettes that the proto-palettes get mapped to, and outputs them
+static std::tuple<std::vector<size_t>, std::vector<Palette>> makePalettes(
+    std::vector<ProtoPalette> const &protoPalettes, ImagePalette const &colors, Png const &png
+) {
 	options.verbosePrint(
 	    Options::VERB_INTERM,
 	    "Image contains %zu proto-palette%s\n",
@@ -1288,11 +1383,11 @@ continue_visiting_tiles:;
 	// LCOV_EXCL_START
 	if (options.verbosity >= Options::VERB_INTERM) {
 		for (ProtoPalette const &protoPal : protoPalettes) {
-			fputs("[ ", stderr);
+			fputs("[ ", diagnosticsOutput());
 			for (uint16_t color : protoPal) {
-				fprintf(stderr, "$%04x, ", color);
+				fprintf(diagnosticsOutput(), "$%04x, ", color);
 			}
-			fputs("]\n", stderr);
+			fputs("]\n", diagnosticsOutput());
 		}
 	}
 	// LCOV_EXCL_STOP
@@ -1302,10 +1397,59 @@ continue_visiting_tiles:;
 	}
 	auto [mappings, palettes] =
 	    options.palSpecType == Options::NO_SPEC || options.palSpecType == Options::DMG
-	        ? generatePalettes(protoPalettes, png)
+	        ? generatePalettes(protoPalettes, colors, png)
 	        : makePalsAsSpecified(protoPalettes);
 	outputPalettes(palettes);
 
+	return {mappings, palettes};
+}
+
+static void outputDedupedTiles(UniqueTiles const &tiles, char const *what) {
+	if (size_t nbTiles = tiles.size(); nbTiles > options.maxNbTiles[0] + options.maxNbTiles[1]) {
+		fatal(
+		    "%s contains %zu tiles, exceeding the limit of %" PRIu16 " + %" PRIu16,
+		    what,
+		    nbTiles,
+		    options.maxNbTiles[0],
+		    options.maxNbTiles[1]
+		);
+	}
+
+	if (!options.output.empty()) {
+		options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized tile data...\n");
+		outputTileData(tiles);
+	}
+}
+
+static void outputDedupedMaps(
+    std::vector<AttrmapEntry> const &attrmap, std::vector<size_t> const &mappings
+) {
+	if (!options.tilemap.empty()) {
+		options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized tilemap...\n");
+		outputTilemap(attrmap);
+	}
+
+	if (!options.attrmap.empty()) {
+		options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized attrmap...\n");
+		outputAttrmap(attrmap, mappings);
+	}
+
+	if (!options.palmap.empty()) {
+		options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized palmap...\n");
+		outputPalmap(attrmap, mappings);
+	}
+}
+
+void process() {
+	options.verbosePrint(Options::VERB_CFG, "Using libpng %s\n", png_get_libpng_ver(nullptr));
+
+	options.verbosePrint(Options::VERB_LOG_ACT, "Reading tiles...\n");
+	Png png(options.input); // This also sets `hasTransparentPixels` as a side effect
+
+	std::vector<ProtoPalette> protoPalettes;
+	std::vector<AttrmapEntry> attrmap = makeProtoPalettes(png, protoPalettes);
+	auto [mappings, palettes] = makePalettes(protoPalettes, png.getColors(), png);
+
 	// If deduplication is not happening, we just need to output the tile data and/or maps as-is
 	if (!options.allowDedup) {
 		uint32_t const nbTilesH = png.getHeight() / 8, nbTilesW = png.getWidth() / 8;
@@ -1342,36 +1486,80 @@ continue_visiting_tiles:;
 	} else {
 		// All of these require the deduplication process to be performed to be output
 		options.verbosePrint(Options::VERB_LOG_ACT, "Deduplicating tiles...\n");
-		UniqueTiles tiles = dedupTiles(png, attrmap, palettes, mappings);
+		UniqueTiles tiles;
+		if (!options.inputTileset.empty()) {
+			loadInputTileset(tiles);
+		}
+		dedupTiles(tiles, png, attrmap, palettes, mappings);
 
-		if (size_t nbTiles = tiles.size();
-		    nbTiles > options.maxNbTiles[0] + options.maxNbTiles[1]) {
-			fatal(
-			    "Image contains %zu tiles, exceeding the limit of %" PRIu16 " + %" PRIu16,
-			    nbTiles,
-			    options.maxNbTiles[0],
-			    options.maxNbTiles[1]
+		outputDedupedTiles(tiles, "Image");
+		outputDedupedMaps(attrmap, mappings);
+	}
+}
+
+void processSharedTileset(std::vector<Options> const &images, bool sharedPalettes) {
+	assume(!images.empty());
+	options = images.front();
+	options.verbosePrint(Options::VERB_CFG, "Using libpng %s\n", png_get_libpng_ver(nullptr));
+
+	UniqueTiles tiles;
+	if (!options.inputTileset.empty()) {
+		loadInputTileset(tiles);
+	}
+
+	if (sharedPalettes) {
+		// All images must be read before their palettes can be generated, so keep them around
+		std::deque<Png> pngs;
+		std::vector<std::vector<AttrmapEntry>> attrmaps;
+		std::vector<ProtoPalette> protoPalettes;
+		ImagePalette colors;
+		bool hasTransparentPixels = false;
+		for (Options const &image : images) {
+			options = image;
+			options.hasTransparentPixels = hasTransparentPixels;
+			options.verbosePrint(
+			    Options::VERB_LOG_ACT, "Reading tiles of \"%s\"...\n", options.input.c_str()
 			);
+			pngs.emplace_back(options.input);
+			hasTransparentPixels = options.hasTransparentPixels;
 		}
-
-		if (!options.output.empty()) {
-			options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized tile data...\n");
-			outputTileData(tiles);
+		// Any image having transparent pixels takes a color away from every palette, so no tile
+		// can be checked against the palette size before all images have been read
+		for (auto [image, png] : zip(images, pngs)) {
+			options = image;
+			options.hasTransparentPixels = hasTransparentPixels;
+			attrmaps.push_back(makeProtoPalettes(png, protoPalettes));
+			colors.merge(png.getColors());
 		}
+		// The palettes are sorted using the first image's embedded palette, if any
+		auto [mappings, palettes] = makePalettes(protoPalettes, colors, pngs.front());
 
-		if (!options.tilemap.empty()) {
-			options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized tilemap...\n");
-			outputTilemap(attrmap);
+		options.verbosePrint(Options::VERB_LOG_ACT, "Deduplicating tiles...\n");
+		for (auto [image, png, attrmap] : zip(images, pngs, attrmaps)) {
+			options = image;
+			options.hasTransparentPixels = hasTransparentPixels;
+			dedupTiles(tiles, png, attrmap, palettes, mappings);
+			outputDedupedMaps(attrmap, mappings);
 		}
+	} else {
+		// Each image gets its own palettes, so only one of them needs to be held at a time
+		for (Options const &image : images) {
+			options = image;
+			options.verbosePrint(
+			    Options::VERB_LOG_ACT, "Reading tiles of \"%s\"...\n", options.input.c_str()
+			);
+			Png png(options.input);
 
-		if (!options.attrmap.empty()) {
-			options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized attrmap...\n");
-			outputAttrmap(attrmap, mappings);
-		}
+			std::vector<ProtoPalette> protoPalettes;
+			std::vector<AttrmapEntry> attrmap = makeProtoPalettes(png, protoPalettes);
+			auto [mappings, palettes] = makePalettes(protoPalettes, png.getColors(), png);
 
-		if (!options.palmap.empty()) {
-			options.verbosePrint(Options::VERB_LOG_ACT, "Generating optimized palmap...\n");
-			outputPalmap(attrmap, mappings);
+			options.verbosePrint(Options::VERB_LOG_ACT, "Deduplicating tiles...\n");
+			dedupTiles(tiles, png, attrmap, palettes, mappings);
+			outputDedupedMaps(attrmap, mappings);
 		}
 	}
+
+	options = images.front();
+	outputDedupedTiles(tiles, "Shared tileset");
 }
@@ -62,18 +62,3 @@ ProtoPalette::ComparisonResult ProtoPalette::compare(ProtoPalette const &other)
 
 	return theyBigger ? THEY_BIGGER : (weBigger ? WE_BIGGER : NEITHER);
 }
-
-size_t ProtoPalette::size() const {
-	return std::distance(RANGE(*this));
-}
-
-bool ProtoPalette::empty() const {
-	return _colorIndices[0] == UINT16_MAX;
-}
-
-auto ProtoPalette::begin() const -> decltype(_colorIndices)::const_iterator {
-	return _colorIndices.begin();
-}
-auto ProtoPalette::end() const -> decltype(_colorIndices)::const_iterator {
-	return std::find(RANGE(_colorIndices), UINT16_MAX);
-}
@@ -14,7 +14,7 @@
 
 #include "diagnostics.hpp"
 #include "file.hpp"
-#include "helpers.hpp" // assume
+#include "helpers.hpp" // Defer, assume
 
 #include "gfx/main.hpp"
 #include "gfx/warning.hpp"
@@ -79,22 +79,22 @@ static void flushPng(png_structp png) {
 
 static void printColor(std::optional<Rgba> const &color) {
 	if (color) {
-		fprintf(stderr, "#%08x", color->toCSS());
+		fprintf(diagnosticsOutput(), "#%08x", color->toCSS());
 	} else {
-		fputs("<none>   ", stderr);
+		fputs("<none>   ", diagnosticsOutput());
 	}
 }
 
 static void printPalette(std::array<std::optional<Rgba>, 4> const &palette) {
-	putc('[', stderr);
+	putc('[', diagnosticsOutput());
 	printColor(palette[0]);
-	fputs(", ", stderr);
+	fputs(", ", diagnosticsOutput());
 	printColor(palette[1]);
-	fputs(", ", stderr);
+	fputs(", ", diagnosticsOutput());
 	printColor(palette[2]);
-	fputs(", ", stderr);
+	fputs(", ", diagnosticsOutput());
 	printColor(palette[3]);
-	putc(']', stderr);
+	putc(']', diagnosticsOutput());
 }
 
 void reverse() {
@@ -245,18 +245,21 @@ void reverse() {
 		if (options.palSpecType == Options::EXPLICIT && palettes != options.palSpec) {
 			warnx("Colors in the palette file do not match those specified with `-c`!");
 			// This spacing aligns "...versus with `-c`" above the column of `-c` palettes
-			fputs("Colors specified in the palette file:         ...versus with `-c`:\n", stderr);
+			fputs(
+			    "Colors specified in the palette file:         ...versus with `-c`:\n",
+			    diagnosticsOutput()
+			);
 			for (size_t i = 0; i < palettes.size() && i < options.palSpec.size(); ++i) {
 				if (i < palettes.size()) {
 					printPalette(palettes[i]);
 				} else {
-					fputs("                                            ", stderr);
+					fputs("                                            ", diagnosticsOutput());
 				}
 				if (i < options.palSpec.size()) {
-					fputs("  ", stderr);
+					fputs("  ", diagnosticsOutput());
 					printPalette(options.palSpec[i]);
 				}
-				putc('\n', stderr);
+				putc('\n', diagnosticsOutput());
 			}
 		}
 	} else if (options.palSpecType == Options::DMG) {
@@ -422,7 +425,9 @@ void reverse() {
 		fatal("Failed to create PNG write struct: %s", strerror(errno));
 		// LCOV_EXCL_STOP
 	}
-	png_infop pngInfo = png_create_info_struct(png);
+	png_infop pngInfo = nullptr;
+	Defer destroyPng{[&] { png_destroy_write_struct(&png, &pngInfo); }};
+	pngInfo = png_create_info_struct(png);
 	if (!pngInfo) {
 		// LCOV_EXCL_START
 		fatal("Failed to create PNG info structure: %s", strerror(errno));
@@ -570,6 +575,4 @@ void reverse() {
 
 	// Finalize the write
 	png_write_end(png, pngInfo);
-
-	png_destroy_write_struct(&png, &pngInfo);
 }
@@ -3,6 +3,7 @@
 #include "gfx/rgba.hpp"
 
 #include <algorithm>
+#include <array>
 #include <math.h>
 #include <stdint.h>
 
@@ -34,6 +35,28 @@ static std::array<uint8_t, 256> reverse_curve{
 };
 // clang-format on
 
+// The adjusted green component depends on both green and blue, so it is computed for every pair
+// up front: images contain many more pixels than that, and this spares three `pow`s per pixel
+static std::array<uint8_t, 256 * 256> const &greenCurve() {
+	static std::array<uint8_t, 256 * 256> const table = []() {
+		std::array<double, 256> linear;
+		for (size_t i = 0; i < linear.size(); ++i) {
+			linear[i] = pow(i / 255.0, 2.2);
+		}
+
+		std::array<uint8_t, 256 * 256> curve;
+		for (size_t g = 0; g < 256; ++g) {
+			for (size_t b = 0; b < 256; ++b) {
+				double g_adjusted = std::clamp((linear[g] * 4 - linear[b]) / 3, 0.0, 1.0);
+				uint8_t g_curved = round(pow(g_adjusted, 1 / 2.2) * 255);
+				curve[g << 8 | b] = reverse_curve[g_curved];
+			}
+		}
+		return curve;
+	}();
+	return table;
+}
+
 uint16_t Rgba::cgbColor() const {
 	if (isTransparent()) {
 		return transparent;
@@ -42,11 +65,8 @@ uint16_t Rgba::cgbColor() const {
 
 	uint8_t r = red, g = green, b = blue;
 	if (options.useColorCurve) {
-		double g_linear = pow(g / 255.0, 2.2), b_linear = pow(b / 255.0, 2.2);
-		double g_adjusted = std::clamp((g_linear * 4 - b_linear) / 3, 0.0, 1.0);
-		g = round(pow(g_adjusted, 1 / 2.2) * 255);
 		r = reverse_curve[r];
-		g = reverse_curve[g];
+		g = greenCurve()[g << 8 | b];
 		b = reverse_curve[b];
 	} else {
 		r >>= 3;
@@ -8,10 +8,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-static uintmax_t nbErrors;
+static thread_local uintmax_t nbErrors;
+static thread_local uintmax_t nbWarnings;
+
+thread_local bool isInBatchJob = false;
 
 // clang-format off: nested initializers
-Diagnostics<WarningLevel, WarningID> warnings = {
+thread_local Diagnostics<WarningLevel, WarningID> warnings = {
     .metaWarnings = {
         {"all",           LEVEL_ALL       },
         {"everything",    LEVEL_EVERYTHING},
@@ -26,11 +29,32 @@ Diagnostics<WarningLevel, WarningID> warnings = {
 // clang-format on
 
 [[noreturn]]
-void giveUp() {
-	fprintf(stderr, "Conversion aborted after %ju error%s\n", nbErrors, nbErrors == 1 ? "" : "s");
+void abortConversion() {
+	if (isInBatchJob) {
+		throw JobAbort{};
+	}
 	exit(1);
 }
 
+[[noreturn]]
+void giveUp() {
+	fprintf(
+	    diagnosticsOutput(),
+	    "Conversion aborted after %ju error%s\n",
+	    nbErrors,
+	    nbErrors == 1 ? "" : "s"
+	);
+	abortConversion();
+}
+
+uintmax_t nbWarningsPrinted() {
+	return nbWarnings + nbWarnxPrinted;
+}
+
+void resetErrors() {
+	nbErrors = 0;
+}
+
 void requireZeroErrors() {
 	if (nbErrors != 0) {
 		giveUp();
@@ -39,11 +63,11 @@ void requireZeroErrors() {
 
 void error(char const *fmt, ...) {
 	va_list ap;
-	fputs("error: ", stderr);
+	fputs("error: ", diagnosticsOutput());
 	va_start(ap, fmt);
-	vfprintf(stderr, fmt, ap);
+	vfprintf(diagnosticsOutput(), fmt, ap);
 	va_end(ap);
-	putc('\n', stderr);
+	putc('\n', diagnosticsOutput());
 
 	if (nbErrors != std::numeric_limits<decltype(nbErrors)>::max()) {
 		nbErrors++;
@@ -53,11 +77,11 @@ void error(char const *fmt, ...) {
 [[noreturn]]
 void fatal(char const *fmt, ...) {
 	va_list ap;
-	fputs("FATAL: ", stderr);
+	fputs("FATAL: ", diagnosticsOutput());
 	va_start(ap, fmt);
-	vfprintf(stderr, fmt, ap);
+	vfprintf(diagnosticsOutput(), fmt, ap);
 	va_end(ap);
-	putc('\n', stderr);
+	putc('\n', diagnosticsOutput());
 
 	if (nbErrors != std::numeric_limits<decltype(nbErrors)>::max()) {
 		nbErrors++;
@@ -75,19 +99,20 @@ void warning(WarningID id, char const *fmt, ...) {
 		break;
 
 	case WarningBehavior::ENABLED:
-		fprintf(stderr, "warning: [-W%s]\n    ", flag);
+		fprintf(diagnosticsOutput(), "warning: [-W%s]\n    ", flag);
 		va_start(ap, fmt);
-		vfprintf(stderr, fmt, ap);
+		vfprintf(diagnosticsOutput(), fmt, ap);
 		va_end(ap);
-		putc('\n', stderr);
+		putc('\n', diagnosticsOutput());
+		++nbWarnings;
 		break;
 
 	case WarningBehavior::ERROR:
-		fprintf(stderr, "error: [-Werror=%s]\n    ", flag);
+		fprintf(diagnosticsOutput(), "error: [-Werror=%s]\n    ", flag);
 		va_start(ap, fmt);
-		vfprintf(stderr, fmt, ap);
+		vfprintf(diagnosticsOutput(), fmt, ap);
 		va_end(ap);
-		putc('\n', stderr);
+		putc('\n', diagnosticsOutput());
 
 		if (nbErrors != std::numeric_limits<decltype(nbErrors)>::max()) {
 			nbErrors++;
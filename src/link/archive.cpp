@@ -0,0 +1,462 @@
+// SPDX-License-Identifier: MIT
+
+#include "link/archive.hpp"
+
+#include <algorithm>
+#include <errno.h>
+#include <inttypes.h>
+#include <optional>
+#include <span>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "diagnostics.hpp"
+#include "helpers.hpp"
+#include "linkdefs.hpp"
+#include "platform.hpp"
+#include "version.hpp"
+
+#include "link/main.hpp"
+#include "link/names.hpp"
+#include "link/object.hpp"
+#include "link/section.hpp"
+#include "link/symbol.hpp"
+#include "link/warning.hpp"
+
+struct ArchiveMember {
+	std::string name;
+	uint32_t offset;
+	uint32_t size;
+	bool isLoaded;
+};
+
+struct Archive {
+	uint8_t const *data; // Owned by the object module, along with object files' contents
+	std::string name;
+	std::vector<ArchiveMember> members;
+};
+
+// Archives, in the order they were read
+static std::vector<Archive> archives;
+
+// Indexed symbols, by name ID, along with the archive and member that define them
+static std::unordered_map<uint32_t, std::pair<size_t, uint32_t>> archiveSymbols;
+// Indexed sections, by name ID, along with the archive and members that define pieces of them
+static std::unordered_map<uint32_t, std::vector<std::pair<size_t, uint32_t>>> archiveSections;
+
+// Functions to write archives
+
+static void putLong(uint32_t n, FILE *file) {
+	uint8_t bytes[] = {
+	    static_cast<uint8_t>(n),
+	    static_cast<uint8_t>(n >> 8),
+	    static_cast<uint8_t>(n >> 16),
+	    static_cast<uint8_t>(n >> 24),
+	};
+	fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static void putString(std::string const &s, FILE *file) {
+	fwrite(s.c_str(), 1, s.length() + 1, file);
+}
+
+struct IndexEntry {
+	std::string name;
+	uint32_t memberID;
+};
+
+// `static` so `obj_ReadIndex`'s callbacks can see them
+static std::vector<IndexEntry> indexEntries;
+static std::vector<IndexEntry> sectionEntries;
+// The member exporting each indexed symbol, and its value if it is a constant
+static std::unordered_map<std::string, std::pair<uint32_t, std::optional<int32_t>>> indexedNames;
+// The first member defining each indexed section, and whether it is a union or fragment piece
+static std::unordered_map<std::string, std::pair<uint32_t, SectionModifier>> indexedSections;
+static std::vector<char const *> const *curMemberNames;
+static uint32_t curMemberID;
+
+static void indexSymbol(Symbol const &symbol) {
+	if (symbol.type != SYMTYPE_EXPORT) {
+		return;
+	}
+
+	std::optional<int32_t> value;
+	if (std::holds_alternative<int32_t>(symbol.data)) {
+		value = std::get<int32_t>(symbol.data);
+	}
+	auto [other, inserted] = indexedNames.try_emplace(symbol.name, curMemberID, value);
+	if (inserted) {
+		indexEntries.push_back({.name = symbol.name, .memberID = curMemberID});
+	} else if (!value || other->second.second != value) {
+		// Like when linking, a constant may be exported several times with the same value;
+		// the first member exporting it provides it
+		error(
+		    "\"%s\" is exported by both \"%s\" and \"%s\"",
+		    symbol.name.c_str(),
+		    (*curMemberNames)[other->second.first],
+		    (*curMemberNames)[curMemberID]
+		);
+	}
+}
+
+static void indexSection(Section const &section) {
+	auto [other, inserted] =
+	    indexedSections.try_emplace(section.name, curMemberID, section.modifier);
+	if (!inserted
+	    && (section.modifier == SECTION_NORMAL || other->second.second == SECTION_NORMAL)) {
+		// Only unions and fragments may have pieces in several members
+		error(
+		    "Section \"%s\" is defined by both \"%s\" and \"%s\"",
+		    section.name.c_str(),
+		    (*curMemberNames)[other->second.first],
+		    (*curMemberNames)[curMemberID]
+		);
+	} else {
+		sectionEntries.push_back({.name = section.name, .memberID = curMemberID});
+	}
+}
+
+static std::vector<uint8_t> readMember(char const *memberName) {
+	FILE *file = fopen(memberName, "rb");
+	if (!file) {
+		fatal("Failed to open file \"%s\": %s", memberName, strerror(errno));
+	}
+	Defer closeFile{[&] { fclose(file); }};
+
+	// Members are stored verbatim, so read the whole file
+	std::vector<uint8_t> contents;
+	uint8_t chunk[BUFSIZ];
+
+	for (size_t nbRead; (nbRead = fread(chunk, 1, sizeof(chunk), file)) != 0;) {
+		contents.insert(contents.end(), chunk, chunk + nbRead);
+	}
+	if (ferror(file)) {
+		fatal("Failed to read file \"%s\": %s", memberName, strerror(errno)); // LCOV_EXCL_LINE
+	}
+	if (contents.size() > UINT32_MAX) {
+		fatal("\"%s\" is too large to be archived", memberName); // LCOV_EXCL_LINE
+	}
+
+	obj_ReadIndex(contents.data(), contents.size(), memberName, indexSymbol, indexSection);
+	return contents;
+}
+
+void ar_WriteArchive(char const *fileName, std::vector<char const *> const &memberNames) {
+	std::vector<std::vector<uint8_t>> contents;
+
+	curMemberNames = &memberNames;
+	for (curMemberID = 0; curMemberID < memberNames.size(); curMemberID++) {
+		verbosePrint("Indexing %s...\n", memberNames[curMemberID]);
+		contents.push_back(readMember(memberNames[curMemberID]));
+	}
+	requireZeroErrors();
+
+	// Members are stored after the index, so compute its size to know their offsets
+	size_t offset = literal_strlen(RGBDS_ARCHIVE_VERSION_STRING) + 4 * 4;
+	for (char const *memberName : memberNames) {
+		offset += strlen(memberName) + 1 + 4 * 2;
+	}
+	for (std::vector<IndexEntry> const *entries : {&indexEntries, &sectionEntries}) {
+		for (IndexEntry const &entry : *entries) {
+			offset += 4 * 2 + entry.name.length() + 1 + 4;
+		}
+	}
+
+	FILE *file;
+	if (strcmp(fileName, "-")) {
+		file = fopen(fileName, "wb");
+	} else {
+		fileName = "<stdout>";
+		(void)setmode(STDOUT_FILENO, O_BINARY);
+		file = stdout;
+	}
+	if (!file) {
+		fatal("Failed to open archive file \"%s\": %s", fileName, strerror(errno));
+	}
+	Defer closeFile{[&] { fclose(file); }};
+
+	fwrite(RGBDS_ARCHIVE_VERSION_STRING, 1, literal_strlen(RGBDS_ARCHIVE_VERSION_STRING), file);
+	putLong(RGBDS_ARCHIVE_REV, file);
+
+	putLong(memberNames.size(), file);
+	for (size_t i = 0; i < memberNames.size(); i++) {
+		if (offset + contents[i].size() > UINT32_MAX) {
+			fatal("Archive file \"%s\" would be too large", fileName); // LCOV_EXCL_LINE
+		}
+		putString(memberNames[i], file);
+		putLong(offset, file);
+		putLong(contents[i].size(), file);
+		offset += contents[i].size();
+	}
+
+	// The symbol index, then the section index, have the same layout
+	for (std::vector<IndexEntry> const *entries : {&indexEntries, &sectionEntries}) {
+		putLong(entries->size(), file);
+		for (IndexEntry const &entry : *entries) {
+			uint64_t hash = hashName(entry.name);
+
+			putLong(static_cast<uint32_t>(hash), file);
+			putLong(static_cast<uint32_t>(hash >> 32), file);
+			putString(entry.name, file);
+			putLong(entry.memberID, file);
+		}
+	}
+
+	for (std::vector<uint8_t> const &member : contents) {
+		fwrite(member.data(), 1, member.size(), file);
+	}
+	if (ferror(file)) {
+		fatal("Failed to write archive file \"%s\": %s", fileName, strerror(errno));
+	}
+}
+
+// Functions to read archives
+
+struct ArchiveData {
+	uint8_t const *ptr; // The next byte to read
+	uint8_t const *end;
+	char const *fileName;
+};
+
+static uint32_t readLong(ArchiveData &archive, char const *what) {
+	if (archive.end - archive.ptr < 4) {
+		fatal("%s: Cannot read %s: Unexpected end of file", archive.fileName, what);
+	}
+
+	uint8_t const *bytes = archive.ptr;
+	archive.ptr += 4;
+	return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+static std::string readString(ArchiveData &archive, char const *what) {
+	void const *end = memchr(archive.ptr, '\0', archive.end - archive.ptr);
+	if (!end) {
+		fatal("%s: Cannot read %s: Unexpected end of file", archive.fileName, what);
+	}
+
+	std::string str(
+	    reinterpret_cast<char const *>(archive.ptr), static_cast<uint8_t const *>(end) - archive.ptr
+	);
+	archive.ptr = static_cast<uint8_t const *>(end) + 1;
+	return str;
+}
+
+// Reads an entry of the symbol or section index, returning its name ID and member ID.
+static std::pair<uint32_t, uint32_t>
+    readIndexEntry(ArchiveData &archive, uint32_t nbMembers, char const *what) {
+	std::string hashWhat = std::string(what) + " hash";
+	uint32_t hashLow = readLong(archive, hashWhat.c_str());
+	uint32_t hashHigh = readLong(archive, hashWhat.c_str());
+	std::string name = readString(archive, (std::string(what) + " name").c_str());
+	uint32_t memberID = readLong(archive, (std::string(what) + " member ID").c_str());
+
+	if (memberID >= nbMembers) {
+		fatal(
+		    "%s: \"%s\" is indexed in member #%" PRIu32 ", but there are only %" PRIu32,
+		    archive.fileName,
+		    name.c_str(),
+		    memberID,
+		    nbMembers
+		);
+	}
+	uint32_t nameID = name_Intern(name, static_cast<uint64_t>(hashHigh) << 32 | hashLow);
+	if (nameID == UINT32_MAX) {
+		fatal("%s: \"%s\" has an invalid hash", archive.fileName, name.c_str());
+	}
+	return {nameID, memberID};
+}
+
+void ar_ReadArchive(uint8_t const *data, size_t size, char const *fileName) {
+	verbosePrint("Reading archive file %s\n", fileName);
+
+	ArchiveData file = {
+	    .ptr = data + literal_strlen(RGBDS_ARCHIVE_VERSION_STRING),
+	    .end = data + size,
+	    .fileName = fileName,
+	};
+
+	if (uint32_t revNum = readLong(file, "revision number"); revNum != RGBDS_ARCHIVE_REV) {
+		fatal(
+		    "%s: Unsupported archive file for rgblink %s; try rebuilding \"%s\"%s"
+		    " (expected revision %d, got %d)",
+		    fileName,
+		    get_package_version_string(),
+		    fileName,
+		    revNum > RGBDS_ARCHIVE_REV ? " or updating rgblink" : "",
+		    RGBDS_ARCHIVE_REV,
+		    revNum
+		);
+	}
+
+	size_t archiveID = archives.size();
+	Archive &archive = archives.emplace_back();
+
+	archive.data = data;
+	archive.name = fileName;
+
+	uint32_t nbMembers = readLong(file, "number of members");
+	archive.members.resize(nbMembers);
+	for (ArchiveMember &member : archive.members) {
+		member.name = readString(file, "member name");
+		member.offset = readLong(file, "member offset");
+		member.size = readLong(file, "member size");
+		member.isLoaded = false;
+		if (member.offset > size || member.size > size - member.offset) {
+			fatal("%s: Member \"%s\" is out of bounds", fileName, member.name.c_str());
+		}
+	}
+
+	uint32_t nbSymbols = readLong(file, "number of symbols");
+	verbosePrint("Reading %" PRIu32 " indexed symbols...\n", nbSymbols);
+	for (uint32_t i = 0; i < nbSymbols; i++) {
+		auto [nameID, memberID] = readIndexEntry(file, nbMembers, "symbol");
+
+		// If several archives define the same symbol, the first one read provides it
+		archiveSymbols.try_emplace(nameID, archiveID, memberID);
+	}
+
+	uint32_t nbSections = readLong(file, "number of sections");
+	verbosePrint("Reading %" PRIu32 " indexed sections...\n", nbSections);
+	for (uint32_t i = 0; i < nbSections; i++) {
+		auto [nameID, memberID] = readIndexEntry(file, nbMembers, "section");
+
+		// Likewise, the first archive defining a section provides all of its pieces
+		auto [pieces, inserted] = archiveSections.try_emplace(nameID);
+		if (inserted || pieces->second.front().first == archiveID) {
+			pieces->second.emplace_back(archiveID, memberID);
+		}
+	}
+}
+
+// `static` so the callbacks below can see it
+static std::vector<std::pair<size_t, uint32_t>> neededMembers;
+
+static void needMember(size_t archiveID, uint32_t memberID) {
+	if (ArchiveMember &member = archives[archiveID].members[memberID]; !member.isLoaded) {
+		member.isLoaded = true;
+		neededMembers.emplace_back(archiveID, memberID);
+	}
+}
+
+static void checkImport(Symbol const &symbol) {
+	if (symbol.type != SYMTYPE_IMPORT || sym_GetSymbol(symbol.nameID)) {
+		return;
+	}
+	auto search = archiveSymbols.find(symbol.nameID);
+	if (search == archiveSymbols.end()) {
+		return; // This is reported when patches are applied
+	}
+
+	auto [archiveID, memberID] = search->second;
+	needMember(archiveID, memberID);
+}
+
+// A section referenced by name needs all of its pieces, since e.g. its size depends on them
+static void checkSectionName(uint32_t nameID) {
+	auto search = archiveSections.find(nameID);
+	if (search == archiveSections.end()) {
+		return; // Unknown sections are reported when they are looked up
+	}
+	// A section that is not a union or fragment has no other pieces to load
+	if (Section const *section = sect_GetSection(nameID);
+	    section && section->modifier == SECTION_NORMAL) {
+		return;
+	}
+
+	for (auto [archiveID, memberID] : search->second) {
+		needMember(archiveID, memberID);
+	}
+}
+
+// Checks the sections that a patch's RPN expression refers to by name.
+// Malformed expressions are not reported here, but when the patch is evaluated.
+static void checkPatchReferences(Patch const &patch) {
+	std::span<uint8_t const> rpn = patch.rpnExpression;
+
+	for (size_t i = 0; i < rpn.size();) {
+		switch (rpn[i++]) {
+		case RPN_CONST:
+		case RPN_SYM:
+		case RPN_BANK_SYM:
+			i += 4;
+			break;
+
+		case RPN_BANK_SECT:
+		case RPN_SIZEOF_SECT:
+		case RPN_STARTOF_SECT: {
+			auto end = std::find(rpn.begin() + i, rpn.end(), '\0');
+			std::string_view name(
+			    reinterpret_cast<char const *>(rpn.data() + i), end - rpn.begin() - i
+			);
+			i += name.length() + 1; // Skip the terminator as well
+
+			if (uint32_t nameID = name_Find(name, hashName(name)); nameID != UINT32_MAX) {
+				checkSectionName(nameID);
+			}
+			break;
+		}
+
+		case RPN_SIZEOF_SECTTYPE:
+		case RPN_STARTOF_SECTTYPE:
+		case RPN_BIT_INDEX:
+			i++;
+			break;
+		}
+	}
+}
+
+static void checkSectionReferences(Section &section) {
+	for (Section const *component = &section; component; component = component->nextu.get()) {
+		for (Patch const &patch : component->patches) {
+			checkPatchReferences(patch);
+		}
+	}
+}
+
+void ar_LoadNeededMembers() {
+	if (archives.empty()) {
+		return; // Nothing can be needed, so do not bother looking for references
+	}
+
+	// Loading a member can make it refer to more symbols and sections, so repeat until stable
+	for (;;) {
+		obj_ForEachSymbol(checkImport);
+		sect_ForEach(checkSectionReferences);
+		for (Assertion const &assertion : assertions) {
+			checkPatchReferences(assertion.patch);
+		}
+		if (neededMembers.empty()) {
+			break;
+		}
+
+		// Load members in a consistent order, regardless of which references required them first
+		std::sort(RANGE(neededMembers));
+		for (auto [archiveID, memberID] : neededMembers) {
+			Archive const &archive = archives[archiveID];
+			ArchiveMember const &member = archive.members[memberID];
+			std::string memberName = archive.name;
+
+			memberName += '(';
+			memberName += member.name;
+			memberName += ')';
+			obj_ReadMember(&archive.data[member.offset], member.size, memberName.c_str());
+		}
+		neededMembers.clear();
+	}
+}
+
+void ar_LoadSectionMembers(std::string const &name) {
+	if (uint32_t nameID = name_Find(name, hashName(name)); nameID != UINT32_MAX) {
+		checkSectionName(nameID);
+		if (!neededMembers.empty()) {
+			ar_LoadNeededMembers();
+		}
+	}
+}
@@ -18,6 +18,7 @@
 #include "link/main.hpp"
 #include "link/output.hpp"
 #include "link/section.hpp"
+#include "link/stats.hpp"
 #include "link/symbol.hpp"
 #include "link/warning.hpp"
 
@@ -36,6 +37,8 @@ std::vector<std::deque<FreeSpace>> memory[SECTTYPE_INVALID];
 
 uint64_t nbSectionsToAssign;
 
+static std::vector<Section const *> placedSections;
+
 // Init the free space-modelling structs
 static void initFreeSpace() {
 	for (SectionType type : EnumSeq(SECTTYPE_INVALID)) {
@@ -49,18 +52,27 @@ static void initFreeSpace() {
 	}
 }
 
-// Assigns a section to a given memory location
-static void assignSection(Section &section, MemoryLocation const &location) {
+void assign_PlaceSectionAt(Section &section, uint32_t bank, uint16_t org) {
 	// Propagate the assigned location to all UNIONs/FRAGMENTs
 	// so `jr` patches in them will have the correct offset
 	for (Section *next = &section; next != nullptr; next = next->nextu.get()) {
-		next->org = location.address;
-		next->bank = location.bank;
+		next->org = org;
+		next->bank = bank;
 	}
 
+	out_AddSection(section);
+	placedSections.push_back(&section);
+}
+
+std::vector<Section const *> const &assign_PlacedSections() {
+	return placedSections;
+}
+
+// Assigns a section to a given memory location
+static void assignSection(Section &section, MemoryLocation const &location) {
 	nbSectionsToAssign--;
 
-	out_AddSection(section);
+	assign_PlaceSectionAt(section, location.bank, location.address);
 }
 
 // Checks whether a given location is suitable for placing a given section
@@ -126,6 +138,7 @@ static ssize_t getPlacement(Section const &section, MemoryLocation &location) {
 
 		// Process locations in that bank
 		while (spaceIdx < bankMem.size()) {
+			++linkStats.nbFreeSpaceChecks;
 			// If that location is OK, return it
 			if (isLocationSuitable(section, bankMem[spaceIdx], location)) {
 				return spaceIdx;
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: MIT
+
+#include "link/fold.hpp"
+
+#include <algorithm>
+#include <span>
+#include <stdint.h>
+#include <string.h>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "helpers.hpp" // assume
+#include "linkdefs.hpp"
+
+#include "link/main.hpp"
+#include "link/section.hpp"
+#include "link/symbol.hpp"
+
+// Sections that were folded into another, kept to give them its location once it is known
+static std::vector<Section *> foldedSections;
+
+// Folding candidates, by hash of their contents
+static std::unordered_map<uint64_t, std::vector<Section *>> candidates;
+static size_t nbFolded;
+
+static bool isFoldable(Section const &section) {
+	if ((section.type != SECTTYPE_ROM0 && section.type != SECTTYPE_ROMX)
+	    || section.modifier != SECTION_NORMAL || section.isAddressFixed || section.isKept
+	    || section.size == 0 || section.foldedInto) {
+		return false;
+	}
+	// Patches computed from another section's PC (in `LOAD` blocks) would not move with this one
+	return std::all_of(RANGE(section.patches), [&section](Patch const &patch) {
+		return patch.pcSection == &section;
+	});
+}
+
+static uint64_t hashSection(Section const &section) {
+	uint64_t hash = hashName(
+	    std::string_view(reinterpret_cast<char const *>(section.data.data()), section.data.size())
+	);
+	for (Patch const &patch : section.patches) {
+		hash = (hash ^ patch.offset) * 0x100000001B3;
+	}
+	return hash;
+}
+
+static Section const *getSection(char const *name) {
+	Section const *section = sect_GetSection(name);
+	return section && section->foldedInto ? section->foldedInto : section;
+}
+
+// Whether two symbols, referred to by patches of their respective sections, have the same value
+// relative to those sections
+static bool isSameSymbol(Section const &sect1, uint32_t id1, Section const &sect2, uint32_t id2) {
+	if (id1 == UINT32_MAX || id2 == UINT32_MAX) {
+		return id1 == id2; // PC; the patches' PC offsets are compared separately
+	}
+
+	auto getSymbol = [](Section const &sect, uint32_t id) -> Symbol const * {
+		if (id >= sect.fileSymbols->size()) {
+			return nullptr;
+		}
+		Symbol const &symbol = (*sect.fileSymbols)[id];
+		return symbol.type == SYMTYPE_IMPORT ? sym_GetSymbol(symbol.nameID) : &symbol;
+	};
+	Symbol const *sym1 = getSymbol(sect1, id1);
+	Symbol const *sym2 = getSymbol(sect2, id2);
+
+	// Unknown symbols are reported when patches are applied; do not fold anything using them
+	if (!sym1 || !sym2 || sym1->data.index() != sym2->data.index()) {
+		return false;
+	}
+	if (!std::holds_alternative<Label>(sym1->data)) {
+		return std::get<int32_t>(sym1->data) == std::get<int32_t>(sym2->data);
+	}
+
+	Label const &label1 = sym1->label();
+	Label const &label2 = sym2->label();
+	if (label1.offset != label2.offset) {
+		return false;
+	}
+	// Labels within the sections themselves move along with them
+	if (label1.section == &sect1 || label2.section == &sect2) {
+		return label1.section == &sect1 && label2.section == &sect2;
+	}
+	return label1.section == label2.section;
+}
+
+// Whether two patches of their respective sections compute the same value relative to them
+static bool isSamePatch(
+    Section const &sect1, Patch const &patch1, Section const &sect2, Patch const &patch2
+) {
+	std::span<uint8_t const> rpn1 = patch1.rpnExpression;
+	std::span<uint8_t const> rpn2 = patch2.rpnExpression;
+
+	if (patch1.offset != patch2.offset || patch1.pcOffset != patch2.pcOffset
+	    || patch1.type != patch2.type || rpn1.size() != rpn2.size()) {
+		return false;
+	}
+
+	auto readLong = [](std::span<uint8_t const> rpn, size_t i) {
+		return static_cast<uint32_t>(rpn[i] | rpn[i + 1] << 8 | rpn[i + 2] << 16 | rpn[i + 3] << 24);
+	};
+	for (size_t i = 0; i < rpn1.size();) {
+		if (rpn1[i] != rpn2[i]) {
+			return false;
+		}
+		switch (rpn1[i++]) {
+		case RPN_SYM:
+		case RPN_BANK_SYM:
+			if (i + 4 > rpn1.size()
+			    || !isSameSymbol(sect1, readLong(rpn1, i), sect2, readLong(rpn2, i))) {
+				return false;
+			}
+			i += 4;
+			break;
+
+		case RPN_BANK_SECT:
+		case RPN_SIZEOF_SECT:
+		case RPN_STARTOF_SECT: {
+			char const *name1 = reinterpret_cast<char const *>(&rpn1[i]);
+			char const *name2 = reinterpret_cast<char const *>(&rpn2[i]);
+			size_t len1 = strnlen(name1, rpn1.size() - i);
+			size_t len2 = strnlen(name2, rpn2.size() - i);
+			// Unterminated names are reported when patches are applied.
+			// Names of different lengths would misalign the rest of the expressions.
+			if (len1 == rpn1.size() - i || len1 != len2) {
+				return false;
+			}
+			Section const *target1 = getSection(name1);
+			Section const *target2 = getSection(name2);
+			// Sections referring to themselves by name move along with them
+			bool isSelf1 = target1 == &sect1, isSelf2 = target2 == &sect2;
+			if (!target1 || !target2 || isSelf1 != isSelf2 || (!isSelf1 && target1 != target2)) {
+				return false;
+			}
+			i += len1 + 1;
+			break;
+		}
+
+		case RPN_CONST:
+			if (i + 4 > rpn1.size() || readLong(rpn1, i) != readLong(rpn2, i)) {
+				return false;
+			}
+			i += 4;
+			break;
+
+		case RPN_SIZEOF_SECTTYPE:
+		case RPN_STARTOF_SECTTYPE:
+		case RPN_BIT_INDEX:
+			if (i >= rpn1.size() || rpn1[i] != rpn2[i]) {
+				return false;
+			}
+			i++;
+			break;
+		}
+	}
+	return true;
+}
+
+static bool isIdentical(Section const &sect1, Section const &sect2) {
+	if (sect1.type != sect2.type || sect1.size != sect2.size
+	    || sect1.isBankFixed != sect2.isBankFixed || (sect1.isBankFixed && sect1.bank != sect2.bank)
+	    || sect1.isAlignFixed != sect2.isAlignFixed
+	    || (sect1.isAlignFixed
+	        && (sect1.alignMask != sect2.alignMask || sect1.alignOfs != sect2.alignOfs))
+	    || sect1.data != sect2.data || sect1.patches.size() != sect2.patches.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < sect1.patches.size(); i++) {
+		if (!isSamePatch(sect1, sect1.patches[i], sect2, sect2.patches[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void foldSection(Section &section, Section &into) {
+	verbosePrint("Folding \"%s\" into \"%s\"\n", section.name.c_str(), into.name.c_str());
+
+	// Alias the section's labels to the one replacing it, keeping its symbol list sorted
+	for (Symbol *symbol : section.symbols) {
+		symbol->label().section = &into;
+	}
+	size_t nbSymbols = into.symbols.size();
+	into.symbols.insert(into.symbols.end(), RANGE(section.symbols));
+	std::inplace_merge(
+	    into.symbols.begin(),
+	    into.symbols.begin() + nbSymbols,
+	    into.symbols.end(),
+	    [](Symbol const *sym1, Symbol const *sym2) {
+		    return sym1->label().offset < sym2->label().offset;
+	    }
+	);
+	section.symbols.clear();
+
+	section.foldedInto = &into;
+	foldedSections.push_back(&section);
+	nbFolded++;
+}
+
+static void checkSection(Section &section) {
+	if (!isFoldable(section)) {
+		return;
+	}
+
+	std::vector<Section *> &bucket = candidates[hashSection(section)];
+	for (Section *other : bucket) {
+		if (isIdentical(section, *other)) {
+			foldSection(section, *other);
+			return;
+		}
+	}
+	bucket.push_back(&section);
+}
+
+void fold_FoldSections() {
+	verbosePrint("Folding identical sections...\n");
+
+	// Folding sections can make the sections referring to them identical, so repeat until stable
+	do {
+		candidates.clear();
+		nbFolded = 0;
+		sect_ForEach(checkSection);
+	} while (nbFolded != 0);
+	candidates.clear();
+
+	sect_RemoveSections([](Section const &section) { return section.foldedInto != nullptr; });
+	verbosePrint("Folded %zu sections\n", foldedSections.size()); // LCOV_EXCL_LINE
+}
+
+void fold_PlaceFoldedSections() {
+	for (Section *section : foldedSections) {
+		assume(section->foldedInto);
+		section->org = section->foldedInto->org;
+		section->bank = section->foldedInto->bank;
+	}
+}
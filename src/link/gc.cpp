@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: MIT
+
+#include "link/gc.hpp"
+
+#include <span>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "helpers.hpp" // assume
+#include "linkdefs.hpp"
+
+#include "link/main.hpp"
+#include "link/section.hpp"
+#include "link/symbol.hpp"
+#include "link/warning.hpp"
+
+// Sections found to be reachable; only "main" sections, never union or fragment components
+static std::unordered_set<Section const *> reachable;
+// Reachable sections whose references have yet to be followed
+static std::vector<Section const *> worklist;
+
+static void markSection(Section const *section) {
+	if (!section) {
+		return;
+	}
+	// Components of unions and fragments are reached through their main section
+	if (section->modifier != SECTION_NORMAL) {
+		section = sect_GetSection(section->nameID);
+		assume(section);
+	}
+	if (reachable.insert(section).second) {
+		worklist.push_back(section);
+	}
+}
+
+static void markSymbol(Patch const &patch, std::vector<Symbol> const &fileSymbols, uint32_t index) {
+	if (index == UINT32_MAX) {
+		markSection(patch.pcSection);
+		return;
+	}
+	if (index >= fileSymbols.size()) {
+		return; // This is reported when the patch is evaluated
+	}
+
+	Symbol const *symbol = &fileSymbols[index];
+	if (symbol->type == SYMTYPE_IMPORT) {
+		symbol = sym_GetSymbol(symbol->nameID);
+	}
+	if (symbol && std::holds_alternative<Label>(symbol->data)) {
+		markSection(symbol->label().section);
+	}
+}
+
+static uint32_t readRPNLong(std::span<uint8_t const> rpn, size_t &i) {
+	uint32_t value = 0;
+	for (uint8_t shift = 0; shift < 32 && i < rpn.size(); shift += 8) {
+		value |= rpn[i++] << shift;
+	}
+	return value;
+}
+
+// Marks everything that a patch's RPN expression refers to.
+// Malformed expressions are not reported here, but when the patch is evaluated.
+static void markPatchReferences(Patch const &patch, std::vector<Symbol> const &fileSymbols) {
+	std::span<uint8_t const> rpn = patch.rpnExpression;
+
+	for (size_t i = 0; i < rpn.size();) {
+		switch (rpn[i++]) {
+		case RPN_CONST:
+			i += 4;
+			break;
+
+		case RPN_SYM:
+		case RPN_BANK_SYM:
+			markSymbol(patch, fileSymbols, readRPNLong(rpn, i));
+			break;
+
+		case RPN_BANK_SELF:
+			markSection(patch.pcSection);
+			break;
+
+		case RPN_BANK_SECT:
+		case RPN_SIZEOF_SECT:
+		case RPN_STARTOF_SECT: {
+			std::string name;
+			for (; i < rpn.size() && rpn[i] != '\0'; i++) {
+				name.push_back(rpn[i]);
+			}
+			i++; // Skip the terminator
+			markSection(sect_GetSection(name));
+			break;
+		}
+
+		case RPN_SIZEOF_SECTTYPE:
+		case RPN_STARTOF_SECTTYPE:
+		case RPN_BIT_INDEX:
+			i++;
+			break;
+		}
+	}
+}
+
+static void markRootSection(Section &section) {
+	if (section.isAddressFixed || section.isKept) {
+		markSection(&section);
+	}
+}
+
+void gc_RemoveUnreferencedSections() {
+	verbosePrint("Removing unreferenced sections...\n");
+
+	// Find the roots: fixed sections, sections placed by the linker script,
+	// sections defining kept symbols, and anything assertions refer to
+	sect_ForEach(markRootSection);
+	for (char const *name : keepSymbols) {
+		if (Symbol const *symbol = sym_GetSymbol(name); !symbol) {
+			error("Symbol \"%s\" to keep is not exported by any object file", name);
+		} else if (!std::holds_alternative<Label>(symbol->data)) {
+			error("Symbol \"%s\" to keep is not a label", name);
+		} else {
+			markSection(symbol->label().section);
+		}
+	}
+	for (Assertion const &assertion : assertions) {
+		markPatchReferences(assertion.patch, *assertion.fileSymbols);
+	}
+
+	// Then, follow the references made by all the patches of reachable sections
+	while (!worklist.empty()) {
+		Section const *section = worklist.back();
+		worklist.pop_back();
+		for (Section const *component = section; component; component = component->nextu.get()) {
+			for (Patch const &patch : component->patches) {
+				markPatchReferences(patch, *component->fileSymbols);
+			}
+		}
+	}
+
+	size_t nbRemoved = sect_RemoveSections([](Section const &section) {
+		return !reachable.contains(&section);
+	});
+	verbosePrint("Removed %zu unreferenced sections\n", nbRemoved); // LCOV_EXCL_LINE
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: MIT
+
+#include "link/incremental.hpp"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "helpers.hpp"
+#include "itertools.hpp"
+#include "linkdefs.hpp"
+
+#include "link/assign.hpp"
+#include "link/main.hpp"
+#include "link/section.hpp"
+#include "link/warning.hpp"
+
+// The state file starts with everything that section placement depends on, followed by the
+// resulting placement. Placement is deterministic, so if the former did not change, neither
+// would the latter; comparing the inputs themselves (not a hash) rules out false positives.
+static constexpr char STATE_MAGIC[] = "RGBL";
+static constexpr uint32_t STATE_REV = 2;
+
+// Placements are stored in the order the sections were placed, since sections at the same
+// address are output in that order
+struct Placement {
+	uint32_t sectionID; // Index in `sect_ForEach`'s order
+	uint32_t bank;
+	uint16_t org;
+};
+
+// `static` so `sect_ForEach` callbacks can see them
+static std::string layoutInputs;
+static std::vector<Placement> placements;
+static std::vector<Section *> sectionList;
+static bool isLayoutReused = false;
+
+static void putLong(std::string &buf, uint32_t n) {
+	buf.push_back(static_cast<char>(n));
+	buf.push_back(static_cast<char>(n >> 8));
+	buf.push_back(static_cast<char>(n >> 16));
+	buf.push_back(static_cast<char>(n >> 24));
+}
+
+static void addSectionInputs(Section &section) {
+	sectionList.push_back(&section);
+	layoutInputs.append(section.name.c_str(), section.name.length() + 1);
+	layoutInputs.push_back(section.type);
+	putLong(layoutInputs, section.size);
+	// Only the constraints matter; the location of floating sections is what gets computed
+	layoutInputs.push_back(
+	    section.isBankFixed | section.isAddressFixed << 1 | section.isAlignFixed << 2
+	);
+	putLong(layoutInputs, section.isBankFixed ? section.bank : 0);
+	putLong(layoutInputs, section.isAddressFixed ? section.org : 0);
+	putLong(layoutInputs, section.isAlignFixed ? section.alignMask : 0);
+	putLong(layoutInputs, section.isAlignFixed ? section.alignOfs : 0);
+}
+
+static void computeLayoutInputs() {
+	layoutInputs.clear();
+	sectionList.clear();
+	// Command-line options affect the memory regions and the placement algorithm
+	for (SectionType type : EnumSeq(SECTTYPE_INVALID)) {
+		putLong(layoutInputs, sectionTypeInfo[type].size);
+		putLong(layoutInputs, sectionTypeInfo[type].lastBank);
+	}
+	putLong(layoutInputs, scrambleROMX);
+	putLong(layoutInputs, scrambleWRAMX);
+	putLong(layoutInputs, scrambleSRAM);
+	layoutInputs.push_back(overlayFileName != nullptr);
+	sect_ForEach(addSectionInputs);
+}
+
+static bool readLong(FILE *file, uint32_t &n) {
+	uint8_t bytes[4];
+
+	if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+		return false;
+	}
+	n = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+	return true;
+}
+
+// Reads the previous link's placement, if its inputs are the same as this link's
+static bool readState() {
+	FILE *file = fopen(incrementalStateName, "rb");
+	if (!file) {
+		verbosePrint("No previous layout in \"%s\"\n", incrementalStateName);
+		return false;
+	}
+	Defer closeFile{[&] { fclose(file); }};
+
+	char magic[literal_strlen(STATE_MAGIC)];
+	uint32_t revNum, inputsLength, nbPlacements;
+
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic)
+	    || memcmp(magic, STATE_MAGIC, sizeof(magic)) || !readLong(file, revNum)
+	    || revNum != STATE_REV || !readLong(file, inputsLength)) {
+		verbosePrint("\"%s\" is not a layout state file\n", incrementalStateName);
+		return false;
+	}
+
+	std::string prevInputs(inputsLength, '\0');
+	if (fread(prevInputs.data(), 1, inputsLength, file) != inputsLength
+	    || prevInputs != layoutInputs) {
+		verbosePrint("Previous layout is out of date\n");
+		return false;
+	}
+
+	if (!readLong(file, nbPlacements)) {
+		verbosePrint("Previous layout is truncated\n");
+		return false;
+	}
+	placements.resize(nbPlacements);
+	for (Placement &placement : placements) {
+		uint32_t org;
+		if (!readLong(file, placement.sectionID) || !readLong(file, placement.bank)
+		    || !readLong(file, org) || org > UINT16_MAX
+		    || placement.sectionID >= sectionList.size()) {
+			verbosePrint("Previous layout is truncated\n");
+			return false;
+		}
+		placement.org = org;
+	}
+	return true;
+}
+
+bool incr_ReuseLayout() {
+	if (!incrementalStateName) {
+		return false;
+	}
+
+	computeLayoutInputs();
+	if (!readState() || placements.size() != sectionList.size()) {
+		verbosePrint("Assigning sections from scratch...\n");
+		return false;
+	}
+
+	verbosePrint("Reusing previous layout...\n");
+	for (Placement const &placement : placements) {
+		assign_PlaceSectionAt(*sectionList[placement.sectionID], placement.bank, placement.org);
+	}
+	isLayoutReused = true;
+	return true;
+}
+
+void incr_SaveLayout() {
+	if (!incrementalStateName || isLayoutReused) {
+		return;
+	}
+
+	std::unordered_map<Section const *, uint32_t> sectionIDs;
+	for (uint32_t i = 0; i < sectionList.size(); i++) {
+		sectionIDs.emplace(sectionList[i], i);
+	}
+	placements.clear();
+	for (Section const *section : assign_PlacedSections()) {
+		placements.push_back({
+		    .sectionID = sectionIDs.at(section),
+		    .bank = section->bank,
+		    .org = section->org,
+		});
+	}
+
+	std::string state(STATE_MAGIC, literal_strlen(STATE_MAGIC));
+	putLong(state, STATE_REV);
+	putLong(state, layoutInputs.length());
+	state += layoutInputs;
+	putLong(state, placements.size());
+	for (Placement const &placement : placements) {
+		putLong(state, placement.sectionID);
+		putLong(state, placement.bank);
+		putLong(state, placement.org);
+	}
+
+	FILE *file = fopen(incrementalStateName, "wb");
+	if (!file) {
+		fatal("Failed to open state file \"%s\": %s", incrementalStateName, strerror(errno));
+	}
+	Defer closeFile{[&] { fclose(file); }};
+
+	if (fwrite(state.data(), 1, state.length(), file) != state.length()) {
+		fatal("Failed to write state file \"%s\": %s", incrementalStateName, strerror(errno));
+	}
+}
@@ -8,36 +8,51 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
 
 #include "diagnostics.hpp"
 #include "extern/getopt.hpp"
 #include "helpers.hpp" // assume
 #include "itertools.hpp"
 #include "platform.hpp"
+#include "romheader.hpp"
 #include "script.hpp"
 #include "version.hpp"
 
+#include "link/archive.hpp"
 #include "link/assign.hpp"
+#include "link/fold.hpp"
+#include "link/gc.hpp"
+#include "link/incremental.hpp"
 #include "link/object.hpp"
 #include "link/output.hpp"
 #include "link/patch.hpp"
 #include "link/section.hpp"
+#include "link/stats.hpp"
 #include "link/symbol.hpp"
 #include "link/warning.hpp"
 
-bool isDmgMode;               // -d
-char const *linkerScriptName; // -l
-char const *mapFileName;      // -m
-bool noSymInMap;              // -M
-char const *symFileName;      // -n
-char const *overlayFileName;  // -O
-char const *outputFileName;   // -o
-uint8_t padValue;             // -p
+char const *archiveName;               // -a
+bool isDmgMode;                        // -d
+bool foldSections;                     // -F
+bool gcSections;                       // -g
+char const *incrementalStateName;      // -i
+std::vector<char const *> keepSymbols; // -k
+char const *linkerScriptName;          // -l
+char const *mapFileName;               // -m
+char const *mapJSONFileName;           // --map-json
+bool noSymInMap;                       // -M
+char const *symFileName;               // -n
+char const *overlayFileName;           // -O
+char const *outputFileName;            // -o
+uint8_t padValue;                      // -p
 bool hasPadValue = false;
 // Setting these three to 0 disables the functionality
 uint16_t scrambleROMX = 0; // -S
 uint8_t scrambleWRAMX = 0;
 uint8_t scrambleSRAM = 0;
+bool printStats; // --stats
+bool statsAsJSON;
 bool is32kMode;      // -t
 bool beVerbose;      // -v
 bool isWRAM0Mode;    // -w
@@ -69,7 +84,7 @@ std::string const &FileStackNode::dump(uint32_t curLineNo) const {
 }
 
 // Short options
-static char const *optstring = "dhl:m:Mn:O:o:p:S:tVvW:wx";
+static char const *optstring = "a:dFghi:k:l:m:Mn:O:o:p:S:tVvW:wx";
 
 // Equivalent long options
 // Please keep in the same order as short opts.
@@ -78,32 +93,60 @@ static char const *optstring = "dhl:m:Mn:O:o:p:S:tVvW:wx";
 // except if it doesn't create any ambiguity (`verbose` versus `version`).
 // This is because long opt matching, even to a single char, is prioritized
 // over short opt matching.
+static int longOpt; // Long-only options
+// Header-fixing options, which are RGBFIX's long options (with their short option as value)
+static constexpr int HEADER_OPT = 0x100;
+
 static option const longopts[] = {
-    {"dmg",           no_argument,       nullptr, 'd'},
-    {"help",          no_argument,       nullptr, 'h'},
-    {"linkerscript",  required_argument, nullptr, 'l'},
-    {"map",           required_argument, nullptr, 'm'},
-    {"no-sym-in-map", no_argument,       nullptr, 'M'},
-    {"sym",           required_argument, nullptr, 'n'},
-    {"overlay",       required_argument, nullptr, 'O'},
-    {"output",        required_argument, nullptr, 'o'},
-    {"pad",           required_argument, nullptr, 'p'},
-    {"scramble",      required_argument, nullptr, 'S'},
-    {"tiny",          no_argument,       nullptr, 't'},
-    {"version",       no_argument,       nullptr, 'V'},
-    {"verbose",       no_argument,       nullptr, 'v'},
-    {"warning",       required_argument, nullptr, 'W'},
-    {"wramx",         no_argument,       nullptr, 'w'},
-    {"nopad",         no_argument,       nullptr, 'x'},
-    {nullptr,         no_argument,       nullptr, 0  }
+    {"archive",          required_argument, nullptr,  'a'             },
+    {"dmg",              no_argument,       nullptr,  'd'             },
+    {"fold-sections",    no_argument,       nullptr,  'F'             },
+    {"gc-sections",      no_argument,       nullptr,  'g'             },
+    {"help",             no_argument,       nullptr,  'h'             },
+    {"incremental",      required_argument, nullptr,  'i'             },
+    {"keep",             required_argument, nullptr,  'k'             },
+    {"linkerscript",     required_argument, nullptr,  'l'             },
+    {"map",              required_argument, nullptr,  'm'             },
+    {"map-json",         required_argument, &longOpt, 'j'             },
+    {"no-sym-in-map",    no_argument,       nullptr,  'M'             },
+    {"sym",              required_argument, nullptr,  'n'             },
+    {"overlay",          required_argument, nullptr,  'O'             },
+    {"output",           required_argument, nullptr,  'o'             },
+    {"pad",              required_argument, nullptr,  'p'             },
+    {"scramble",         required_argument, nullptr,  'S'             },
+    {"stats",            optional_argument, &longOpt, 's'             },
+    {"tiny",             no_argument,       nullptr,  't'             },
+    {"version",          no_argument,       nullptr,  'V'             },
+    {"verbose",          no_argument,       nullptr,  'v'             },
+    {"warning",          required_argument, nullptr,  'W'             },
+    {"wramx",            no_argument,       nullptr,  'w'             },
+    {"nopad",            no_argument,       nullptr,  'x'             },
+    {"color-only",       no_argument,       &longOpt, HEADER_OPT | 'C'},
+    {"color-compatible", no_argument,       &longOpt, HEADER_OPT | 'c'},
+    {"fix-spec",         required_argument, &longOpt, HEADER_OPT | 'f'},
+    {"game-id",          required_argument, &longOpt, HEADER_OPT | 'i'},
+    {"non-japanese",     no_argument,       &longOpt, HEADER_OPT | 'j'},
+    {"new-licensee",     required_argument, &longOpt, HEADER_OPT | 'k'},
+    {"logo",             required_argument, &longOpt, HEADER_OPT | 'L'},
+    {"old-licensee",     required_argument, &longOpt, HEADER_OPT | 'l'},
+    {"mbc-type",         required_argument, &longOpt, HEADER_OPT | 'm'},
+    {"rom-version",      required_argument, &longOpt, HEADER_OPT | 'n'},
+    {"overwrite",        no_argument,       &longOpt, HEADER_OPT | 'O'},
+    {"pad-value",        required_argument, &longOpt, HEADER_OPT | 'p'},
+    {"ram-size",         required_argument, &longOpt, HEADER_OPT | 'r'},
+    {"sgb-compatible",   no_argument,       &longOpt, HEADER_OPT | 's'},
+    {"title",            required_argument, &longOpt, HEADER_OPT | 't'},
+    {"validate",         no_argument,       &longOpt, HEADER_OPT | 'v'},
+    {nullptr,            no_argument,       nullptr,  0               }
 };
 
 // LCOV_EXCL_START
 static void printUsage() {
 	fputs(
-	    "Usage: rgblink [-dhMtVvwx] [-l script] [-m map_file] [-n sym_file]\n"
-	    "               [-O overlay_file] [-o out_file] [-p pad_value]\n"
-	    "               [-S spec] <file> ...\n"
+	    "Usage: rgblink [-dFghMtVvwx] [-a archive] [-i state] [-k symbol]\n"
+	    "               [-l script] [-m map_file] [-n sym_file] [-O overlay_file]\n"
+	    "               [-o out_file] [-p pad_value] [-S spec] [--map-json map_file]\n"
+	    "               [--stats[=json]] [<rgbfix long options>] <file> ...\n"
 	    "Useful options:\n"
 	    "    -l, --linkerscript <path>  set the input linker script\n"
 	    "    -m, --map <path>           set the output map file\n"
@@ -276,17 +319,39 @@ next: // Can't `continue` a `for` loop with this nontrivial iteration logic
 
 int main(int argc, char *argv[]) {
 	// Parse options
-	for (int ch; (ch = musl_getopt_long_only(argc, argv, optstring, longopts, nullptr)) != -1;) {
+	for (int ch, longIndex;
+	     (ch = musl_getopt_long_only(argc, argv, optstring, longopts, &longIndex)) != -1;) {
 		switch (ch) {
+		case 'a':
+			if (archiveName) {
+				warnx("Overriding archive file %s", archiveName);
+			}
+			archiveName = musl_optarg;
+			break;
 		case 'd':
 			isDmgMode = true;
 			isWRAM0Mode = true;
 			break;
+		case 'F':
+			foldSections = true;
+			break;
+		case 'g':
+			gcSections = true;
+			break;
 		case 'h':
 			// LCOV_EXCL_START
 			printUsage();
 			exit(0);
 			// LCOV_EXCL_STOP
+		case 'i':
+			if (incrementalStateName) {
+				warnx("Overriding state file %s", incrementalStateName);
+			}
+			incrementalStateName = musl_optarg;
+			break;
+		case 'k':
+			keepSymbols.push_back(musl_optarg);
+			break;
 		case 'l':
 			if (linkerScriptName) {
 				warnx("Overriding linker script %s", linkerScriptName);
@@ -359,6 +424,33 @@ int main(int argc, char *argv[]) {
 			// implies tiny mode
 			is32kMode = true;
 			break;
+		case 0:
+			if (longOpt & HEADER_OPT) {
+				std::string optName = std::string("--") + longopts[longIndex].name;
+				header_ParseOption(longOpt & ~HEADER_OPT, musl_optarg, optName.c_str());
+				break;
+			}
+			switch (longOpt) {
+			case 'j':
+				if (mapJSONFileName) {
+					warnx("Overriding JSON map file %s", mapJSONFileName);
+				}
+				mapJSONFileName = musl_optarg;
+				break;
+			case 's':
+				printStats = true;
+				if (!musl_optarg) {
+					statsAsJSON = false;
+				} else if (!strcasecmp(musl_optarg, "json")) {
+					statsAsJSON = true;
+				} else {
+					error(
+					    "Invalid argument for option '--stats': Unknown format \"%s\"", musl_optarg
+					);
+				}
+				break;
+			}
+			break;
 		default:
 			// LCOV_EXCL_START
 			printUsage();
@@ -367,6 +459,8 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	header_FinishOptions();
+
 	int curArgIndex = musl_optind;
 
 	// If no input files were specified, the user must have screwed up
@@ -374,6 +468,12 @@ int main(int argc, char *argv[]) {
 		fatalWithUsage("Please specify an input file (pass `-` to read from standard input)");
 	}
 
+	// Archives are only created from the input files, not linked
+	if (archiveName) {
+		ar_WriteArchive(archiveName, std::vector<char const *>(&argv[curArgIndex], &argv[argc]));
+		return 0;
+	}
+
 	// Patch the size array depending on command-line options
 	if (!is32kMode) {
 		sectionTypeInfo[SECTTYPE_ROM0].size = 0x4000;
@@ -388,13 +488,17 @@ int main(int argc, char *argv[]) {
 	}
 
 	// Read all object files first,
+	stats_BeginPhase("objects");
 	for (obj_Setup(argc - curArgIndex); curArgIndex < argc; curArgIndex++) {
 		obj_ReadFile(argv[curArgIndex], argc - curArgIndex - 1);
 	}
+	// along with the archive members that they need,
+	ar_LoadNeededMembers();
 
 	// apply the linker script's modifications,
 	if (linkerScriptName) {
 		verbosePrint("Reading linker script...\n");
+		stats_BeginPhase("script");
 
 		script_ProcessScript(linkerScriptName);
 
@@ -403,13 +507,33 @@ int main(int argc, char *argv[]) {
 	}
 
 	// then process them,
+	stats_BeginPhase("checks");
 	sect_DoSanityChecks();
 	requireZeroErrors();
-	assign_AssignSections();
+	if (gcSections) {
+		stats_BeginPhase("gc");
+		gc_RemoveUnreferencedSections();
+		requireZeroErrors();
+	} else if (!keepSymbols.empty()) {
+		warnx("Symbols to keep are ignored without `-g`");
+	}
+	if (foldSections) {
+		stats_BeginPhase("fold");
+		fold_FoldSections();
+	}
+	stats_BeginPhase("placement");
+	if (!incr_ReuseLayout()) {
+		assign_AssignSections();
+	}
+	fold_PlaceFoldedSections();
+	stats_BeginPhase("assertions");
 	patch_CheckAssertions();
 
 	// and finally output the result.
+	stats_BeginPhase("patches");
 	patch_ApplyPatches();
 	requireZeroErrors();
+	stats_BeginPhase("output");
 	out_WriteFiles();
+	incr_SaveLayout();
 }
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+
+#include "link/names.hpp"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "linkdefs.hpp"
+
+struct NameKey {
+	std::string_view name; // Points into `names`
+	uint64_t hash;
+
+	bool operator==(NameKey const &other) const {
+		return hash == other.hash && name == other.name;
+	}
+};
+
+struct NameKeyHash {
+	size_t operator()(NameKey const &key) const { return key.hash; }
+};
+
+static std::deque<std::string> names; // A deque, so that the keys below stay valid
+static std::unordered_map<NameKey, uint32_t, NameKeyHash> nameIDs;
+
+uint32_t name_Intern(std::string_view name, uint64_t hash) {
+	if (uint32_t id = name_Find(name, hash); id != UINT32_MAX) {
+		return id;
+	}
+
+	// Matching an interned name implies a correct hash, so only a new name's needs checking
+	if (hashName(name) != hash) {
+		return UINT32_MAX;
+	}
+	uint32_t id = names.size();
+	nameIDs.emplace(NameKey{.name = names.emplace_back(name), .hash = hash}, id);
+	return id;
+}
+
+uint32_t name_Find(std::string_view name, uint64_t hash) {
+	auto search = nameIDs.find({.name = name, .hash = hash});
+	return search != nameIDs.end() ? search->second : UINT32_MAX;
+}
@@ -2,6 +2,9 @@
 
 #include "link/object.hpp"
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
 #include <deque>
 #include <errno.h>
 #include <inttypes.h>
@@ -16,80 +19,186 @@
 #include "diagnostics.hpp"
 #include "helpers.hpp"
 #include "linkdefs.hpp"
+#include "mapping.hpp"
 #include "platform.hpp"
 #include "version.hpp"
 
+#include "link/archive.hpp"
 #include "link/assign.hpp"
 #include "link/main.hpp"
+#include "link/names.hpp"
 #include "link/sdas_obj.hpp"
 #include "link/section.hpp"
+#include "link/stats.hpp"
 #include "link/symbol.hpp"
 #include "link/warning.hpp"
 
 static std::deque<std::vector<Symbol>> symbolLists;
 static std::vector<std::vector<FileStackNode>> nodes;
+// Contents of RGBDS object files and archives, kept since patches refer to them in place
+static std::deque<std::shared_ptr<char[]>> fileContents;
+
+// An entry of an object file's string table
+struct ObjectString {
+	std::string str;
+	uint64_t hash;
+	uint32_t nameID; // Only interned once a name needs to be looked up, `UINT32_MAX` until then
+};
+
+// An object file's contents, read in place
+struct ObjectData {
+	uint8_t const *begin; // Since revision 15, tables are located by offsets from here
+	uint8_t const *ptr;   // The next byte to read
+	uint8_t const *end;
+	// Since revision 14, section data and RPN expressions are stored in a separate area
+	uint8_t const *blobs;
+	uint32_t blobsSize;
+};
+
+// An object file's tables, each read through its own copy of the file.
+// Before revision 15, each table follows the previous one, and most of them start with how many
+// entries they have, so they are located while reading the file instead of by its header.
+struct ObjectTables {
+	uint32_t nbNodes, nbStrings, nbSymbols, nbSections, nbPatches, nbAssertions;
+	ObjectData nodes, strings, symbols, sections, patches, assertions;
+};
 
 // Helper functions for reading object files
 
 // For internal use only by `tryReadLong` and `tryGetc`!
 #define tryRead(func, type, errval, vartype, var, file, ...) \
 	do { \
-		FILE *tmpFile = file; \
-		type tmpVal = func(tmpFile); \
+		type tmpVal = func(file); \
 		if (tmpVal == (errval)) { \
-			fatal(__VA_ARGS__, feof(tmpFile) ? "Unexpected end of file" : strerror(errno)); \
+			fatal(__VA_ARGS__, "Unexpected end of file"); \
 		} \
 		var = static_cast<vartype>(tmpVal); \
 	} while (0)
 
 // Reads an unsigned long (32-bit) value from a file, or `INT64_MAX` on failure.
-static int64_t readLong(FILE *file) {
-	uint32_t value = 0;
-
-	// Read the little-endian value byte by byte
-	for (uint8_t shift = 0; shift < sizeof(value) * CHAR_BIT; shift += 8) {
-		int byte = getc(file);
-
-		if (byte == EOF) {
-			return INT64_MAX;
-		}
-		// This must be casted to `unsigned`, not `uint8_t`. Rationale:
-		// the type of the shift is the type of `byte` after undergoing
-		// integer promotion, which would be `int` if this was casted to
-		// `uint8_t`, because int is large enough to hold a byte. This
-		// however causes values larger than 127 to be too large when
-		// shifted, potentially triggering undefined behavior.
-		value |= static_cast<unsigned int>(byte) << shift;
+static int64_t readLong(ObjectData &file) {
+	if (file.end - file.ptr < 4) {
+		return INT64_MAX;
 	}
+
+	// Read the little-endian value; the last byte must be casted to avoid shifting into the sign
+	uint32_t value = file.ptr[0] | file.ptr[1] << 8 | file.ptr[2] << 16
+	                 | static_cast<uint32_t>(file.ptr[3]) << 24;
+	file.ptr += 4;
 	return value;
 }
 
+// Reads a byte from a file, or `EOF` on failure.
+static int readByte(ObjectData &file) {
+	return file.ptr != file.end ? *file.ptr++ : EOF;
+}
+
 // Helper macro to read a long from a file to a var, or error out if it fails to.
 #define tryReadLong(var, file, ...) \
 	tryRead(readLong, int64_t, INT64_MAX, long, var, file, __VA_ARGS__)
 
 // Helper macro to read a byte from a file to a var, or error out if it fails to.
-#define tryGetc(type, var, file, ...) tryRead(getc, int, EOF, type, var, file, __VA_ARGS__)
+#define tryGetc(type, var, file, ...) tryRead(readByte, int, EOF, type, var, file, __VA_ARGS__)
 
-// Helper macro to read a '\0'-terminated string from a file, or error out if it fails to.
+// Helper macro to read a string from a file to a var, or error out if it fails to.
 #define tryReadString(var, file, ...) \
 	do { \
-		FILE *tmpFile = file; \
-		std::string &tmpVal = var; \
-		for (int tmpByte = getc(tmpFile); tmpByte != '\0'; tmpByte = getc(tmpFile)) { \
-			if (tmpByte == EOF) { \
-				fatal(__VA_ARGS__, feof(tmpFile) ? "Unexpected end of file" : strerror(errno)); \
-			} else { \
-				tmpVal.push_back(tmpByte); \
-			} \
+		ObjectData &tmpFile = file; \
+		void const *tmpEnd = memchr(tmpFile.ptr, '\0', tmpFile.end - tmpFile.ptr); \
+		if (!tmpEnd) { \
+			fatal(__VA_ARGS__, "Unexpected end of file"); \
 		} \
+		var.assign( \
+		    reinterpret_cast<char const *>(tmpFile.ptr), \
+		    static_cast<uint8_t const *>(tmpEnd) - tmpFile.ptr \
+		); \
+		tmpFile.ptr = static_cast<uint8_t const *>(tmpEnd) + 1; \
 	} while (0)
 
+// Reads a blob of `size` bytes (section data or a RPN expression) from a file, and returns a
+// pointer to it, or `nullptr` on failure. Since revision 14, only the blob's offset is inline.
+static uint8_t const *readBlob(ObjectData &file, uint32_t size, uint32_t revNum) {
+	if (revNum <= RGBDS_OBJECT_REV_INLINE_DATA) {
+		if (static_cast<size_t>(file.end - file.ptr) < size) {
+			return nullptr;
+		}
+		uint8_t const *blob = file.ptr;
+		file.ptr += size;
+		return blob;
+	}
+
+	int64_t offset = readLong(file);
+	if (offset == INT64_MAX || offset > file.blobsSize || size > file.blobsSize - offset) {
+		return nullptr;
+	}
+	return &file.blobs[offset];
+}
+
 // Functions to parse object files
 
+// Reads an entry of the string table from a file.
+static void
+    readString(ObjectData &file, ObjectString &entry, char const *fileName, uint32_t stringID) {
+	uint32_t hashLow, hashHigh;
+
+	tryReadLong(
+	    hashLow, file, "%s: Cannot read string #%" PRIu32 "'s hash: %s", fileName, stringID
+	);
+	tryReadLong(
+	    hashHigh, file, "%s: Cannot read string #%" PRIu32 "'s hash: %s", fileName, stringID
+	);
+	entry.hash = static_cast<uint64_t>(hashHigh) << 32 | hashLow;
+	tryReadString(entry.str, file, "%s: Cannot read string #%" PRIu32 ": %s", fileName, stringID);
+	entry.nameID = UINT32_MAX;
+}
+
+// Reads a symbol or section name from a file, returning its string table entry.
+// Older revisions store names inline instead, so they get appended to `strings` as they are read.
+static ObjectString &readName(
+    ObjectData &file,
+    std::vector<ObjectString> &strings,
+    uint32_t revNum,
+    char const *fileName,
+    char const *what
+) {
+	if (revNum == RGBDS_OBJECT_REV_INLINE_NAMES) {
+		ObjectString &entry = strings.emplace_back();
+
+		tryReadString(entry.str, file, "%s: Cannot read %s name: %s", fileName, what);
+		entry.hash = hashName(entry.str);
+		entry.nameID = UINT32_MAX;
+		return entry;
+	}
+
+	uint32_t stringID;
+
+	tryReadLong(stringID, file, "%s: Cannot read %s name: %s", fileName, what);
+	if (stringID >= strings.size()) {
+		fatal(
+		    "%s: %s name refers to string #%" PRIu32 ", but there are only %zu",
+		    fileName,
+		    what,
+		    stringID,
+		    strings.size()
+		);
+	}
+	return strings[stringID];
+}
+
+// Returns a name's global ID, interning it the first time it is needed.
+static uint32_t internName(ObjectString &entry, char const *fileName) {
+	if (entry.nameID == UINT32_MAX) {
+		entry.nameID = name_Intern(entry.str, entry.hash);
+		if (entry.nameID == UINT32_MAX) {
+			fatal("%s: \"%s\" has an invalid hash", fileName, entry.str.c_str());
+		}
+	}
+	return entry.nameID;
+}
+
 // Reads a file stack node from a file.
 static void readFileStackNode(
-    FILE *file, std::vector<FileStackNode> &fileNodes, uint32_t nodeID, char const *fileName
+    ObjectData &file, std::vector<FileStackNode> &fileNodes, uint32_t nodeID, char const *fileName
 ) {
 	FileStackNode &node = fileNodes[nodeID];
 	uint32_t parentID;
@@ -146,9 +255,16 @@ static void readFileStackNode(
 
 // Reads a symbol from a file.
 static void readSymbol(
-    FILE *file, Symbol &symbol, char const *fileName, std::vector<FileStackNode> const &fileNodes
+    ObjectData &file,
+    Symbol &symbol,
+    char const *fileName,
+    std::vector<FileStackNode> const &fileNodes,
+    std::vector<ObjectString> &strings,
+    uint32_t revNum
 ) {
-	tryReadString(symbol.name, file, "%s: Cannot read symbol name: %s", fileName);
+	ObjectString &name = readName(file, strings, revNum, fileName, "symbol");
+
+	symbol.name = name.str;
 	tryGetc(
 	    ExportLevel,
 	    symbol.type,
@@ -157,6 +273,8 @@ static void readSymbol(
 	    fileName,
 	    symbol.name.c_str()
 	);
+	// Local symbols are never looked up by name, so only the others' names are interned
+	symbol.nameID = symbol.type != SYMTYPE_LOCAL ? internName(name, fileName) : UINT32_MAX;
 	// If the symbol is defined in this file, read its definition
 	if (symbol.type != SYMTYPE_IMPORT) {
 		uint32_t nodeID;
@@ -199,12 +317,13 @@ static void readSymbol(
 
 // Reads a patch from a file.
 static void readPatch(
-    FILE *file,
+    ObjectData &file,
     Patch &patch,
     char const *fileName,
     std::string const &sectName,
     uint32_t patchID,
-    std::vector<FileStackNode> const &fileNodes
+    std::vector<FileStackNode> const &fileNodes,
+    uint32_t revNum
 ) {
 	uint32_t nodeID, rpnSize;
 	PatchType type;
@@ -269,18 +388,17 @@ static void readPatch(
 	    patchID
 	);
 
-	patch.rpnExpression.resize(rpnSize);
-	size_t nbElementsRead = fread(patch.rpnExpression.data(), 1, rpnSize, file);
-
-	if (nbElementsRead != rpnSize) {
+	// RPN expressions are never modified, so they are used in place
+	uint8_t const *rpn = readBlob(file, rpnSize, revNum);
+	if (!rpn) {
 		fatal(
-		    "%s: Cannot read \"%s\"'s patch #%" PRIu32 "'s RPN expression: %s",
+		    "%s: Cannot read \"%s\"'s patch #%" PRIu32 "'s RPN expression: Unexpected end of file",
 		    fileName,
 		    sectName.c_str(),
-		    patchID,
-		    feof(file) ? "Unexpected end of file" : strerror(errno)
+		    patchID
 		);
 	}
+	patch.rpnExpression = std::span(rpn, rpnSize);
 }
 
 // Sets a patch's `pcSection` from its `pcSectionID`.
@@ -292,12 +410,20 @@ static void
 
 // Reads a section from a file.
 static void readSection(
-    FILE *file, Section &section, char const *fileName, std::vector<FileStackNode> const &fileNodes
+    ObjectTables &tables,
+    Section &section,
+    char const *fileName,
+    std::vector<FileStackNode> const &fileNodes,
+    std::vector<ObjectString> &strings,
+    uint32_t revNum
 ) {
+	ObjectData &file = tables.sections;
 	int32_t tmp;
 	uint8_t byte;
+	ObjectString &name = readName(file, strings, revNum, fileName, "section");
 
-	tryReadString(section.name, file, "%s: Cannot read section name: %s", fileName);
+	section.name = name.str;
+	section.nameID = internName(name, fileName);
 	uint32_t nodeID;
 	tryReadLong(
 	    nodeID, file, "%s: Cannot read \"%s\"'s node ID: %s", fileName, section.name.c_str()
@@ -364,18 +490,16 @@ static void readSection(
 	section.alignOfs = tmp;
 
 	if (sect_HasData(section.type)) {
-		if (section.size) {
-			section.data.resize(section.size);
-			if (size_t nbRead = fread(section.data.data(), 1, section.size, file);
-			    nbRead != section.size) {
-				fatal(
-				    "%s: Cannot read \"%s\"'s data: %s",
-				    fileName,
-				    section.name.c_str(),
-				    feof(file) ? "Unexpected end of file" : strerror(errno)
-				);
-			}
+		// Section data gets patched, so unlike RPN expressions, it must be copied
+		uint8_t const *data = readBlob(file, section.size, revNum);
+		if (!data) {
+			fatal(
+			    "%s: Cannot read \"%s\"'s data: Unexpected end of file",
+			    fileName,
+			    section.name.c_str()
+			);
 		}
+		section.data.assign(data, data + section.size);
 
 		uint32_t nbPatches;
 
@@ -387,9 +511,25 @@ static void readSection(
 		    section.name.c_str()
 		);
 
+		if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+			tables.patches = file; // The patches follow the section
+		} else if (nbPatches > tables.nbPatches) {
+			fatal(
+			    "%s: \"%s\" has more patches than the whole file",
+			    fileName,
+			    section.name.c_str()
+			);
+		} else {
+			tables.nbPatches -= nbPatches;
+		}
 		section.patches.resize(nbPatches);
 		for (uint32_t i = 0; i < nbPatches; i++) {
-			readPatch(file, section.patches[i], fileName, section.name, i, fileNodes);
+			readPatch(
+			    tables.patches, section.patches[i], fileName, section.name, i, fileNodes, revNum
+			);
+		}
+		if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+			file = tables.patches; // And the next section follows them
 		}
 	}
 }
@@ -415,76 +555,43 @@ static void linkSymToSect(Symbol &symbol, Section &section) {
 
 // Reads an assertion from a file.
 static void readAssertion(
-    FILE *file,
+    ObjectData &file,
     Assertion &assert,
     char const *fileName,
     uint32_t assertID,
-    std::vector<FileStackNode> const &fileNodes
+    std::vector<FileStackNode> const &fileNodes,
+    uint32_t revNum
 ) {
 	std::string assertName("Assertion #");
 
 	assertName += std::to_string(assertID);
-	readPatch(file, assert.patch, fileName, assertName, 0, fileNodes);
+	readPatch(file, assert.patch, fileName, assertName, 0, fileNodes, revNum);
 	tryReadString(assert.message, file, "%s: Cannot read assertion's message: %s", fileName);
 }
 
-void obj_ReadFile(char const *fileName, unsigned int fileID) {
-	FILE *file;
-	if (strcmp(fileName, "-")) {
-		file = fopen(fileName, "rb");
-	} else {
-		fileName = "<stdin>";
-		(void)setmode(STDIN_FILENO, O_BINARY);
-		file = stdin;
-	}
-	if (!file) {
-		fatal("Failed to open file \"%s\": %s", fileName, strerror(errno));
-	}
-	Defer closeFile{[&] { fclose(file); }};
-
-	// First, check if the object is a RGBDS object or a SDCC one. If the first byte is 'R',
-	// we'll assume it's a RGBDS object file, and otherwise, that it's a SDCC object file.
-	int c = getc(file);
-
-	ungetc(c, file); // Guaranteed to work
-	switch (c) {
-	case EOF:
-		fatal("File \"%s\" is empty!", fileName);
-
-	case 'R':
-		break;
-
-	default:
-		// This is (probably) a SDCC object file, defer the rest of detection to it.
-		// Since SDCC does not provide line info, everything will be reported as coming from the
-		// object file. It's better than nothing.
-		nodes[fileID].push_back({
-		    .type = NODE_FILE,
-		    .data = std::variant<std::monostate, std::vector<uint32_t>, std::string>(fileName),
-		    .parent = nullptr,
-		    .lineNo = 0,
-		});
-
-		std::vector<Symbol> &fileSymbols = symbolLists.emplace_front();
-
-		sdobj_ReadFile(nodes[fileID].back(), file, fileSymbols);
-		return;
-	}
+// Magic bytes of RGBDS object files and archives, which have the same length
+using Magic = char[literal_strlen(RGBDS_OBJECT_VERSION_STRING)];
+static_assert(sizeof(Magic) == literal_strlen(RGBDS_ARCHIVE_VERSION_STRING));
 
-	// Begin by reading the magic bytes
-	int matchedElems;
-
-	if (fscanf(file, RGBDS_OBJECT_VERSION_STRING "%n", &matchedElems) == 1
-	    && matchedElems != literal_strlen(RGBDS_OBJECT_VERSION_STRING)) {
-		fatal("%s: Not a RGBDS object file", fileName);
+static bool readMagic(ObjectData &file, Magic &magic) {
+	if (static_cast<size_t>(file.end - file.ptr) < sizeof(magic)) {
+		return false;
 	}
+	memcpy(magic, file.ptr, sizeof(magic));
+	file.ptr += sizeof(magic);
+	return true;
+}
 
-	verbosePrint("Reading object file %s\n", fileName);
+static bool isMagic(Magic const &magic, char const *expected) {
+	return !memcmp(magic, expected, sizeof(magic));
+}
 
+// Reads an object file's revision number, checking that it is supported.
+static uint32_t readRevision(ObjectData &file, char const *fileName) {
 	uint32_t revNum;
 
 	tryReadLong(revNum, file, "%s: Cannot read revision number: %s", fileName);
-	if (revNum != RGBDS_OBJECT_REV) {
+	if (revNum < RGBDS_OBJECT_REV_INLINE_NAMES || revNum > RGBDS_OBJECT_REV) {
 		fatal(
 		    "%s: Unsupported object file for rgblink %s; try rebuilding \"%s\"%s"
 		    " (expected revision %d, got %d)",
@@ -496,22 +603,131 @@ void obj_ReadFile(char const *fileName, unsigned int fileID) {
 		    revNum
 		);
 	}
+	return revNum;
+}
 
-	uint32_t nbNodes;
-	uint32_t nbSymbols;
-	uint32_t nbSections;
+// Locates the area of a revision 14 object file where section data and RPN expressions are stored.
+static void readBlobs(ObjectData &file, char const *fileName, uint32_t revNum) {
+	if (revNum <= RGBDS_OBJECT_REV_INLINE_DATA) {
+		return;
+	}
 
-	tryReadLong(nbSymbols, file, "%s: Cannot read number of symbols: %s", fileName);
-	tryReadLong(nbSections, file, "%s: Cannot read number of sections: %s", fileName);
+	tryReadLong(file.blobsSize, file, "%s: Cannot read size of data area: %s", fileName);
+	if (static_cast<size_t>(file.end - file.ptr) < file.blobsSize) {
+		fatal("%s: Cannot read data area: Unexpected end of file", fileName);
+	}
+	file.blobs = file.ptr;
+	file.ptr += file.blobsSize;
+}
 
-	nbSectionsToAssign += nbSections;
+// Reads an object file's header, which follows its revision number, to locate its tables.
+static void
+    readHeader(ObjectData &file, ObjectTables &tables, char const *fileName, uint32_t revNum) {
+	if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+		tryReadLong(tables.nbSymbols, file, "%s: Cannot read number of symbols: %s", fileName);
+		tryReadLong(tables.nbSections, file, "%s: Cannot read number of sections: %s", fileName);
+		readBlobs(file, fileName, revNum);
+		tables.nodes = file; // The first table follows the header
+		return;
+	}
+
+	struct {
+		uint32_t &count;
+		ObjectData &table;
+		char const *what;
+		uint32_t offset;
+	} entries[] = {
+	    {tables.nbNodes, tables.nodes, "nodes", 0},
+	    {tables.nbStrings, tables.strings, "strings", 0},
+	    {tables.nbSymbols, tables.symbols, "symbols", 0},
+	    {tables.nbSections, tables.sections, "sections", 0},
+	    {tables.nbPatches, tables.patches, "patches", 0},
+	    {tables.nbAssertions, tables.assertions, "assertions", 0},
+	};
+	size_t size = file.end - file.begin;
+	uint32_t blobsOffset;
+
+	for (auto &[count, table, what, offset] : entries) {
+		tryReadLong(count, file, "%s: Cannot read number of %s: %s", fileName, what);
+		tryReadLong(offset, file, "%s: Cannot read offset of %s: %s", fileName, what);
+	}
+	tryReadLong(file.blobsSize, file, "%s: Cannot read size of data area: %s", fileName);
+	tryReadLong(blobsOffset, file, "%s: Cannot read offset of data area: %s", fileName);
+	if (blobsOffset > size || file.blobsSize > size - blobsOffset) {
+		fatal("%s: Cannot read data area: Unexpected end of file", fileName);
+	}
+	file.blobs = &file.begin[blobsOffset];
+
+	for (auto &[count, table, what, offset] : entries) {
+		if (offset > size) {
+			fatal("%s: Cannot read %s: Unexpected end of file", fileName, what);
+		}
+		table = file;
+		table.ptr = &file.begin[offset];
+	}
+}
+
+// Reads an object file's file stack nodes and string table.
+static void readNodesAndStrings(
+    ObjectTables &tables,
+    std::vector<FileStackNode> &fileNodes,
+    std::vector<ObjectString> &strings,
+    char const *fileName,
+    uint32_t revNum
+) {
+	if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+		tryReadLong(
+		    tables.nbNodes, tables.nodes, "%s: Cannot read number of nodes: %s", fileName
+		);
+	}
+	fileNodes.resize(tables.nbNodes);
+	verbosePrint("Reading %" PRIu32 " nodes...\n", tables.nbNodes);
+	for (uint32_t i = tables.nbNodes; i--;) {
+		readFileStackNode(tables.nodes, fileNodes, i, fileName);
+	}
+	if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+		tables.strings = tables.nodes;
+	}
 
-	tryReadLong(nbNodes, file, "%s: Cannot read number of nodes: %s", fileName);
-	nodes[fileID].resize(nbNodes);
-	verbosePrint("Reading %u nodes...\n", nbNodes);
-	for (uint32_t i = nbNodes; i--;) {
-		readFileStackNode(file, nodes[fileID], i, fileName);
+	if (revNum != RGBDS_OBJECT_REV_INLINE_NAMES) {
+		if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+			tryReadLong(
+			    tables.nbStrings,
+			    tables.strings,
+			    "%s: Cannot read number of strings: %s",
+			    fileName
+			);
+		}
+		verbosePrint("Reading %" PRIu32 " strings...\n", tables.nbStrings);
+		strings.resize(tables.nbStrings);
+		for (uint32_t i = 0; i < tables.nbStrings; i++) {
+			readString(tables.strings, strings[i], fileName, i);
+		}
 	}
+	if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+		tables.symbols = tables.strings;
+	}
+}
+
+// Reads the rest of a RGBDS object file, once its magic bytes have been checked.
+static void readObject(ObjectData &file, char const *fileName, unsigned int fileID) {
+	verbosePrint("Reading object file %s\n", fileName);
+	++linkStats.nbObjects;
+
+	uint32_t revNum = readRevision(file, fileName);
+	ObjectTables tables;
+
+	readHeader(file, tables, fileName, revNum);
+
+	uint32_t nbSymbols = tables.nbSymbols;
+	uint32_t nbSections = tables.nbSections;
+
+	nbSectionsToAssign += nbSections;
+
+	// This file's symbol and section names
+	std::vector<ObjectString> strings;
+
+	readNodesAndStrings(tables, nodes[fileID], strings, fileName, revNum);
 
 	// This file's symbols, kept to link sections to them
 	std::vector<Symbol> &fileSymbols = symbolLists.emplace_front(nbSymbols);
@@ -522,7 +738,7 @@ void obj_ReadFile(char const *fileName, unsigned int fileID) {
 		// Read symbol
 		Symbol &symbol = fileSymbols[i];
 
-		readSymbol(file, symbol, fileName, nodes[fileID]);
+		readSymbol(tables.symbols, symbol, fileName, nodes[fileID], strings, revNum);
 
 		sym_AddSymbol(symbol);
 		if (std::holds_alternative<Label>(symbol.data)) {
@@ -533,24 +749,34 @@ void obj_ReadFile(char const *fileName, unsigned int fileID) {
 	// This file's sections, stored in a table to link symbols to them
 	std::vector<std::unique_ptr<Section>> fileSections(nbSections);
 
+	if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+		tables.sections = tables.symbols;
+	}
+
 	verbosePrint("Reading %" PRIu32 " sections...\n", nbSections);
 	for (uint32_t i = 0; i < nbSections; i++) {
 		// Read section
 		fileSections[i] = std::make_unique<Section>();
 		fileSections[i]->nextu = nullptr;
-		readSection(file, *fileSections[i], fileName, nodes[fileID]);
+		readSection(tables, *fileSections[i], fileName, nodes[fileID], strings, revNum);
 		fileSections[i]->fileSymbols = &fileSymbols;
 		fileSections[i]->symbols.reserve(nbSymPerSect[i]);
 	}
 
-	uint32_t nbAsserts;
-
-	tryReadLong(nbAsserts, file, "%s: Cannot read number of assertions: %s", fileName);
-	verbosePrint("Reading %" PRIu32 " assertions...\n", nbAsserts);
-	for (uint32_t i = 0; i < nbAsserts; i++) {
+	if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+		tables.assertions = tables.sections;
+		tryReadLong(
+		    tables.nbAssertions,
+		    tables.assertions,
+		    "%s: Cannot read number of assertions: %s",
+		    fileName
+		);
+	}
+	verbosePrint("Reading %" PRIu32 " assertions...\n", tables.nbAssertions);
+	for (uint32_t i = 0; i < tables.nbAssertions; i++) {
 		Assertion &assertion = assertions.emplace_front();
 
-		readAssertion(file, assertion, fileName, i, nodes[fileID]);
+		readAssertion(tables.assertions, assertion, fileName, i, nodes[fileID], revNum);
 		linkPatchToPCSect(assertion.patch, fileSections);
 		assertion.fileSymbols = &fileSymbols;
 	}
@@ -592,12 +818,162 @@ void obj_ReadFile(char const *fileName, unsigned int fileID) {
 					label.offset += section->offset;
 				}
 				// Associate the symbol with the main section, not the "component" one
-				label.section = sect_GetSection(section->name);
+				label.section = sect_GetSection(section->nameID);
 			}
 		}
 	}
 }
 
+void obj_ReadFile(char const *fileName, unsigned int fileID) {
+	FILE *file;
+	if (strcmp(fileName, "-")) {
+		file = fopen(fileName, "rb");
+	} else {
+		fileName = "<stdin>";
+		(void)setmode(STDIN_FILENO, O_BINARY);
+		file = stdin;
+	}
+	if (!file) {
+		fatal("Failed to open file \"%s\": %s", fileName, strerror(errno));
+	}
+	Defer closeFile{[&] { fclose(file); }};
+
+	// Object files and archives are read in place
+	std::shared_ptr<char[]> contents;
+	size_t size = 0;
+
+	if (struct stat statBuf; fstat(fileno(file), &statBuf) == 0 && S_ISREG(statBuf.st_mode)
+	                         && statBuf.st_size > 0) {
+		size = statBuf.st_size;
+		contents = mapFile(fileno(file), fileName, size, beVerbose);
+	}
+	if (contents) {
+		verbosePrint("File \"%s\" is mmap()ped\n", fileName); // LCOV_EXCL_LINE
+	} else {
+		// Pipes cannot be mapped, so read them whole instead
+		auto buffer = std::make_shared<std::vector<char>>();
+		char chunk[BUFSIZ];
+
+		for (size_t nbRead; (nbRead = fread(chunk, 1, sizeof(chunk), file)) != 0;) {
+			buffer->insert(buffer->end(), chunk, chunk + nbRead);
+		}
+		if (ferror(file)) {
+			fatal("%s: Cannot read file: %s", fileName, strerror(errno)); // LCOV_EXCL_LINE
+		}
+		size = buffer->size();
+		contents = std::shared_ptr<char[]>(buffer, buffer->data());
+	}
+	fileContents.push_back(contents);
+
+	// First, check if the object is a RGBDS object or a SDCC one. If the first byte is 'R',
+	// we'll assume it's a RGBDS object file, and otherwise, that it's a SDCC object file.
+	if (size == 0) {
+		fatal("File \"%s\" is empty!", fileName);
+	}
+	switch (contents[0]) {
+	case 'R':
+		break;
+
+	default:
+		// This is (probably) a SDCC object file, defer the rest of detection to it.
+		// Since SDCC does not provide line info, everything will be reported as coming from the
+		// object file. It's better than nothing.
+		nodes[fileID].push_back({
+		    .type = NODE_FILE,
+		    .data = std::variant<std::monostate, std::vector<uint32_t>, std::string>(fileName),
+		    .parent = nullptr,
+		    .lineNo = 0,
+		});
+
+		std::vector<Symbol> &fileSymbols = symbolLists.emplace_front();
+
+		sdobj_ReadFile(nodes[fileID].back(), contents.get(), size, fileSymbols);
+		++linkStats.nbObjects;
+		return;
+	}
+
+	uint8_t const *data = reinterpret_cast<uint8_t const *>(contents.get());
+	ObjectData objectData = {
+	    .begin = data, .ptr = data, .end = data + size, .blobs = nullptr, .blobsSize = 0
+	};
+
+	// Begin by reading the magic bytes
+	if (Magic magic; !readMagic(objectData, magic)) {
+		fatal("%s: Not a RGBDS object file", fileName);
+	} else if (isMagic(magic, RGBDS_ARCHIVE_VERSION_STRING)) {
+		ar_ReadArchive(data, size, fileName);
+	} else if (!isMagic(magic, RGBDS_OBJECT_VERSION_STRING)) {
+		fatal("%s: Not a RGBDS object file", fileName);
+	} else {
+		readObject(objectData, fileName, fileID);
+	}
+}
+
+void obj_ReadMember(uint8_t const *data, size_t size, char const *memberName) {
+	ObjectData objectData = {
+	    .begin = data, .ptr = data, .end = data + size, .blobs = nullptr, .blobsSize = 0
+	};
+
+	if (Magic magic;
+	    !readMagic(objectData, magic) || !isMagic(magic, RGBDS_OBJECT_VERSION_STRING)) {
+		fatal("%s: Not a RGBDS object file", memberName);
+	}
+
+	unsigned int fileID = nodes.size();
+	nodes.emplace_back();
+	readObject(objectData, memberName, fileID);
+}
+
+void obj_ReadIndex(
+    uint8_t const *data,
+    size_t size,
+    char const *fileName,
+    void (*onSymbol)(Symbol const &),
+    void (*onSection)(Section const &)
+) {
+	ObjectData file = {
+	    .begin = data, .ptr = data, .end = data + size, .blobs = nullptr, .blobsSize = 0
+	};
+
+	if (Magic magic; !readMagic(file, magic) || !isMagic(magic, RGBDS_OBJECT_VERSION_STRING)) {
+		fatal("%s: Not a RGBDS object file", fileName);
+	}
+
+	uint32_t revNum = readRevision(file, fileName);
+	ObjectTables tables;
+
+	readHeader(file, tables, fileName, revNum);
+
+	std::vector<FileStackNode> fileNodes;
+	std::vector<ObjectString> strings;
+
+	readNodesAndStrings(tables, fileNodes, strings, fileName, revNum);
+	for (uint32_t i = 0; i < tables.nbSymbols; i++) {
+		Symbol symbol;
+
+		readSymbol(tables.symbols, symbol, fileName, fileNodes, strings, revNum);
+		onSymbol(symbol);
+	}
+	if (revNum <= RGBDS_OBJECT_REV_NO_OFFSETS) {
+		tables.sections = tables.symbols;
+	}
+	for (uint32_t i = 0; i < tables.nbSections; i++) {
+		Section section;
+
+		readSection(tables, section, fileName, fileNodes, strings, revNum);
+		onSection(section);
+	}
+}
+
+void obj_ForEachSymbol(void (*callback)(Symbol const &)) {
+	// Files are pushed to the front of `symbolLists` as they are read
+	for (auto it = symbolLists.rbegin(); it != symbolLists.rend(); ++it) {
+		for (Symbol const &symbol : *it) {
+			callback(symbol);
+		}
+	}
+}
+
 void obj_Setup(unsigned int nbFiles) {
 	nodes.resize(nbFiles);
 }
@@ -2,13 +2,19 @@
 
 #include "link/output.hpp"
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <errno.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "diagnostics.hpp"
@@ -16,6 +22,7 @@
 #include "helpers.hpp"
 #include "linkdefs.hpp"
 #include "platform.hpp"
+#include "romheader.hpp"
 #include "util.hpp"
 
 #include "link/main.hpp"
@@ -29,6 +36,7 @@ FILE *outputFile;
 FILE *overlayFile;
 FILE *symFile;
 FILE *mapFile;
+FILE *mapJSONFile;
 
 struct SortedSymbol {
 	Symbol const *sym;
@@ -168,6 +176,91 @@ static uint8_t getNextFillByte() {
 	return padValue;
 }
 
+// When fixing the header, the ROM's first `header_Size()` bytes are held back until its checksums
+// are known, and all the others are summed as they are written. Those go straight to the output
+// file, which is then rewound to write the header; but only regular files can be rewound, so they
+// are buffered instead when writing anywhere else (e.g. to a pipe, even through "/dev/stdout").
+static bool fixingHeader;
+static bool bufferingROM;
+static std::vector<uint8_t> romHeader;
+static std::vector<uint8_t> romBuffer;
+static uint16_t romSum; // Sum of the bytes after the header, modulo 65536
+static size_t romLen;
+
+static void outputBytes(uint8_t const *data, size_t len) {
+	if (!fixingHeader) {
+		fwrite(data, 1, len, outputFile);
+		return;
+	}
+
+	romLen += len;
+	if (size_t headerLen = header_Size(); romHeader.size() < headerLen) {
+		size_t nbHeaderBytes = std::min(len, headerLen - romHeader.size());
+		romHeader.insert(romHeader.end(), data, data + nbHeaderBytes);
+		data += nbHeaderBytes;
+		len -= nbHeaderBytes;
+		if (romHeader.size() == headerLen && !bufferingROM) {
+			// Reserve the header's space; it will be overwritten once fixed
+			fwrite(romHeader.data(), 1, headerLen, outputFile);
+		}
+	}
+
+	romSum += header_SumBytes(data, len);
+	if (bufferingROM) {
+		romBuffer.insert(romBuffer.end(), data, data + len);
+	} else {
+		fwrite(data, 1, len, outputFile);
+	}
+}
+
+static void outputByte(uint8_t byte) {
+	if (!fixingHeader) {
+		putc(byte, outputFile);
+	} else {
+		outputBytes(&byte, 1);
+	}
+}
+
+static void fixHeader() {
+	uint16_t headerLen = header_Size();
+	if (romHeader.size() < headerLen) {
+		fatal(
+		    "Cannot fix the header of \"%s\": expected at least %" PRIu16 " ($%" PRIx16
+		    ") bytes, got only %zu",
+		    outputFileName,
+		    headerLen,
+		    headerLen,
+		    romHeader.size()
+		);
+	}
+
+	header_Overwrite(romHeader.data());
+
+	if (uint16_t fixPadValue = header_PadValue(); fixPadValue != UNSPECIFIED) {
+		uint32_t nbBanks = (romLen + BANK_SIZE - 1) / BANK_SIZE;
+		nbBanks = header_PadROMSize(romHeader.data(), nbBanks);
+		uint8_t bank[BANK_SIZE];
+		memset(bank, fixPadValue, sizeof(bank));
+		for (size_t len = nbBanks * BANK_SIZE - romLen; len;) {
+			size_t thisLen = std::min(len, sizeof(bank));
+			outputBytes(bank, thisLen);
+			len -= thisLen;
+		}
+	}
+
+	header_FixChecksums(romHeader.data(), headerLen, romSum);
+
+	if (bufferingROM) {
+		fwrite(romHeader.data(), 1, headerLen, outputFile);
+		fwrite(romBuffer.data(), 1, romBuffer.size(), outputFile);
+	} else {
+		if (fseek(outputFile, 0, SEEK_SET) != 0) {
+			fatal("Failed to rewind output file \"%s\": %s", outputFileName, strerror(errno));
+		}
+		fwrite(romHeader.data(), 1, headerLen, outputFile);
+	}
+}
+
 static void
     writeBank(std::deque<Section const *> *bankSections, uint16_t baseOffset, uint16_t size) {
 	uint16_t offset = 0;
@@ -177,12 +270,12 @@ static void
 			assume(section->offset == 0);
 			// Output padding up to the next SECTION
 			while (offset + baseOffset < section->org) {
-				putc(getNextFillByte(), outputFile);
+				outputByte(getNextFillByte());
 				offset++;
 			}
 
 			// Output the section itself
-			fwrite(section->data.data(), 1, section->size, outputFile);
+			outputBytes(section->data.data(), section->size);
 			if (overlayFile) {
 				// Skip bytes even with pipes
 				for (uint16_t i = 0; i < section->size; i++) {
@@ -195,7 +288,7 @@ static void
 
 	if (!disablePadding) {
 		while (offset < size) {
-			putc(getNextFillByte(), outputFile);
+			outputByte(getNextFillByte());
 			offset++;
 		}
 	}
@@ -245,6 +338,14 @@ static void writeROM() {
 	}
 
 	if (outputFile) {
+		fixingHeader = header_IsFixing();
+		// Same limit as RGBFIX, checked before writing anything
+		if (fixingHeader && 1 + sections[SECTTYPE_ROMX].size() >= 0x10000) {
+			fatal("\"%s\" has more than 65536 banks", outputFileName);
+		}
+		struct stat statBuf;
+		bufferingROM = fstat(fileno(outputFile), &statBuf) != 0 || !S_ISREG(statBuf.st_mode);
+
 		writeBank(
 		    !sections[SECTTYPE_ROM0].empty() ? &sections[SECTTYPE_ROM0][0].sections : nullptr,
 		    sectionTypeInfo[SECTTYPE_ROM0].startAddr,
@@ -258,14 +359,42 @@ static void writeROM() {
 			    sectionTypeInfo[SECTTYPE_ROMX].size
 			);
 		}
+
+		if (fixingHeader) {
+			fixHeader();
+		}
+	}
+}
+
+// Appends `value` in lowercase hexadecimal, with at least `width` digits (like "%0*x" would)
+static void appendHex(std::string &out, uint32_t value, uint8_t width) {
+	static char const digits[] = "0123456789abcdef";
+	char buf[8];
+	uint8_t len = 0;
+
+	do {
+		buf[len++] = digits[value & 0xF];
+		value >>= 4;
+	} while (value != 0);
+	while (len < width) {
+		buf[len++] = '0';
+	}
+	while (len) {
+		out.push_back(buf[--len]);
 	}
 }
 
-static void writeSymName(std::string const &name, FILE *file) {
+static void appendPlural(std::string &out, uint32_t count) {
+	if (count != 1) {
+		out.push_back('s');
+	}
+}
+
+static void writeSymName(std::string const &name, std::string &out) {
 	for (char const *ptr = name.c_str(); *ptr != '\0';) {
 		// Output legal ASCII characters as-is
 		if (char c = *ptr; continuesIdentifier(c)) {
-			putc(c, file);
+			out.push_back(c);
 			++ptr;
 			continue;
 		}
@@ -287,7 +416,13 @@ static void writeSymName(std::string const &name, FILE *file) {
 			}
 			++ptr;
 		} while (state != UTF8_ACCEPT);
-		fprintf(file, codepoint <= 0xFFFF ? "\\u%04" PRIx32 : "\\U%08" PRIx32, codepoint);
+		if (codepoint <= 0xFFFF) {
+			out += "\\u";
+			appendHex(out, codepoint, 4);
+		} else {
+			out += "\\U";
+			appendHex(out, codepoint, 8);
+		}
 	}
 }
 
@@ -320,7 +455,9 @@ static void forEachSortedSection(SortedSections const &bankSections, F callback)
 	}
 }
 
-static void writeSymBank(SortedSections const &bankSections, SectionType type, uint32_t bank) {
+static void writeSymBank(
+    SortedSections const &bankSections, SectionType type, uint32_t bank, std::string &out
+) {
 	uint32_t nbSymbols = 0;
 
 	forEachSortedSection(bankSections, [&](Section const &sect) {
@@ -361,51 +498,62 @@ static void writeSymBank(SortedSections const &bankSections, SectionType type, u
 	uint32_t symBank = bank + sectionTypeInfo[type].firstBank;
 
 	for (SortedSymbol &sym : symList) {
-		fprintf(symFile, "%02" PRIx32 ":%04" PRIx16 " ", symBank, sym.addr);
-		writeSymName(sym.sym->name, symFile);
-		putc('\n', symFile);
+		appendHex(out, symBank, 2);
+		out.push_back(':');
+		appendHex(out, sym.addr, 4);
+		out.push_back(' ');
+		writeSymName(sym.sym->name, out);
+		out.push_back('\n');
 	}
 }
 
-static void writeEmptySpace(uint16_t begin, uint16_t end) {
+static void writeEmptySpace(uint16_t begin, uint16_t end, std::string &out) {
 	if (begin < end) {
 		uint16_t len = end - begin;
 
-		fprintf(
-		    mapFile,
-		    "\tEMPTY: $%04x-$%04x ($%04" PRIx16 " byte%s)\n",
-		    begin,
-		    end - 1,
-		    len,
-		    len == 1 ? "" : "s"
-		);
+		out += "\tEMPTY: $";
+		appendHex(out, begin, 4);
+		out += "-$";
+		appendHex(out, end - 1, 4);
+		out += " ($";
+		appendHex(out, len, 4);
+		out += " byte";
+		appendPlural(out, len);
+		out += ")\n";
 	}
 }
 
-static void writeSectionName(std::string const &name, FILE *file) {
+static void writeSectionName(std::string const &name, std::string &out) {
 	for (char c : name) {
 		// Escape characters that need escaping
 		switch (c) {
 		case '\n':
-			fputs("\\n", file);
+			out += "\\n";
 			break;
 		case '\r':
-			fputs("\\r", file);
+			out += "\\r";
 			break;
 		case '\t':
-			fputs("\\t", file);
+			out += "\\t";
 			break;
 		case '\\':
 		case '"':
-			putc('\\', file);
+			out.push_back('\\');
 			[[fallthrough]];
 		default:
-			putc(c, file);
+			out.push_back(c);
 			break;
 		}
 	}
 }
 
+static void writeSectionName(std::string const &name, FILE *file) {
+	std::string out;
+
+	writeSectionName(name, out);
+	fputs(out.c_str(), file);
+}
+
 template<typename F>
 uint16_t forEachSection(SortedSections const &sectList, F callback) {
 	uint16_t used = 0;
@@ -424,7 +572,7 @@ uint16_t forEachSection(SortedSections const &sectList, F callback) {
 	return used;
 }
 
-static void writeMapSymbols(Section const *sect) {
+static void writeMapSymbols(Section const *sect, std::string &out) {
 	for (uint16_t org = sect->org; sect; sect = sect->nextu.get()) {
 		for (Symbol *sym : sect->symbols) {
 			// Don't output symbols that begin with an illegal character
@@ -432,61 +580,74 @@ static void writeMapSymbols(Section const *sect) {
 				continue;
 			}
 			// Space matches "\tSECTION: $xxxx ..."
-			fprintf(mapFile, "\t         $%04" PRIx32 " = ", sym->label().offset + org);
-			writeSymName(sym->name, mapFile);
-			putc('\n', mapFile);
+			out += "\t         $";
+			appendHex(out, sym->label().offset + org, 4);
+			out += " = ";
+			writeSymName(sym->name, out);
+			out.push_back('\n');
 		}
 
 		// Announce the following "piece"
 		if (SectionModifier mod = sect->nextu ? sect->nextu->modifier : SECTION_NORMAL;
 		    mod == SECTION_UNION) {
-			fputs("\t         ; Next union\n", mapFile);
+			out += "\t         ; Next union\n";
 		} else if (mod == SECTION_FRAGMENT) {
-			fputs("\t         ; Next fragment\n", mapFile);
+			out += "\t         ; Next fragment\n";
 		}
 	}
 }
 
-static void writeMapBank(SortedSections const &sectList, SectionType type, uint32_t bank) {
-	fprintf(
-	    mapFile,
-	    "\n%s bank #%" PRIu32 ":\n",
-	    sectionTypeInfo[type].name.c_str(),
-	    bank + sectionTypeInfo[type].firstBank
-	);
+static void writeMapBank(
+    SortedSections const &sectList, SectionType type, uint32_t bank, std::string &out
+) {
+	out.push_back('\n');
+	out += sectionTypeInfo[type].name;
+	out += " bank #";
+	out += std::to_string(bank + sectionTypeInfo[type].firstBank);
+	out += ":\n";
 
 	uint16_t prevEndAddr = sectionTypeInfo[type].startAddr;
 	uint16_t used = forEachSection(sectList, [&](Section const &sect) {
 		assume(sect.offset == 0);
 
-		writeEmptySpace(prevEndAddr, sect.org);
+		writeEmptySpace(prevEndAddr, sect.org, out);
 
 		prevEndAddr = sect.org + sect.size;
 
-		fprintf(mapFile, "\tSECTION: $%04" PRIx16, sect.org);
+		out += "\tSECTION: $";
+		appendHex(out, sect.org, 4);
 		if (sect.size != 0) {
-			fprintf(mapFile, "-$%04x", prevEndAddr - 1);
+			out += "-$";
+			appendHex(out, prevEndAddr - 1, 4);
 		}
-		fprintf(mapFile, " ($%04" PRIx16 " byte%s) [\"", sect.size, sect.size == 1 ? "" : "s");
-		writeSectionName(sect.name, mapFile);
-		fputs("\"]\n", mapFile);
+		out += " ($";
+		appendHex(out, sect.size, 4);
+		out += " byte";
+		appendPlural(out, sect.size);
+		out += ") [\"";
+		writeSectionName(sect.name, out);
+		out += "\"]\n";
 
 		if (!noSymInMap) {
 			// Also print symbols in the following "pieces"
-			writeMapSymbols(&sect);
+			writeMapSymbols(&sect, out);
 		}
 	});
 
 	if (used == 0) {
-		fputs("\tEMPTY\n", mapFile);
+		out += "\tEMPTY\n";
 	} else {
 		uint16_t bankEndAddr = sectionTypeInfo[type].startAddr + sectionTypeInfo[type].size;
 
-		writeEmptySpace(prevEndAddr, bankEndAddr);
+		writeEmptySpace(prevEndAddr, bankEndAddr, out);
 
 		uint16_t slack = sectionTypeInfo[type].size - used;
 
-		fprintf(mapFile, "\tTOTAL EMPTY: $%04" PRIx16 " byte%s\n", slack, slack == 1 ? "" : "s");
+		out += "\tTOTAL EMPTY: $";
+		appendHex(out, slack, 4);
+		out += " byte";
+		appendPlural(out, slack);
+		out += "\n";
 	}
 }
 
@@ -528,6 +689,120 @@ static void writeMapSummary() {
 	}
 }
 
+static void writeMapRemoved() {
+	static bool hasFolded; // `static` so `sect_ForEachRemoved` callbacks can see it
+	hasFolded = false;
+	sect_ForEachRemoved([](Section const &sect) {
+		if (!sect.foldedInto) {
+			return;
+		}
+		if (!hasFolded) {
+			fputs("\nFOLDED:\n", mapFile);
+			hasFolded = true;
+		}
+		fprintf(
+		    mapFile,
+		    "\tSECTION: %s ($%04" PRIx16 " byte%s) [\"",
+		    sectionTypeInfo[sect.type].name.c_str(),
+		    sect.size,
+		    sect.size == 1 ? "" : "s"
+		);
+		writeSectionName(sect.name, mapFile);
+		fputs("\"] = [\"", mapFile);
+		writeSectionName(sect.foldedInto->name, mapFile);
+		fputs("\"]\n", mapFile);
+	});
+
+	static bool hasRemoved;
+	hasRemoved = false;
+	sect_ForEachRemoved([](Section const &sect) {
+		if (sect.foldedInto) {
+			return;
+		}
+		if (!hasRemoved) {
+			fputs("\nREMOVED:\n", mapFile);
+			hasRemoved = true;
+		}
+		fprintf(
+		    mapFile,
+		    "\tSECTION: %s ($%04" PRIx16 " byte%s) [\"",
+		    sectionTypeInfo[sect.type].name.c_str(),
+		    sect.size,
+		    sect.size == 1 ? "" : "s"
+		);
+		writeSectionName(sect.name, mapFile);
+		fputs("\"]\n", mapFile);
+	});
+}
+
+struct Bank {
+	SectionType type;
+	uint32_t bank;
+};
+
+// Lists all banks, in the order in which they are output to the sym and map files
+static std::vector<Bank> getBanks() {
+	std::vector<Bank> banks;
+
+	for (uint8_t i = 0; i < SECTTYPE_INVALID; i++) {
+		SectionType type = typeMap[i];
+
+		for (uint32_t bank = 0; bank < sections[type].size(); bank++) {
+			banks.push_back({.type = type, .bank = bank});
+		}
+	}
+	return banks;
+}
+
+// Formats each bank into its own buffer, spreading the banks across threads. This only reads
+// the sections and symbols, so the threads do not need to synchronize beyond picking banks.
+template<typename F>
+static std::vector<std::string> formatBanks(std::vector<Bank> const &banks, F format) {
+	std::vector<std::string> buffers(banks.size());
+	std::atomic<size_t> nextBank = 0;
+	auto formatNextBanks = [&] {
+		for (size_t i; (i = nextBank++) < banks.size();) {
+			auto [type, bank] = banks[i];
+			format(sections[type][bank], type, bank, buffers[i]);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < std::min<size_t>(std::thread::hardware_concurrency(), banks.size());
+	     i++) {
+		threads.emplace_back(formatNextBanks);
+	}
+	formatNextBanks();
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	return buffers;
+}
+
+static void writeBuffers(std::vector<std::string> const &buffers, FILE *file) {
+	for (std::string const &buffer : buffers) {
+		fwrite(buffer.data(), 1, buffer.size(), file);
+	}
+}
+
+// Lists the exported numeric constants, ordered by value, then by name
+static std::vector<Symbol *> const &getSortedConstants() {
+	static std::vector<Symbol *> constants; // `static` so `sym_ForEach` callback can see it
+	if (constants.empty()) {
+		sym_ForEach([](Symbol &sym) {
+			// Symbols are already limited to the exported ones
+			if (std::holds_alternative<int32_t>(sym.data)) {
+				constants.push_back(&sym);
+			}
+		});
+		std::sort(RANGE(constants), [](Symbol *sym1, Symbol *sym2) -> bool {
+			return std::tie(std::get<int32_t>(sym1->data), sym1->name)
+			       < std::tie(std::get<int32_t>(sym2->data), sym2->name);
+		});
+	}
+	return constants;
+}
+
 static void writeSym() {
 	if (!symFileName) {
 		return;
@@ -547,35 +822,18 @@ static void writeSym() {
 
 	fputs("; File generated by rgblink\n", symFile);
 
-	for (uint8_t i = 0; i < SECTTYPE_INVALID; i++) {
-		SectionType type = typeMap[i];
-
-		for (uint32_t bank = 0; bank < sections[type].size(); bank++) {
-			writeSymBank(sections[type][bank], type, bank);
-		}
-	}
+	writeBuffers(formatBanks(getBanks(), writeSymBank), symFile);
 
 	// Output the exported numeric constants
-	static std::vector<Symbol *> constants; // `static` so `sym_ForEach` callback can see it
-	constants.clear();
-	sym_ForEach([](Symbol &sym) {
-		// Symbols are already limited to the exported ones
-		if (std::holds_alternative<int32_t>(sym.data)) {
-			constants.push_back(&sym);
-		}
-	});
-	// Numeric constants are ordered by value, then by name
-	std::sort(RANGE(constants), [](Symbol *sym1, Symbol *sym2) -> bool {
-		return std::tie(std::get<int32_t>(sym1->data), sym1->name)
-		       < std::tie(std::get<int32_t>(sym2->data), sym2->name);
-	});
-	for (Symbol *sym : constants) {
+	std::string out;
+	for (Symbol *sym : getSortedConstants()) {
 		int32_t val = std::get<int32_t>(sym->data);
-		int width = val < 0x100 ? 2 : val < 0x10000 ? 4 : 8;
-		fprintf(symFile, "%0*" PRIx32 " ", width, val);
-		writeSymName(sym->name, symFile);
-		putc('\n', symFile);
+		appendHex(out, val, val < 0x100 ? 2 : val < 0x10000 ? 4 : 8);
+		out.push_back(' ');
+		writeSymName(sym->name, out);
+		out.push_back('\n');
 	}
+	fwrite(out.data(), 1, out.size(), symFile);
 }
 
 static void writeMap() {
@@ -597,17 +855,239 @@ static void writeMap() {
 
 	writeMapSummary();
 
-	for (uint8_t i = 0; i < SECTTYPE_INVALID; i++) {
-		SectionType type = typeMap[i];
+	writeBuffers(formatBanks(getBanks(), writeMapBank), mapFile);
 
-		for (uint32_t bank = 0; bank < sections[type].size(); bank++) {
-			writeMapBank(sections[type][bank], type, bank);
+	writeMapRemoved();
+}
+
+// Appends the UTF-8 sequence starting at `str[i]`, or U+FFFD if it is invalid, since JSON must
+// be valid UTF-8. Returns the index of the sequence's last byte.
+static size_t appendJSONCodepoint(std::string const &str, size_t i, std::string &out) {
+	uint32_t state = UTF8_ACCEPT, codepoint;
+	size_t end = i;
+	do {
+		decode(&state, &codepoint, static_cast<uint8_t>(str[end++]));
+	} while (state != UTF8_ACCEPT && state != UTF8_REJECT && end < str.size());
+
+	if (state == UTF8_ACCEPT) {
+		out.append(str, i, end - i);
+		return end - 1;
+	}
+	out += "\\ufffd";
+	// Skip the sequence's first byte and its continuation bytes; the byte that made it invalid
+	// may start the next one
+	while (i + 1 < str.size() && (str[i + 1] & 0xC0) == 0x80) {
+		++i;
+	}
+	return i;
+}
+
+static void appendJSONString(std::string const &str, std::string &out) {
+	out.push_back('"');
+	for (size_t i = 0; i < str.size(); ++i) {
+		switch (char c = str[i]; c) {
+		case '"':
+		case '\\':
+			out.push_back('\\');
+			out.push_back(c);
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				out += "\\u";
+				appendHex(out, static_cast<unsigned char>(c), 4);
+			} else if (static_cast<unsigned char>(c) >= 0x80) {
+				i = appendJSONCodepoint(str, i, out);
+			} else {
+				out.push_back(c);
+			}
+			break;
 		}
 	}
+	out.push_back('"');
+}
+
+// Appends `"file": ..., "line": ...` for where something was defined
+static void appendJSONSource(FileStackNode const *src, int32_t lineNo, std::string &out) {
+	// REPT nodes have no name of their own, but their line numbers are in their parent file
+	while (src && std::holds_alternative<std::vector<uint32_t>>(src->data)) {
+		src = src->parent;
+	}
+	out += "\"file\": ";
+	if (src) {
+		appendJSONString(src->name(), out);
+	} else {
+		out += "null";
+	}
+	out += ", \"line\": ";
+	out += std::to_string(lineNo);
+}
+
+static void appendJSONSection(Section const &sect, std::string &out) {
+	static char const * const modifierNames[] = {"normal", "union", "fragment"};
+
+	out += "\n\t\t\t\t{\"name\": ";
+	appendJSONString(sect.name, out);
+	out += ", \"start\": ";
+	out += std::to_string(sect.org);
+	out += ", \"size\": ";
+	out += std::to_string(sect.size);
+	out += ", \"modifier\": \"";
+	out += modifierNames[sect.modifier];
+	out += "\", \"components\": [";
+	for (Section const *component = &sect; component; component = component->nextu.get()) {
+		out += component == &sect ? "\n" : ",\n";
+		out += "\t\t\t\t\t{\"offset\": ";
+		out += std::to_string(component->offset);
+		out += ", ";
+		appendJSONSource(component->src, component->lineNo, out);
+		out += ", \"symbols\": [";
+		for (size_t i = 0; i < component->symbols.size(); ++i) {
+			Symbol const &sym = *component->symbols[i];
+
+			out += i ? ",\n" : "\n";
+			out += "\t\t\t\t\t\t{\"name\": ";
+			appendJSONString(sym.name, out);
+			out += ", \"address\": ";
+			// Fragments' labels are already relative to the whole section
+			out += std::to_string(sym.label().offset + sect.org);
+			out += ", \"exported\": ";
+			out += sym.type == SYMTYPE_EXPORT ? "true" : "false";
+			out += ", ";
+			appendJSONSource(sym.src, sym.lineNo, out);
+			out += "}";
+		}
+		out += component->symbols.empty() ? "]}" : "\n\t\t\t\t\t]}";
+	}
+	out += "\n\t\t\t\t]}";
+}
+
+static void writeMapJSONBank(
+    SortedSections const &sectList, SectionType type, uint32_t bank, std::string &out
+) {
+	SectionTypeInfo const &typeInfo = sectionTypeInfo[type];
+	std::string freeSpace;
+	uint16_t prevEndAddr = typeInfo.startAddr;
+	bool isFirst = true;
+	auto addFreeSpace = [&](uint16_t begin, uint16_t end) {
+		if (begin < end) {
+			freeSpace += freeSpace.empty() ? "\n" : ",\n";
+			freeSpace += "\t\t\t\t{\"start\": ";
+			freeSpace += std::to_string(begin);
+			freeSpace += ", \"size\": ";
+			freeSpace += std::to_string(end - begin);
+			freeSpace += "}";
+		}
+	};
+
+	out += "\t\t{\"type\": \"";
+	out += typeInfo.name;
+	out += "\", \"bank\": ";
+	out += std::to_string(bank + typeInfo.firstBank);
+	out += ", \"start\": ";
+	out += std::to_string(typeInfo.startAddr);
+	out += ", \"size\": ";
+	out += std::to_string(typeInfo.size);
+	out += ",\n\t\t\t\"sections\": [";
+	uint16_t used = forEachSection(sectList, [&](Section const &sect) {
+		addFreeSpace(prevEndAddr, sect.org);
+		prevEndAddr = sect.org + sect.size;
+
+		if (!isFirst) {
+			out.push_back(',');
+		}
+		isFirst = false;
+		appendJSONSection(sect, out);
+	});
+	addFreeSpace(prevEndAddr, typeInfo.startAddr + typeInfo.size);
+	out += isFirst ? "]" : "\n\t\t\t]";
+	out += ",\n\t\t\t\"used\": ";
+	out += std::to_string(used);
+	out += ",\n\t\t\t\"free\": [";
+	out += freeSpace;
+	out += freeSpace.empty() ? "]" : "\n\t\t\t]";
+	out += "}";
+}
+
+static void writeMapJSON() {
+	if (!mapJSONFileName) {
+		return;
+	}
+
+	if (strcmp(mapJSONFileName, "-")) {
+		mapJSONFile = fopen(mapJSONFileName, "w");
+	} else {
+		mapJSONFileName = "<stdout>";
+		(void)setmode(STDOUT_FILENO, O_TEXT); // May have been set to O_BINARY previously
+		mapJSONFile = stdout;
+	}
+	if (!mapJSONFile) {
+		fatal("Failed to open JSON map file \"%s\": %s", mapJSONFileName, strerror(errno));
+	}
+	Defer closeMapJSONFile{[&] { fclose(mapJSONFile); }};
+
+	fputs("{\n\t\"banks\": [\n", mapJSONFile);
+	std::vector<std::string> buffers = formatBanks(getBanks(), writeMapJSONBank);
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		if (i) {
+			fputs(",\n", mapJSONFile);
+		}
+		fwrite(buffers[i].data(), 1, buffers[i].size(), mapJSONFile);
+	}
+
+	std::string out = buffers.empty() ? "],\n\t\"constants\": [" : "\n\t],\n\t\"constants\": [";
+	std::vector<Symbol *> const &constants = getSortedConstants();
+	for (size_t i = 0; i < constants.size(); ++i) {
+		out += i ? ",\n" : "\n";
+		out += "\t\t{\"name\": ";
+		appendJSONString(constants[i]->name, out);
+		out += ", \"value\": ";
+		out += std::to_string(std::get<int32_t>(constants[i]->data));
+		out += ", ";
+		appendJSONSource(constants[i]->src, constants[i]->lineNo, out);
+		out += "}";
+	}
+	out += constants.empty() ? "],\n" : "\n\t],\n";
+	fwrite(out.data(), 1, out.size(), mapJSONFile);
+
+	fputs("\t\"removed\": [", mapJSONFile);
+	static bool hasRemoved; // `static` so `sect_ForEachRemoved` callbacks can see it
+	hasRemoved = false;
+	sect_ForEachRemoved([](Section const &sect) {
+		std::string removed = hasRemoved ? ",\n" : "\n";
+
+		removed += "\t\t{\"name\": ";
+		appendJSONString(sect.name, removed);
+		removed += ", \"type\": \"";
+		removed += sectionTypeInfo[sect.type].name;
+		removed += "\", \"size\": ";
+		removed += std::to_string(sect.size);
+		removed += ", \"folded_into\": ";
+		if (sect.foldedInto) {
+			appendJSONString(sect.foldedInto->name, removed);
+		} else {
+			removed += "null";
+		}
+		removed += ", ";
+		appendJSONSource(sect.src, sect.lineNo, removed);
+		removed += "}";
+		fwrite(removed.data(), 1, removed.size(), mapJSONFile);
+		hasRemoved = true;
+	});
+	fputs(hasRemoved ? "\n\t]\n}\n" : "]\n}\n", mapJSONFile);
 }
 
 void out_WriteFiles() {
 	writeROM();
 	writeSym();
 	writeMap();
+	writeMapJSON();
 }
@@ -13,6 +13,7 @@
 
 #include "link/main.hpp"
 #include "link/section.hpp"
+#include "link/stats.hpp"
 #include "link/symbol.hpp"
 #include "link/warning.hpp"
 
@@ -80,7 +81,7 @@ static Symbol const *getSymbol(std::vector<Symbol> const &symbolList, uint32_t i
 
 	// If the symbol is defined elsewhere...
 	if (symbol.type == SYMTYPE_IMPORT) {
-		return sym_GetSymbol(symbol.name);
+		return sym_GetSymbol(symbol.nameID);
 	}
 
 	return &symbol;
@@ -91,6 +92,7 @@ static int32_t computeRPNExpr(Patch const &patch, std::vector<Symbol> const &fil
 	uint8_t const *expression = patch.rpnExpression.data();
 	int32_t size = static_cast<int32_t>(patch.rpnExpression.size());
 
+	linkStats.nbRPNBytes += size;
 	rpnStack.clear();
 
 	while (size > 0) {
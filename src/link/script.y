@@ -28,6 +28,7 @@
 	#include "itertools.hpp"
 	#include "util.hpp"
 
+	#include "link/archive.hpp"
 	#include "link/main.hpp"
 	#include "link/section.hpp"
 	#include "link/warning.hpp"
@@ -703,6 +704,8 @@ static void placeSection(std::string const &name, bool isOptional) {
 		return;
 	}
 
+	// The section, or some of its pieces, may only be defined by archive members
+	ar_LoadSectionMembers(name);
 	Section *section = sect_GetSection(name.c_str());
 	if (!section) {
 		if (!isOptional) {
@@ -749,6 +752,8 @@ static void placeSection(std::string const &name, bool isOptional) {
 		);
 	}
 
+	section->isKept = true;
+
 	if (activeBankIdx == UINT32_MAX) {
 		section->isBankFixed = false;
 	} else {
@@ -2,12 +2,14 @@
 
 #include "link/sdas_obj.hpp"
 
-#include <ctype.h>
+#include <array>
+#include <deque>
 #include <inttypes.h>
 #include <memory>
 #include <stdint.h>
 #include <string.h>
 #include <tuple>
+#include <vector>
 
 #include "helpers.hpp" // assume, literal_strlen
 #include "linkdefs.hpp"
@@ -15,6 +17,7 @@
 
 #include "link/assign.hpp"
 #include "link/main.hpp"
+#include "link/names.hpp"
 #include "link/section.hpp"
 #include "link/symbol.hpp"
 #include "link/warning.hpp"
@@ -30,70 +33,77 @@ struct Location {
 	uint32_t lineNo;
 };
 
-static void consumeLF(Location const &where, FILE *file) {
-	if (getc(file) != '\n') {
-		fatalAt(where, "Bad line ending (CR without LF)");
-	}
-}
-
 static char const *delim = " \f\n\r\t\v"; // Whitespace according to the C and POSIX locales
 
-static int nextLine(std::vector<char> &lineBuf, Location &where, FILE *file) {
-	int firstChar;
+// RPN expressions generated for relocations, which patches refer to
+static std::deque<std::vector<uint8_t>> rpnExpressions;
+
+// The part of the file that remains to be read
+struct FileContents {
+	char const *ptr;
+	char const *end;
+};
+
+static int nextLine(std::vector<char> &lineBuf, Location &where, FileContents &file) {
 	for (;;) {
 		++where.lineNo;
-		firstChar = getc(file);
-		lineBuf.clear();
-
-		switch (firstChar) {
-		case EOF:
+		if (file.ptr == file.end) {
 			return EOF;
-		case ';':
-			// Discard comment line
-			// TODO: if `;!FILE [...]` on the first line (`where.lineNo`), return it
-			do {
-				firstChar = getc(file);
-			} while (firstChar != EOF && firstChar != '\r' && firstChar != '\n');
-			[[fallthrough]];
-		case '\r':
-			if (firstChar == '\r' && getc(file) != '\n') {
-				consumeLF(where, file);
+		}
+
+		// Lines are split in bulk, instead of scanning them character by character
+		char const *lineStart = file.ptr;
+		char const *lineEnd =
+		    static_cast<char const *>(memchr(lineStart, '\n', file.end - lineStart));
+
+		if (lineEnd) {
+			file.ptr = lineEnd + 1;
+		} else {
+			lineEnd = file.ptr = file.end;
+		}
+		char const *cr = static_cast<char const *>(memchr(lineStart, '\r', lineEnd - lineStart));
+		if (cr) {
+			if (cr + 1 != lineEnd || lineEnd == file.end) {
+				fatalAt(where, "Bad line ending (CR without LF)");
 			}
-			[[fallthrough]];
-		case '\n':
-			continue;
+			lineEnd = cr;
 		}
-		break;
-	}
 
-	for (;;) {
-		int c = getc(file);
-
-		switch (c) {
-		case '\r':
-			consumeLF(where, file);
-			[[fallthrough]];
-		case '\n':
-		case EOF:
-			lineBuf.push_back('\0'); // Terminate the string (space was ensured above)
-			return firstChar;
+		// Discard empty lines and comment lines
+		// TODO: if `;!FILE [...]` on the first line (`where.lineNo`), return it
+		if (lineStart == lineEnd || *lineStart == ';') {
+			continue;
 		}
-		lineBuf.push_back(c);
+
+		lineBuf.assign(lineStart + 1, lineEnd);
+		lineBuf.push_back('\0'); // Terminate the string
+		return static_cast<unsigned char>(*lineStart);
 	}
 }
 
+// Value of each digit character, or `UINT8_MAX` for characters that are not digits
+static constexpr std::array<uint8_t, 256> digitValues = [] {
+	std::array<uint8_t, 256> values;
+
+	values.fill(UINT8_MAX);
+	for (uint8_t i = 0; i < 10; ++i) {
+		values['0' + i] = i;
+	}
+	for (uint8_t i = 0; i < 6; ++i) {
+		values['A' + i] = 10 + i;
+		values['a' + i] = 10 + i;
+	}
+	return values;
+}();
+
 static uint32_t readNumber(char const *str, char const *&endptr, NumberType base) {
-	for (uint32_t res = 0;;) {
-		static char const *digits = "0123456789ABCDEF";
-		char const *ptr = strchr(digits, toupper(*str));
+	uint32_t res = 0;
 
-		if (!ptr || ptr - digits >= base) {
-			endptr = str;
-			return res;
-		}
-		++str;
-		res = res * base + (ptr - digits);
+	for (uint8_t digit; (digit = digitValues[static_cast<unsigned char>(*str)]) < base; ++str) {
+		res = res * base + digit;
 	}
+	endptr = str;
+	return res;
 }
 
 static uint32_t parseNumber(Location const &where, char const *str, NumberType base) {
@@ -144,8 +154,11 @@ enum RelocFlags {
 	                  | 1 << RELOC_WHICHBYTE | 1 << RELOC_EXPR24 | 1 << RELOC_BANKBYTE,
 };
 
-void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &fileSymbols) {
+void sdobj_ReadFile(
+    FileStackNode const &src, char const *contents, size_t size, std::vector<Symbol> &fileSymbols
+) {
 	Location where{.src = &src, .lineNo = 0};
+	FileContents file = {.ptr = contents, .end = contents + size};
 
 	std::vector<char> line;
 	line.reserve(256);
@@ -318,6 +331,7 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 				curSection->name.append(" ");
 			}
 			curSection->name.append(sectName);
+			curSection->nameID = name_Intern(curSection->name, hashName(curSection->name));
 
 			expectToken("addr", 'A');
 
@@ -376,6 +390,8 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 
 			getToken(line.data(), "'S' line is too short");
 			symbol.name = token;
+			// All symbols are either imported or exported, so they will be looked up
+			symbol.nameID = name_Intern(symbol.name, hashName(symbol.name));
 
 			getToken(nullptr, "'S' line is too short");
 
@@ -403,7 +419,7 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 			} else {
 				// All symbols are exported
 				symbol.type = SYMTYPE_EXPORT;
-				Symbol const *other = sym_GetSymbol(symbol.name);
+				Symbol const *other = sym_GetSymbol(symbol.nameID);
 
 				if (other) {
 					// The same symbol can only be defined twice if neither
@@ -586,6 +602,7 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 
 				// Turn this into a Patch
 				Patch &patch = section->patches.emplace_back();
+				std::vector<uint8_t> &rpnExpression = rpnExpressions.emplace_back();
 
 				patch.src = where.src;
 				patch.lineNo = where.lineNo;
@@ -654,35 +671,35 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 							    &sym.name.c_str()[1]
 							);
 						}
-						patch.rpnExpression.resize(5);
-						patch.rpnExpression[0] = RPN_BANK_SYM;
-						patch.rpnExpression[1] = idx;
-						patch.rpnExpression[2] = idx >> 8;
-						patch.rpnExpression[3] = idx >> 16;
-						patch.rpnExpression[4] = idx >> 24;
+						rpnExpression.resize(5);
+						rpnExpression[0] = RPN_BANK_SYM;
+						rpnExpression[1] = idx;
+						rpnExpression[2] = idx >> 8;
+						rpnExpression[3] = idx >> 16;
+						rpnExpression[4] = idx >> 24;
 					} else if (sym.name.starts_with("l_")) {
-						patch.rpnExpression.resize(1 + sym.name.length() - 2 + 1);
-						patch.rpnExpression[0] = RPN_SIZEOF_SECT;
+						rpnExpression.resize(1 + sym.name.length() - 2 + 1);
+						rpnExpression[0] = RPN_SIZEOF_SECT;
 						memcpy(
-						    reinterpret_cast<char *>(&patch.rpnExpression[1]),
+						    reinterpret_cast<char *>(&rpnExpression[1]),
 						    &sym.name.c_str()[2],
 						    sym.name.length() - 2 + 1
 						);
 					} else if (sym.name.starts_with("s_")) {
-						patch.rpnExpression.resize(1 + sym.name.length() - 2 + 1);
-						patch.rpnExpression[0] = RPN_STARTOF_SECT;
+						rpnExpression.resize(1 + sym.name.length() - 2 + 1);
+						rpnExpression[0] = RPN_STARTOF_SECT;
 						memcpy(
-						    reinterpret_cast<char *>(&patch.rpnExpression[1]),
+						    reinterpret_cast<char *>(&rpnExpression[1]),
 						    &sym.name.c_str()[2],
 						    sym.name.length() - 2 + 1
 						);
 					} else {
-						patch.rpnExpression.resize(5);
-						patch.rpnExpression[0] = RPN_SYM;
-						patch.rpnExpression[1] = idx;
-						patch.rpnExpression[2] = idx >> 8;
-						patch.rpnExpression[3] = idx >> 16;
-						patch.rpnExpression[4] = idx >> 24;
+						rpnExpression.resize(5);
+						rpnExpression[0] = RPN_SYM;
+						rpnExpression[1] = idx;
+						rpnExpression[2] = idx >> 8;
+						rpnExpression[3] = idx >> 16;
+						rpnExpression[4] = idx >> 24;
 					}
 				} else {
 					if (idx >= fileSections.size()) {
@@ -703,8 +720,9 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 					if (fileSections[idx].section->isAddressFixed) {
 						baseValue -= fileSections[idx].section->org;
 					}
-					std::string const &name = fileSections[idx].section->name;
-					Section const *other = sect_GetSection(name);
+					Section const &fileSection = *fileSections[idx].section;
+					std::string const &name = fileSection.name;
+					Section const *other = sect_GetSection(fileSection.nameID);
 
 					// Unlike with `s_<AREA>`, referencing an area in this way
 					// wants the beginning of this fragment, so we must add the
@@ -717,22 +735,22 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 					if (other) {
 						baseValue += other->size;
 					}
-					patch.rpnExpression.resize(1 + name.length() + 1);
-					patch.rpnExpression[0] = RPN_STARTOF_SECT;
+					rpnExpression.resize(1 + name.length() + 1);
+					rpnExpression[0] = RPN_STARTOF_SECT;
 					// The cast is fine, it's just different signedness
 					memcpy(
-					    reinterpret_cast<char *>(&patch.rpnExpression[1]),
+					    reinterpret_cast<char *>(&rpnExpression[1]),
 					    name.c_str(),
 					    name.length() + 1
 					);
 				}
 
-				patch.rpnExpression.push_back(RPN_CONST);
-				patch.rpnExpression.push_back(baseValue);
-				patch.rpnExpression.push_back(baseValue >> 8);
-				patch.rpnExpression.push_back(baseValue >> 16);
-				patch.rpnExpression.push_back(baseValue >> 24);
-				patch.rpnExpression.push_back(RPN_ADD);
+				rpnExpression.push_back(RPN_CONST);
+				rpnExpression.push_back(baseValue);
+				rpnExpression.push_back(baseValue >> 8);
+				rpnExpression.push_back(baseValue >> 16);
+				rpnExpression.push_back(baseValue >> 24);
+				rpnExpression.push_back(RPN_ADD);
 
 				if (patch.type == PATCHTYPE_BYTE) {
 					// Despite the flag's name, as soon as it is set, 3 bytes
@@ -761,31 +779,31 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 						patch.type = PATCHTYPE_JR;
 						// TODO: check the other flags?
 					} else if (flags & 1 << RELOC_EXPR24 && flags & 1 << RELOC_BANKBYTE) {
-						patch.rpnExpression.push_back(RPN_CONST);
-						patch.rpnExpression.push_back(16);
-						patch.rpnExpression.push_back(16 >> 8);
-						patch.rpnExpression.push_back(16 >> 16);
-						patch.rpnExpression.push_back(16 >> 24);
-						patch.rpnExpression.push_back(
+						rpnExpression.push_back(RPN_CONST);
+						rpnExpression.push_back(16);
+						rpnExpression.push_back(16 >> 8);
+						rpnExpression.push_back(16 >> 16);
+						rpnExpression.push_back(16 >> 24);
+						rpnExpression.push_back(
 						    (flags & 1 << RELOC_SIGNED) ? RPN_SHR : RPN_USHR
 						);
 					} else {
 						if (flags & 1 << RELOC_EXPR16 && flags & 1 << RELOC_WHICHBYTE) {
-							patch.rpnExpression.push_back(RPN_CONST);
-							patch.rpnExpression.push_back(8);
-							patch.rpnExpression.push_back(8 >> 8);
-							patch.rpnExpression.push_back(8 >> 16);
-							patch.rpnExpression.push_back(8 >> 24);
-							patch.rpnExpression.push_back(
+							rpnExpression.push_back(RPN_CONST);
+							rpnExpression.push_back(8);
+							rpnExpression.push_back(8 >> 8);
+							rpnExpression.push_back(8 >> 16);
+							rpnExpression.push_back(8 >> 24);
+							rpnExpression.push_back(
 							    (flags & 1 << RELOC_SIGNED) ? RPN_SHR : RPN_USHR
 							);
 						}
-						patch.rpnExpression.push_back(RPN_CONST);
-						patch.rpnExpression.push_back(0xFF);
-						patch.rpnExpression.push_back(0xFF >> 8);
-						patch.rpnExpression.push_back(0xFF >> 16);
-						patch.rpnExpression.push_back(0xFF >> 24);
-						patch.rpnExpression.push_back(RPN_AND);
+						rpnExpression.push_back(RPN_CONST);
+						rpnExpression.push_back(0xFF);
+						rpnExpression.push_back(0xFF >> 8);
+						rpnExpression.push_back(0xFF >> 16);
+						rpnExpression.push_back(0xFF >> 24);
+						rpnExpression.push_back(RPN_AND);
 					}
 				} else if (flags & 1 << RELOC_ISPCREL) {
 					assume(patch.type == PATCHTYPE_WORD);
@@ -797,6 +815,8 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 					    flags & (1 << RELOC_EXPR16 | 1 << RELOC_EXPR24)
 					);
 				}
+
+				patch.rpnExpression = rpnExpression;
 			}
 
 			// If there is some data left to append, do so
@@ -910,7 +930,7 @@ void sdobj_ReadFile(FileStackNode const &src, FILE *file, std::vector<Symbol> &f
 					label.offset += section->offset;
 				}
 				// Associate the symbol with the main section, not the "component" one
-				label.section = sect_GetSection(section->name);
+				label.section = sect_GetSection(section->nameID);
 			}
 		}
 	}
@@ -10,10 +10,12 @@
 #include "diagnostics.hpp"
 #include "helpers.hpp"
 
+#include "link/names.hpp"
 #include "link/warning.hpp"
 
 std::vector<std::unique_ptr<Section>> sectionList;
-std::unordered_map<std::string, size_t> sectionMap; // Indexes into `sectionList`
+std::unordered_map<uint32_t, size_t> sectionMap; // Indexes into `sectionList` by name ID
+static std::vector<std::unique_ptr<Section>> removedSections;
 
 void sect_ForEach(void (*callback)(Section &)) {
 	for (std::unique_ptr<Section> &ptr : sectionList) {
@@ -21,6 +23,39 @@ void sect_ForEach(void (*callback)(Section &)) {
 	}
 }
 
+size_t sect_RemoveSections(bool (*isRemoved)(Section const &)) {
+	size_t nbRemoved = removedSections.size();
+	size_t nbKept = 0;
+
+	sectionMap.clear();
+	for (size_t i = 0; i < sectionList.size(); i++) {
+		if (isRemoved(*sectionList[i])) {
+			// Symbols may still point to the removed section, so keep it alive
+			removedSections.push_back(std::move(sectionList[i]));
+		} else {
+			if (nbKept != i) {
+				sectionList[nbKept] = std::move(sectionList[i]);
+			}
+			sectionMap.emplace(sectionList[nbKept]->nameID, nbKept);
+			nbKept++;
+		}
+	}
+	sectionList.resize(nbKept);
+	// Folded sections can still be referred to by name, as the section they were folded into
+	for (std::unique_ptr<Section> const &ptr : removedSections) {
+		if (ptr->foldedInto) {
+			sectionMap.emplace(ptr->nameID, sectionMap.at(ptr->foldedInto->nameID));
+		}
+	}
+	return removedSections.size() - nbRemoved;
+}
+
+void sect_ForEachRemoved(void (*callback)(Section const &)) {
+	for (std::unique_ptr<Section> const &ptr : removedSections) {
+		callback(*ptr);
+	}
+}
+
 static void checkAgainstFixedAddress(Section const &target, Section const &other, uint16_t org) {
 	if (target.isAddressFixed) {
 		if (target.org != org) {
@@ -216,7 +251,7 @@ static void mergeSections(Section &target, std::unique_ptr<Section> &&other) {
 
 void sect_AddSection(std::unique_ptr<Section> &&section) {
 	// Check if the section already exists
-	if (Section *target = sect_GetSection(section->name); target) {
+	if (Section *target = sect_GetSection(section->nameID); target) {
 		mergeSections(*target, std::move(section));
 	} else if (section->modifier == SECTION_UNION && sect_HasData(section->type)) {
 		fatal(
@@ -226,13 +261,18 @@ void sect_AddSection(std::unique_ptr<Section> &&section) {
 		);
 	} else {
 		// If not, add it
-		sectionMap.emplace(section->name, sectionList.size());
+		sectionMap.emplace(section->nameID, sectionList.size());
 		sectionList.push_back(std::move(section));
 	}
 }
 
 Section *sect_GetSection(std::string const &name) {
-	auto search = sectionMap.find(name);
+	uint32_t nameID = name_Find(name, hashName(name));
+	return nameID != UINT32_MAX ? sect_GetSection(nameID) : nullptr;
+}
+
+Section *sect_GetSection(uint32_t nameID) {
+	auto search = sectionMap.find(nameID);
 	return search != sectionMap.end() ? sectionList[search->second].get() : nullptr;
 }
 
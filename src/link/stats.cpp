@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: MIT
+
+#include "link/stats.hpp"
+
+#include <chrono>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "itertools.hpp"
+#include "linkdefs.hpp"
+
+#include "link/main.hpp"
+#include "link/section.hpp"
+#include "link/symbol.hpp"
+
+#if defined(_MSC_VER) || defined(__MINGW32__)
+	#define PSAPI_VERSION 2 // Use `K32GetProcessMemoryInfo` from `kernel32`, not `psapi`
+	#define WIN32_LEAN_AND_MEAN // Include less from `windows.h`
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+LinkStats linkStats;
+
+struct Phase {
+	char const *name;
+	double milliseconds;
+	uint64_t peakRSS; // In KiB; this is the peak since the beginning of the link
+};
+
+static std::vector<Phase> phases;
+static std::chrono::steady_clock::time_point phaseStart;
+
+// `static` so `sect_ForEach` and `sym_ForEach` callbacks can see them
+static uint32_t nbSections[SECTTYPE_INVALID];
+static uint32_t nbUnions;
+static uint32_t nbFragments;
+static uint32_t nbFolded;
+static uint32_t nbRemoved;
+static uint32_t nbSymbols;
+static uint32_t nbPatches[PATCHTYPE_INVALID];
+
+static char const * const patchTypeNames[PATCHTYPE_INVALID] = {
+    "byte", // PATCHTYPE_BYTE
+    "word", // PATCHTYPE_WORD
+    "long", // PATCHTYPE_LONG
+    "jr",   // PATCHTYPE_JR
+};
+
+static uint64_t getPeakRSS() {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0; // LCOV_EXCL_LINE
+	}
+	#ifdef __APPLE__
+	return usage.ru_maxrss / 1024; // macOS reports bytes, not KiB
+	#else
+	return usage.ru_maxrss;
+	#endif
+#endif
+}
+
+static void endPhase() {
+	if (phases.empty()) {
+		return;
+	}
+
+	std::chrono::duration<double, std::milli> elapsed =
+	    std::chrono::steady_clock::now() - phaseStart;
+	phases.back().milliseconds = elapsed.count();
+	phases.back().peakRSS = getPeakRSS();
+}
+
+static void printReport();
+
+void stats_BeginPhase(char const *name) {
+	if (!printStats) {
+		return;
+	}
+
+	if (phases.empty()) {
+		// Report however the link ends, so that failing links can be diagnosed too
+		atexit(printReport);
+	}
+	endPhase();
+	phases.push_back({.name = name, .milliseconds = 0, .peakRSS = 0});
+	phaseStart = std::chrono::steady_clock::now();
+}
+
+static void countSection(Section &section) {
+	++nbSections[section.type];
+	if (section.foldedInto) {
+		++nbFolded;
+	}
+	for (Section const *component = &section; component; component = component->nextu.get()) {
+		if (component->modifier == SECTION_UNION) {
+			++nbUnions;
+		} else if (component->modifier == SECTION_FRAGMENT) {
+			++nbFragments;
+		}
+		for (Patch const &patch : component->patches) {
+			++nbPatches[patch.type];
+		}
+	}
+}
+
+static void printText() {
+	fputs("Phase           Time (ms)  Peak RSS (KiB)\n", stderr);
+	for (Phase const &phase : phases) {
+		fprintf(
+		    stderr, "%-12s %12.3f %15" PRIu64 "\n", phase.name, phase.milliseconds, phase.peakRSS
+		);
+	}
+
+	fprintf(stderr, "Objects: %" PRIu32 "\n", linkStats.nbObjects);
+	fputs("Sections:", stderr);
+	for (SectionType type : EnumSeq(SECTTYPE_INVALID)) {
+		fprintf(stderr, " %s %" PRIu32, sectionTypeInfo[type].name.c_str(), nbSections[type]);
+	}
+	fprintf(stderr, "\nUnion components: %" PRIu32 "\n", nbUnions);
+	fprintf(stderr, "Fragments: %" PRIu32 "\n", nbFragments);
+	fprintf(stderr, "Folded sections: %" PRIu32 "\n", nbFolded);
+	fprintf(stderr, "Removed sections: %" PRIu32 "\n", nbRemoved);
+	fprintf(stderr, "Exported symbols: %" PRIu32 "\n", nbSymbols);
+	fputs("Patches:", stderr);
+	for (PatchType type : EnumSeq(PATCHTYPE_INVALID)) {
+		fprintf(stderr, " %s %" PRIu32, patchTypeNames[type], nbPatches[type]);
+	}
+	fprintf(stderr, "\nRPN bytes evaluated: %" PRIu64 "\n", linkStats.nbRPNBytes);
+	fprintf(stderr, "Free space checks: %" PRIu64 "\n", linkStats.nbFreeSpaceChecks);
+}
+
+static void printJSON() {
+	fputs("{\n  \"phases\": [", stderr);
+	for (size_t i = 0; i < phases.size(); ++i) {
+		fprintf(
+		    stderr,
+		    "%s\n    {\"name\": \"%s\", \"time_ms\": %.3f, \"peak_rss_kib\": %" PRIu64 "}",
+		    i ? "," : "",
+		    phases[i].name,
+		    phases[i].milliseconds,
+		    phases[i].peakRSS
+		);
+	}
+	fputs("\n  ],\n", stderr);
+
+	fprintf(stderr, "  \"objects\": %" PRIu32 ",\n", linkStats.nbObjects);
+	fputs("  \"sections\": {", stderr);
+	for (SectionType type : EnumSeq(SECTTYPE_INVALID)) {
+		fprintf(
+		    stderr,
+		    "%s\"%s\": %" PRIu32,
+		    type ? ", " : "",
+		    sectionTypeInfo[type].name.c_str(),
+		    nbSections[type]
+		);
+	}
+	fputs("},\n", stderr);
+	fprintf(stderr, "  \"union_components\": %" PRIu32 ",\n", nbUnions);
+	fprintf(stderr, "  \"fragments\": %" PRIu32 ",\n", nbFragments);
+	fprintf(stderr, "  \"folded_sections\": %" PRIu32 ",\n", nbFolded);
+	fprintf(stderr, "  \"removed_sections\": %" PRIu32 ",\n", nbRemoved);
+	fprintf(stderr, "  \"exported_symbols\": %" PRIu32 ",\n", nbSymbols);
+	fputs("  \"patches\": {", stderr);
+	for (PatchType type : EnumSeq(PATCHTYPE_INVALID)) {
+		fprintf(
+		    stderr, "%s\"%s\": %" PRIu32, type ? ", " : "", patchTypeNames[type], nbPatches[type]
+		);
+	}
+	fputs("},\n", stderr);
+	fprintf(stderr, "  \"rpn_bytes\": %" PRIu64 ",\n", linkStats.nbRPNBytes);
+	fprintf(stderr, "  \"free_space_checks\": %" PRIu64 "\n}\n", linkStats.nbFreeSpaceChecks);
+}
+
+static void printReport() {
+	endPhase();
+
+	sect_ForEach(countSection);
+	sect_ForEachRemoved([](Section const &) { ++nbRemoved; });
+	sym_ForEach([](Symbol &) { ++nbSymbols; });
+
+	if (statsAsJSON) {
+		printJSON();
+	} else {
+		printText();
+	}
+}
@@ -4,33 +4,40 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "helpers.hpp" // assume
 
 #include "link/main.hpp"
+#include "link/names.hpp"
+#include "link/object.hpp"
 #include "link/section.hpp"
 #include "link/warning.hpp"
 
-std::unordered_map<std::string, Symbol *> symbols;
-std::unordered_map<std::string, std::vector<Symbol *>> localSymbols;
+// Exported symbols, indexed by name ID; `nullptr` for names that are not exported
+static std::vector<Symbol *> symbols;
+
+// Non-exported symbols by name; since these are only needed to hint at why a symbol is unknown,
+// they are only indexed the first time such an error is reported
+static std::unordered_map<std::string_view, std::vector<Symbol const *>> localSymbols;
+static bool localSymbolsIndexed = false;
 
 void sym_ForEach(void (*callback)(Symbol &)) {
-	for (auto &it : symbols) {
-		callback(*it.second);
+	for (Symbol *symbol : symbols) {
+		if (symbol) {
+			callback(*symbol);
+		}
 	}
 }
 
 void sym_AddSymbol(Symbol &symbol) {
 	if (symbol.type != SYMTYPE_EXPORT) {
-		if (symbol.type != SYMTYPE_IMPORT) {
-			localSymbols[symbol.name].push_back(&symbol);
-		}
 		return;
 	}
 
-	Symbol *other = sym_GetSymbol(symbol.name);
+	Symbol *other = sym_GetSymbol(symbol.nameID);
 	int32_t *symValue =
 	    std::holds_alternative<int32_t>(symbol.data) ? &std::get<int32_t>(symbol.data) : nullptr;
 	int32_t *otherValue = other && std::holds_alternative<int32_t>(other->data)
@@ -60,18 +67,37 @@ void sym_AddSymbol(Symbol &symbol) {
 	}
 
 	// If not, add it (potentially replacing the previous same-value symbol)
-	symbols[symbol.name] = &symbol;
+	if (symbol.nameID >= symbols.size()) {
+		symbols.resize(symbol.nameID + 1, nullptr);
+	}
+	symbols[symbol.nameID] = &symbol;
 }
 
 Symbol *sym_GetSymbol(std::string const &name) {
-	auto search = symbols.find(name);
-	return search != symbols.end() ? search->second : nullptr;
+	return sym_GetSymbol(name_Find(name, hashName(name)));
+}
+
+Symbol *sym_GetSymbol(uint32_t nameID) {
+	return nameID < symbols.size() ? symbols[nameID] : nullptr;
 }
 
 void sym_DumpLocalAliasedSymbols(std::string const &name) {
-	std::vector<Symbol *> const &locals = localSymbols[name];
+	if (!localSymbolsIndexed) {
+		obj_ForEachSymbol([](Symbol const &symbol) {
+			if (symbol.type == SYMTYPE_LOCAL) {
+				localSymbols[symbol.name].push_back(&symbol);
+			}
+		});
+		localSymbolsIndexed = true;
+	}
+
+	auto search = localSymbols.find(name);
+	if (search == localSymbols.end()) {
+		return;
+	}
+	std::vector<Symbol const *> const &locals = search->second;
 	int count = 0;
-	for (Symbol *local : locals) {
+	for (Symbol const *local : locals) {
 		if (count++ == 3) {
 			size_t remaining = locals.size() - 3;
 			bool plural = remaining != 1;
@@ -72,3 +72,11 @@ char const * const sectionModNames[] = {
     "UNION",         // SECTION_UNION
     "FRAGMENT",      // SECTION_FRAGMENT
 };
+
+uint64_t hashName(std::string_view name) {
+	uint64_t hash = UINT64_C(0xCBF29CE484222325);
+	for (char c : name) {
+		hash = (hash ^ static_cast<uint8_t>(c)) * UINT64_C(0x100000001B3);
+	}
+	return hash;
+}
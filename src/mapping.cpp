@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MIT
+
+#include "mapping.hpp"
+
+#include <errno.h>
+#include <stdio.h>
+
+// Neither MSVC nor MinGW provide `mmap`
+#if defined(_MSC_VER) || defined(__MINGW32__)
+// clang-format off: maintain `include` order
+	#define WIN32_LEAN_AND_MEAN // Include less from `windows.h`
+	#include <windows.h>   // target architecture
+// clang-format on
+	#include <fileapi.h>   // CreateFileA
+	#include <handleapi.h> // CloseHandle
+	#include <memoryapi.h> // MapViewOfFile
+	#include <winbase.h>   // CreateFileMappingA
+
+std::shared_ptr<char[]> mapFile(int, std::string const &path, size_t, bool) {
+	void *mappingAddr = nullptr;
+	if (HANDLE file = CreateFileA(
+	        path.c_str(),
+	        GENERIC_READ,
+	        FILE_SHARE_READ,
+	        nullptr,
+	        OPEN_EXISTING,
+	        FILE_FLAG_POSIX_SEMANTICS | FILE_FLAG_RANDOM_ACCESS,
+	        nullptr
+	    );
+	    file != INVALID_HANDLE_VALUE) {
+		if (HANDLE mappingObj = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		    mappingObj != INVALID_HANDLE_VALUE) {
+			mappingAddr = MapViewOfFile(mappingObj, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mappingObj);
+		}
+		CloseHandle(file);
+	}
+	if (!mappingAddr) {
+		return nullptr;
+	}
+	return std::shared_ptr<char[]>(static_cast<char *>(mappingAddr), [](char *addr) {
+		UnmapViewOfFile(addr);
+	});
+}
+
+#else // defined(_MSC_VER) || defined(__MINGW32__)
+	#include <sys/mman.h>
+
+std::shared_ptr<char[]> mapFile(int fd, std::string const &path, size_t size, bool verbose) {
+	void *mappingAddr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// LCOV_EXCL_START
+	if (mappingAddr == MAP_FAILED && errno == ENOTSUP) {
+		// The implementation may not support MAP_PRIVATE; try again with MAP_SHARED
+		// instead, offering, I believe, weaker guarantees about external modifications to
+		// the file while reading it. That's still better than not opening it at all, though.
+		if (verbose) {
+			fprintf(
+			    stderr, "mmap(%s, MAP_PRIVATE) failed, retrying with MAP_SHARED\n", path.c_str()
+			);
+		}
+		mappingAddr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	// LCOV_EXCL_STOP
+	if (mappingAddr == MAP_FAILED) {
+		return nullptr;
+	}
+	return std::shared_ptr<char[]>(static_cast<char *>(mappingAddr), [size](char *addr) {
+		munmap(addr, size);
+	});
+}
+
+#endif // !( defined(_MSC_VER) || defined(__MINGW32__) )
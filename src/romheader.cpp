@@ -0,0 +1,1172 @@
+// SPDX-License-Identifier: MIT
+
+#include "romheader.hpp"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diagnostics.hpp"
+#include "helpers.hpp"
+#include "platform.hpp"
+
+enum MbcType {
+	ROM = 0x00,
+	ROM_RAM = 0x08,
+	ROM_RAM_BATTERY = 0x09,
+
+	MBC1 = 0x01,
+	MBC1_RAM = 0x02,
+	MBC1_RAM_BATTERY = 0x03,
+
+	MBC2 = 0x05,
+	MBC2_BATTERY = 0x06,
+
+	MMM01 = 0x0B,
+	MMM01_RAM = 0x0C,
+	MMM01_RAM_BATTERY = 0x0D,
+
+	MBC3 = 0x11,
+	MBC3_TIMER_BATTERY = 0x0F,
+	MBC3_TIMER_RAM_BATTERY = 0x10,
+	MBC3_RAM = 0x12,
+	MBC3_RAM_BATTERY = 0x13,
+
+	MBC5 = 0x19,
+	MBC5_RAM = 0x1A,
+	MBC5_RAM_BATTERY = 0x1B,
+	MBC5_RUMBLE = 0x1C,
+	MBC5_RUMBLE_RAM = 0x1D,
+	MBC5_RUMBLE_RAM_BATTERY = 0x1E,
+
+	MBC6 = 0x20,
+
+	MBC7_SENSOR_RUMBLE_RAM_BATTERY = 0x22,
+
+	POCKET_CAMERA = 0xFC,
+
+	BANDAI_TAMA5 = 0xFD,
+
+	HUC3 = 0xFE,
+
+	HUC1_RAM_BATTERY = 0xFF,
+
+	// "Extended" values (still valid, but not directly actionable)
+
+	// A high byte of 0x01 means TPP1, the low byte is the requested features
+	// This does not include SRAM, which is instead implied by a non-zero SRAM size
+	// Note: Multiple rumble speeds imply rumble
+	TPP1 = 0x100,
+	TPP1_RUMBLE = 0x101,
+	TPP1_MULTIRUMBLE = 0x102, // Should not be possible
+	TPP1_MULTIRUMBLE_RUMBLE = 0x103,
+	TPP1_TIMER = 0x104,
+	TPP1_TIMER_RUMBLE = 0x105,
+	TPP1_TIMER_MULTIRUMBLE = 0x106, // Should not be possible
+	TPP1_TIMER_MULTIRUMBLE_RUMBLE = 0x107,
+	TPP1_BATTERY = 0x108,
+	TPP1_BATTERY_RUMBLE = 0x109,
+	TPP1_BATTERY_MULTIRUMBLE = 0x10A, // Should not be possible
+	TPP1_BATTERY_MULTIRUMBLE_RUMBLE = 0x10B,
+	TPP1_BATTERY_TIMER = 0x10C,
+	TPP1_BATTERY_TIMER_RUMBLE = 0x10D,
+	TPP1_BATTERY_TIMER_MULTIRUMBLE = 0x10E, // Should not be possible
+	TPP1_BATTERY_TIMER_MULTIRUMBLE_RUMBLE = 0x10F,
+
+	// Error values
+	MBC_NONE = UNSPECIFIED, // No MBC specified, do not act on it
+	MBC_BAD,                // Specified MBC does not exist / syntax error
+	MBC_WRONG_FEATURES,     // MBC incompatible with specified features
+	MBC_BAD_RANGE,          // MBC number out of range
+	MBC_BAD_TPP1,           // Invalid TPP1 major or minor revision numbers
+};
+
+static void printAcceptedMBCNames() {
+	fputs("Accepted MBC names:\n", stderr);
+	fputs("\tROM ($00) [aka ROM_ONLY]\n", stderr);
+	fputs("\tMBC1 ($01), MBC1+RAM ($02), MBC1+RAM+BATTERY ($03)\n", stderr);
+	fputs("\tMBC2 ($05), MBC2+BATTERY ($06)\n", stderr);
+	fputs("\tROM+RAM ($08) [deprecated], ROM+RAM+BATTERY ($09) [deprecated]\n", stderr);
+	fputs("\tMMM01 ($0B), MMM01+RAM ($0C), MMM01+RAM+BATTERY ($0D)\n", stderr);
+	fputs("\tMBC3+TIMER+BATTERY ($0F), MBC3+TIMER+RAM+BATTERY ($10)\n", stderr);
+	fputs("\tMBC3 ($11), MBC3+RAM ($12), MBC3+RAM+BATTERY ($13)\n", stderr);
+	fputs("\tMBC5 ($19), MBC5+RAM ($1A), MBC5+RAM+BATTERY ($1B)\n", stderr);
+	fputs("\tMBC5+RUMBLE ($1C), MBC5+RUMBLE+RAM ($1D), MBC5+RUMBLE+RAM+BATTERY ($1E)\n", stderr);
+	fputs("\tMBC6 ($20)\n", stderr);
+	fputs("\tMBC7+SENSOR+RUMBLE+RAM+BATTERY ($22)\n", stderr);
+	fputs("\tPOCKET_CAMERA ($FC)\n", stderr);
+	fputs("\tBANDAI_TAMA5 ($FD) [aka TAMA5]\n", stderr);
+	fputs("\tHUC3 ($FE)\n", stderr);
+	fputs("\tHUC1+RAM+BATTERY ($FF)\n", stderr);
+
+	fputs("\n\tTPP1_1.0, TPP1_1.0+RUMBLE, TPP1_1.0+MULTIRUMBLE, TPP1_1.0+TIMER,\n", stderr);
+	fputs("\tTPP1_1.0+TIMER+RUMBLE, TPP1_1.0+TIMER+MULTIRUMBLE, TPP1_1.0+BATTERY,\n", stderr);
+	fputs("\tTPP1_1.0+BATTERY+RUMBLE, TPP1_1.0+BATTERY+MULTIRUMBLE,\n", stderr);
+	fputs("\tTPP1_1.0+BATTERY+TIMER, TPP1_1.0+BATTERY+TIMER+RUMBLE,\n", stderr);
+	fputs("\tTPP1_1.0+BATTERY+TIMER+MULTIRUMBLE\n", stderr);
+}
+
+static uint8_t tpp1Rev[2];
+
+static bool readMBCSlice(char const *&name, char const *expected) {
+	while (*expected) {
+		char c = *name++;
+
+		if (c == '\0') { // Name too short
+			return false;
+		}
+
+		if (c >= 'a' && c <= 'z') { // Perform the comparison case-insensitive
+			c = c - 'a' + 'A';
+		} else if (c == '_') { // Treat underscores as spaces
+			c = ' ';
+		}
+
+		if (c != *expected++) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static MbcType parseMBC(char const *name) {
+	if (!strcasecmp(name, "help")) {
+		printAcceptedMBCNames();
+		exit(0);
+	}
+
+	if ((name[0] >= '0' && name[0] <= '9') || name[0] == '$') {
+		int base = 0;
+
+		if (name[0] == '$') {
+			name++;
+			base = 16;
+		}
+		// Parse number, and return it as-is (unless it's too large)
+		char *endptr;
+		unsigned long mbc = strtoul(name, &endptr, base);
+
+		if (*endptr) {
+			return MBC_BAD;
+		}
+		if (mbc > 0xFF) {
+			return MBC_BAD_RANGE;
+		}
+		return static_cast<MbcType>(mbc);
+
+	} else {
+		// Begin by reading the MBC type:
+		uint16_t mbc;
+		char const *ptr = name;
+
+		// Trim off leading whitespace
+		while (*ptr == ' ' || *ptr == '\t') {
+			ptr++;
+		}
+
+#define tryReadSlice(expected) \
+	do { \
+		if (!readMBCSlice(ptr, expected)) { \
+			return MBC_BAD; \
+		} \
+	} while (0)
+
+		switch (*ptr++) {
+		case 'R': // ROM / ROM_ONLY
+		case 'r':
+			tryReadSlice("OM");
+			// Handle optional " ONLY"
+			while (*ptr == ' ' || *ptr == '\t' || *ptr == '_') {
+				ptr++;
+			}
+			if (*ptr == 'O' || *ptr == 'o') {
+				ptr++;
+				tryReadSlice("NLY");
+			}
+			mbc = ROM;
+			break;
+
+		case 'M': // MBC{1, 2, 3, 5, 6, 7} / MMM01
+		case 'm':
+			switch (*ptr++) {
+			case 'B':
+			case 'b':
+				switch (*ptr++) {
+				case 'C':
+				case 'c':
+					break;
+				default:
+					return MBC_BAD;
+				}
+				switch (*ptr++) {
+				case '1':
+					mbc = MBC1;
+					break;
+				case '2':
+					mbc = MBC2;
+					break;
+				case '3':
+					mbc = MBC3;
+					break;
+				case '5':
+					mbc = MBC5;
+					break;
+				case '6':
+					mbc = MBC6;
+					break;
+				case '7':
+					mbc = MBC7_SENSOR_RUMBLE_RAM_BATTERY;
+					break;
+				default:
+					return MBC_BAD;
+				}
+				break;
+			case 'M':
+			case 'm':
+				tryReadSlice("M01");
+				mbc = MMM01;
+				break;
+			default:
+				return MBC_BAD;
+			}
+			break;
+
+		case 'P': // POCKET_CAMERA
+		case 'p':
+			tryReadSlice("OCKET CAMERA");
+			mbc = POCKET_CAMERA;
+			break;
+
+		case 'B': // BANDAI_TAMA5
+		case 'b':
+			tryReadSlice("ANDAI TAMA5");
+			mbc = BANDAI_TAMA5;
+			break;
+
+		case 'T': // TAMA5 / TPP1
+		case 't':
+			switch (*ptr++) {
+			case 'A':
+				tryReadSlice("MA5");
+				mbc = BANDAI_TAMA5;
+				break;
+			case 'P': {
+				tryReadSlice("P1");
+				// Parse version
+				while (*ptr == ' ' || *ptr == '_') {
+					ptr++;
+				}
+				// Major
+				char *endptr;
+				unsigned long val = strtoul(ptr, &endptr, 10);
+
+				if (endptr == ptr) {
+					error("Failed to parse TPP1 major revision number");
+					return MBC_BAD_TPP1;
+				}
+				ptr = endptr;
+				if (val != 1) {
+					error("RGBFIX only supports TPP1 version 1.0");
+					return MBC_BAD_TPP1;
+				}
+				tpp1Rev[0] = val;
+				tryReadSlice(".");
+				// Minor
+				val = strtoul(ptr, &endptr, 10);
+				if (endptr == ptr) {
+					error("Failed to parse TPP1 minor revision number");
+					return MBC_BAD_TPP1;
+				}
+				ptr = endptr;
+				if (val > 0xFF) {
+					error("TPP1 minor revision number must be 8-bit");
+					return MBC_BAD_TPP1;
+				}
+				tpp1Rev[1] = val;
+				mbc = TPP1;
+				break;
+			}
+			default:
+				return MBC_BAD;
+			}
+			break;
+
+		case 'H': // HuC{1, 3}
+		case 'h':
+			tryReadSlice("UC");
+			switch (*ptr++) {
+			case '1':
+				mbc = HUC1_RAM_BATTERY;
+				break;
+			case '3':
+				mbc = HUC3;
+				break;
+			default:
+				return MBC_BAD;
+			}
+			break;
+
+		default:
+			return MBC_BAD;
+		}
+
+		// Read "additional features"
+		uint8_t features = 0;
+		// clang-format off: vertically align values
+		static constexpr uint8_t RAM         = 1 << 7;
+		static constexpr uint8_t BATTERY     = 1 << 6;
+		static constexpr uint8_t TIMER       = 1 << 5;
+		static constexpr uint8_t RUMBLE      = 1 << 4;
+		static constexpr uint8_t SENSOR      = 1 << 3;
+		static constexpr uint8_t MULTIRUMBLE = 1 << 2;
+		// clang-format on
+
+		for (;;) {
+			// Trim off trailing whitespace
+			while (*ptr == ' ' || *ptr == '\t' || *ptr == '_') {
+				ptr++;
+			}
+
+			// If done, start processing "features"
+			if (!*ptr) {
+				break;
+			}
+			// We expect a '+' at this point
+			if (*ptr++ != '+') {
+				return MBC_BAD;
+			}
+			// Trim off leading whitespace
+			while (*ptr == ' ' || *ptr == '\t' || *ptr == '_') {
+				ptr++;
+			}
+
+			switch (*ptr++) {
+			case 'B': // BATTERY
+			case 'b':
+				tryReadSlice("ATTERY");
+				features |= BATTERY;
+				break;
+
+			case 'M':
+			case 'm':
+				tryReadSlice("ULTIRUMBLE");
+				features |= MULTIRUMBLE;
+				break;
+
+			case 'R': // RAM or RUMBLE
+			case 'r':
+				switch (*ptr++) {
+				case 'U':
+				case 'u':
+					tryReadSlice("MBLE");
+					features |= RUMBLE;
+					break;
+				case 'A':
+				case 'a':
+					tryReadSlice("M");
+					features |= RAM;
+					break;
+				default:
+					return MBC_BAD;
+				}
+				break;
+
+			case 'S': // SENSOR
+			case 's':
+				tryReadSlice("ENSOR");
+				features |= SENSOR;
+				break;
+
+			case 'T': // TIMER
+			case 't':
+				tryReadSlice("IMER");
+				features |= TIMER;
+				break;
+
+			default:
+				return MBC_BAD;
+			}
+		}
+#undef tryReadSlice
+
+		switch (mbc) {
+		case ROM:
+			if (!features) {
+				break;
+			}
+			mbc = ROM_RAM - 1;
+			static_assert(ROM_RAM + 1 == ROM_RAM_BATTERY, "Enum sanity check failed!");
+			static_assert(MBC1 + 1 == MBC1_RAM, "Enum sanity check failed!");
+			static_assert(MBC1 + 2 == MBC1_RAM_BATTERY, "Enum sanity check failed!");
+			static_assert(MMM01 + 1 == MMM01_RAM, "Enum sanity check failed!");
+			static_assert(MMM01 + 2 == MMM01_RAM_BATTERY, "Enum sanity check failed!");
+			[[fallthrough]];
+		case MBC1:
+		case MMM01:
+			if (features == RAM) {
+				mbc++;
+			} else if (features == (RAM | BATTERY)) {
+				mbc += 2;
+			} else if (features) {
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+
+		case MBC2:
+			if (features == BATTERY) {
+				mbc = MBC2_BATTERY;
+			} else if (features) {
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+
+		case MBC3:
+			// Handle timer, which also requires battery
+			if (features & TIMER) {
+				if (!(features & BATTERY)) {
+					warnx("MBC3+TIMER implies BATTERY");
+				}
+				features &= ~(TIMER | BATTERY); // Reset those bits
+				mbc = MBC3_TIMER_BATTERY;
+				// RAM is handled below
+			}
+			static_assert(MBC3 + 1 == MBC3_RAM, "Enum sanity check failed!");
+			static_assert(MBC3 + 2 == MBC3_RAM_BATTERY, "Enum sanity check failed!");
+			static_assert(
+			    MBC3_TIMER_BATTERY + 1 == MBC3_TIMER_RAM_BATTERY, "Enum sanity check failed!"
+			);
+			if (features == RAM) {
+				mbc++;
+			} else if (features == (RAM | BATTERY)) {
+				mbc += 2;
+			} else if (features) {
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+
+		case MBC5:
+			if (features & RUMBLE) {
+				features &= ~RUMBLE;
+				mbc = MBC5_RUMBLE;
+			}
+			static_assert(MBC5 + 1 == MBC5_RAM, "Enum sanity check failed!");
+			static_assert(MBC5 + 2 == MBC5_RAM_BATTERY, "Enum sanity check failed!");
+			static_assert(MBC5_RUMBLE + 1 == MBC5_RUMBLE_RAM, "Enum sanity check failed!");
+			static_assert(MBC5_RUMBLE + 2 == MBC5_RUMBLE_RAM_BATTERY, "Enum sanity check failed!");
+			if (features == RAM) {
+				mbc++;
+			} else if (features == (RAM | BATTERY)) {
+				mbc += 2;
+			} else if (features) {
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+
+		case MBC6:
+		case POCKET_CAMERA:
+		case BANDAI_TAMA5:
+		case HUC3:
+			// No extra features accepted
+			if (features) {
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+
+		case MBC7_SENSOR_RUMBLE_RAM_BATTERY:
+			if (features != (SENSOR | RUMBLE | RAM | BATTERY)) {
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+
+		case HUC1_RAM_BATTERY:
+			if (features != (RAM | BATTERY)) { // HuC1 expects RAM+BATTERY
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+
+		case TPP1:
+			if (features & RAM) {
+				warnx("TPP1 requests RAM implicitly if given a non-zero RAM size");
+			}
+			if (features & BATTERY) {
+				mbc |= 0x08;
+			}
+			if (features & TIMER) {
+				mbc |= 0x04;
+			}
+			if (features & MULTIRUMBLE) {
+				mbc |= 0x03; // Also set the rumble flag
+			}
+			if (features & RUMBLE) {
+				mbc |= 0x01;
+			}
+			if (features & SENSOR) {
+				return MBC_WRONG_FEATURES;
+			}
+			break;
+		}
+
+		// Trim off trailing whitespace
+		while (*ptr == ' ' || *ptr == '\t') {
+			ptr++;
+		}
+
+		// If there is still something past the whitespace, error out
+		if (*ptr) {
+			return MBC_BAD;
+		}
+
+		return static_cast<MbcType>(mbc);
+	}
+}
+
+static char const *mbcName(MbcType type) {
+	switch (type) {
+	case ROM:
+		return "ROM";
+	case ROM_RAM:
+		return "ROM+RAM";
+	case ROM_RAM_BATTERY:
+		return "ROM+RAM+BATTERY";
+	case MBC1:
+		return "MBC1";
+	case MBC1_RAM:
+		return "MBC1+RAM";
+	case MBC1_RAM_BATTERY:
+		return "MBC1+RAM+BATTERY";
+	case MBC2:
+		return "MBC2";
+	case MBC2_BATTERY:
+		return "MBC2+BATTERY";
+	case MMM01:
+		return "MMM01";
+	case MMM01_RAM:
+		return "MMM01+RAM";
+	case MMM01_RAM_BATTERY:
+		return "MMM01+RAM+BATTERY";
+	case MBC3:
+		return "MBC3";
+	case MBC3_TIMER_BATTERY:
+		return "MBC3+TIMER+BATTERY";
+	case MBC3_TIMER_RAM_BATTERY:
+		return "MBC3+TIMER+RAM+BATTERY";
+	case MBC3_RAM:
+		return "MBC3+RAM";
+	case MBC3_RAM_BATTERY:
+		return "MBC3+RAM+BATTERY";
+	case MBC5:
+		return "MBC5";
+	case MBC5_RAM:
+		return "MBC5+RAM";
+	case MBC5_RAM_BATTERY:
+		return "MBC5+RAM+BATTERY";
+	case MBC5_RUMBLE:
+		return "MBC5+RUMBLE";
+	case MBC5_RUMBLE_RAM:
+		return "MBC5+RUMBLE+RAM";
+	case MBC5_RUMBLE_RAM_BATTERY:
+		return "MBC5+RUMBLE+RAM+BATTERY";
+	case MBC6:
+		return "MBC6";
+	case MBC7_SENSOR_RUMBLE_RAM_BATTERY:
+		return "MBC7+SENSOR+RUMBLE+RAM+BATTERY";
+	case POCKET_CAMERA:
+		return "POCKET CAMERA";
+	case BANDAI_TAMA5:
+		return "BANDAI TAMA5";
+	case HUC3:
+		return "HUC3";
+	case HUC1_RAM_BATTERY:
+		return "HUC1+RAM+BATTERY";
+	case TPP1:
+		return "TPP1";
+	case TPP1_RUMBLE:
+		return "TPP1+RUMBLE";
+	case TPP1_MULTIRUMBLE:
+	case TPP1_MULTIRUMBLE_RUMBLE:
+		return "TPP1+MULTIRUMBLE";
+	case TPP1_TIMER:
+		return "TPP1+TIMER";
+	case TPP1_TIMER_RUMBLE:
+		return "TPP1+TIMER+RUMBLE";
+	case TPP1_TIMER_MULTIRUMBLE:
+	case TPP1_TIMER_MULTIRUMBLE_RUMBLE:
+		return "TPP1+TIMER+MULTIRUMBLE";
+	case TPP1_BATTERY:
+		return "TPP1+BATTERY";
+	case TPP1_BATTERY_RUMBLE:
+		return "TPP1+BATTERY+RUMBLE";
+	case TPP1_BATTERY_MULTIRUMBLE:
+	case TPP1_BATTERY_MULTIRUMBLE_RUMBLE:
+		return "TPP1+BATTERY+MULTIRUMBLE";
+	case TPP1_BATTERY_TIMER:
+		return "TPP1+BATTERY+TIMER";
+	case TPP1_BATTERY_TIMER_RUMBLE:
+		return "TPP1+BATTERY+TIMER+RUMBLE";
+	case TPP1_BATTERY_TIMER_MULTIRUMBLE:
+	case TPP1_BATTERY_TIMER_MULTIRUMBLE_RUMBLE:
+		return "TPP1+BATTERY+TIMER+MULTIRUMBLE";
+
+	// Error values
+	case MBC_NONE:
+	case MBC_BAD:
+	case MBC_WRONG_FEATURES:
+	case MBC_BAD_RANGE:
+	case MBC_BAD_TPP1:
+		// LCOV_EXCL_START
+		unreachable_();
+	}
+
+	unreachable_();
+	// LCOV_EXCL_STOP
+}
+
+static bool hasRAM(MbcType type) {
+	switch (type) {
+	case ROM:
+	case MBC1:
+	case MBC2: // Technically has RAM, but not marked as such
+	case MBC2_BATTERY:
+	case MMM01:
+	case MBC3:
+	case MBC3_TIMER_BATTERY:
+	case MBC5:
+	case MBC5_RUMBLE:
+	case BANDAI_TAMA5: // "Game de Hakken!! Tamagotchi - Osutchi to Mesutchi" has RAM size 0
+	case MBC_NONE:
+	case MBC_BAD:
+	case MBC_WRONG_FEATURES:
+	case MBC_BAD_RANGE:
+	case MBC_BAD_TPP1:
+		return false;
+
+	case ROM_RAM:
+	case ROM_RAM_BATTERY:
+	case MBC1_RAM:
+	case MBC1_RAM_BATTERY:
+	case MMM01_RAM:
+	case MMM01_RAM_BATTERY:
+	case MBC3_TIMER_RAM_BATTERY:
+	case MBC3_RAM:
+	case MBC3_RAM_BATTERY:
+	case MBC5_RAM:
+	case MBC5_RAM_BATTERY:
+	case MBC5_RUMBLE_RAM:
+	case MBC5_RUMBLE_RAM_BATTERY:
+	case MBC6: // "Net de Get - Minigame @ 100" has RAM size 3 (32 KiB)
+	case MBC7_SENSOR_RUMBLE_RAM_BATTERY:
+	case POCKET_CAMERA:
+	case HUC3:
+	case HUC1_RAM_BATTERY:
+		return true;
+
+	// TPP1 may or may not have RAM, don't call this function for it
+	case TPP1:
+	case TPP1_RUMBLE:
+	case TPP1_MULTIRUMBLE:
+	case TPP1_MULTIRUMBLE_RUMBLE:
+	case TPP1_TIMER:
+	case TPP1_TIMER_RUMBLE:
+	case TPP1_TIMER_MULTIRUMBLE:
+	case TPP1_TIMER_MULTIRUMBLE_RUMBLE:
+	case TPP1_BATTERY:
+	case TPP1_BATTERY_RUMBLE:
+	case TPP1_BATTERY_MULTIRUMBLE:
+	case TPP1_BATTERY_MULTIRUMBLE_RUMBLE:
+	case TPP1_BATTERY_TIMER:
+	case TPP1_BATTERY_TIMER_RUMBLE:
+	case TPP1_BATTERY_TIMER_MULTIRUMBLE:
+	case TPP1_BATTERY_TIMER_MULTIRUMBLE_RUMBLE:
+		break;
+	}
+
+	unreachable_(); // LCOV_EXCL_LINE
+}
+
+static uint8_t const nintendoLogo[] = {
+    0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B, 0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D,
+    0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E, 0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99,
+    0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC, 0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E,
+};
+
+static uint8_t fixSpec = 0;
+// clang-format off: vertically align values
+static constexpr uint8_t FIX_LOGO         = 1 << 7;
+static constexpr uint8_t TRASH_LOGO       = 1 << 6;
+static constexpr uint8_t FIX_HEADER_SUM   = 1 << 5;
+static constexpr uint8_t TRASH_HEADER_SUM = 1 << 4;
+static constexpr uint8_t FIX_GLOBAL_SUM   = 1 << 3;
+static constexpr uint8_t TRASH_GLOBAL_SUM = 1 << 2;
+// clang-format on
+
+static enum { DMG, BOTH, CGB } model = DMG; // If DMG, byte is left alone
+static char const *gameID = nullptr;
+static uint8_t gameIDLen;
+static bool japanese = true;
+static char const *logoFilename = nullptr;
+static uint8_t logo[sizeof(nintendoLogo)] = {};
+static char const *newLicensee = nullptr;
+static uint8_t newLicenseeLen;
+static uint16_t oldLicensee = UNSPECIFIED;
+static MbcType cartridgeType = MBC_NONE;
+static uint16_t romVersion = UNSPECIFIED;
+static bool overwriteRom = false; // If false, warn when overwriting non-zero non-identical bytes
+static uint16_t padValue = UNSPECIFIED;
+static uint16_t ramSize = UNSPECIFIED;
+static bool sgb = false; // If false, SGB flags are left alone
+static char const *title = nullptr;
+static uint8_t titleLen;
+
+static bool isFixing = false; // Whether any header option was given
+
+static uint8_t maxTitleLen() {
+	return gameID ? 11 : model != DMG ? 15 : 16;
+}
+
+static void parseByte(uint16_t &output, char const *arg, char const *name) {
+	if (arg[0] == 0) {
+		error("Argument to option '%s' may not be empty", name);
+	} else {
+		char *endptr;
+		unsigned long value;
+
+		if (arg[0] == '$') {
+			value = strtoul(&arg[1], &endptr, 16);
+		} else {
+			value = strtoul(arg, &endptr, 0);
+		}
+		if (*endptr) {
+			error("Expected number as argument to option '%s', got %s", name, arg);
+		} else if (value > 0xFF) {
+			error("Argument to option '%s' is larger than 255: %lu", name, value);
+		} else {
+			output = value;
+		}
+	}
+}
+
+// This sums 8 bytes at a time, as 16-bit lanes of a 64-bit word, which is much faster for big ROMs.
+uint16_t header_SumBytes(uint8_t const *data, size_t len) {
+	static constexpr uint64_t EVEN_BYTES = 0x00FF00FF00FF00FF;
+	// Each word adds at most 2 * 0xFF to each lane, so they can take this many before overflowing
+	static constexpr size_t WORDS_PER_BLOCK = 0x10000 / (2 * 0x100);
+
+	uint16_t sum = 0;
+	while (len >= sizeof(uint64_t)) {
+		size_t nbWords = len / sizeof(uint64_t);
+		if (nbWords > WORDS_PER_BLOCK) {
+			nbWords = WORDS_PER_BLOCK;
+		}
+
+		uint64_t lanes = 0;
+		for (size_t i = 0; i < nbWords; ++i) {
+			uint64_t word;
+			memcpy(&word, data, sizeof(word)); // Unaligned load
+			lanes += (word & EVEN_BYTES) + ((word >> 8) & EVEN_BYTES);
+			data += sizeof(word);
+		}
+		sum += lanes + (lanes >> 16) + (lanes >> 32) + (lanes >> 48);
+		len -= nbWords * sizeof(uint64_t);
+	}
+	for (; len; --len) {
+		sum += *data++;
+	}
+	return sum;
+}
+
+static void overwriteByte(uint8_t *rom0, uint16_t addr, uint8_t fixedByte, char const *areaName) {
+	uint8_t origByte = rom0[addr];
+
+	if (!overwriteRom && origByte != 0 && origByte != fixedByte) {
+		warnx("Overwrote a non-zero byte in the %s", areaName);
+	}
+
+	rom0[addr] = fixedByte;
+}
+
+static void overwriteBytes(
+    uint8_t *rom0, uint16_t startAddr, uint8_t const *fixed, uint8_t size, char const *areaName
+) {
+	if (!overwriteRom) {
+		for (uint8_t i = 0; i < size; i++) {
+			uint8_t origByte = rom0[i + startAddr];
+
+			if (origByte != 0 && origByte != fixed[i]) {
+				warnx("Overwrote a non-zero byte in the %s", areaName);
+				break;
+			}
+		}
+	}
+
+	memcpy(&rom0[startAddr], fixed, size);
+}
+
+bool header_ParseOption(char option, char const *arg, char const *optName) {
+	size_t len;
+
+	switch (option) {
+	case 'C':
+	case 'c':
+		model = option == 'c' ? BOTH : CGB;
+		if (titleLen > 15) {
+			titleLen = 15;
+			warnx("Truncating title \"%s\" to 15 chars", title);
+		}
+		break;
+
+	case 'f':
+		fixSpec = 0;
+		for (; *arg; ++arg) {
+			switch (*arg) {
+#define OVERRIDE_SPEC(cur, bad, curFlag, badFlag) \
+	case STR(cur)[0]: \
+		if (fixSpec & badFlag) { \
+			warnx("'" STR(cur) "' overriding '" STR(bad) "' in fix spec"); \
+		} \
+		fixSpec = (fixSpec & ~badFlag) | curFlag; \
+		break
+#define overrideSpecs(fix, fixFlag, trash, trashFlag) \
+	OVERRIDE_SPEC(fix, trash, fixFlag, trashFlag); \
+	OVERRIDE_SPEC(trash, fix, trashFlag, fixFlag)
+				overrideSpecs(l, FIX_LOGO, L, TRASH_LOGO);
+				overrideSpecs(h, FIX_HEADER_SUM, H, TRASH_HEADER_SUM);
+				overrideSpecs(g, FIX_GLOBAL_SUM, G, TRASH_GLOBAL_SUM);
+#undef OVERRIDE_SPEC
+#undef overrideSpecs
+
+			default:
+				warnx("Ignoring '%c' in fix spec", *arg);
+			}
+		}
+		break;
+
+	case 'i':
+		gameID = arg;
+		len = strlen(gameID);
+		if (len > 4) {
+			len = 4;
+			warnx("Truncating game ID \"%s\" to 4 chars", gameID);
+		}
+		gameIDLen = len;
+		if (titleLen > 11) {
+			titleLen = 11;
+			warnx("Truncating title \"%s\" to 11 chars", title);
+		}
+		break;
+
+	case 'j':
+		japanese = false;
+		break;
+
+	case 'k':
+		newLicensee = arg;
+		len = strlen(newLicensee);
+		if (len > 2) {
+			len = 2;
+			warnx("Truncating new licensee \"%s\" to 2 chars", newLicensee);
+		}
+		newLicenseeLen = len;
+		break;
+
+	case 'L':
+		logoFilename = arg;
+		break;
+
+	case 'l':
+		parseByte(oldLicensee, arg, optName);
+		break;
+
+	case 'm':
+		cartridgeType = parseMBC(arg);
+		if (cartridgeType == MBC_BAD) {
+			error("Unknown MBC \"%s\"", arg);
+			printAcceptedMBCNames();
+		} else if (cartridgeType == MBC_WRONG_FEATURES) {
+			error("Features incompatible with MBC (\"%s\")", arg);
+			printAcceptedMBCNames();
+		} else if (cartridgeType == MBC_BAD_RANGE) {
+			error("Specified MBC ID out of range 0-255: %s", arg);
+		} else if (cartridgeType == ROM_RAM || cartridgeType == ROM_RAM_BATTERY) {
+			warnx("MBC \"%s\" is under-specified and poorly supported", arg);
+		}
+		break;
+
+	case 'n':
+		parseByte(romVersion, arg, optName);
+		break;
+
+	case 'O':
+		overwriteRom = true;
+		break;
+
+	case 'p':
+		parseByte(padValue, arg, optName);
+		break;
+
+	case 'r':
+		parseByte(ramSize, arg, optName);
+		break;
+
+	case 's':
+		sgb = true;
+		break;
+
+	case 't': {
+		title = arg;
+		len = strlen(title);
+		uint8_t maxLen = maxTitleLen();
+
+		if (len > maxLen) {
+			len = maxLen;
+			warnx("Truncating title \"%s\" to %u chars", title, maxLen);
+		}
+		titleLen = len;
+		break;
+	}
+
+	case 'v':
+		fixSpec = FIX_LOGO | FIX_HEADER_SUM | FIX_GLOBAL_SUM;
+		break;
+
+	default:
+		return false;
+	}
+
+	isFixing = true;
+	return true;
+}
+
+[[gnu::format(printf, 1, 2), noreturn]]
+static void fatalOptions(char const *fmt, ...) {
+	va_list ap;
+	fputs("FATAL: ", stderr);
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	putc('\n', stderr);
+	exit(1);
+}
+
+void header_FinishOptions() {
+	if ((cartridgeType & 0xFF00) == TPP1 && !japanese) {
+		warnx("TPP1 overwrites region flag for its identification code, ignoring `-j`");
+	}
+
+	// Check that RAM size is correct for "standard" mappers
+	if (ramSize != UNSPECIFIED && (cartridgeType & 0xFF00) == 0) {
+		if (cartridgeType == ROM_RAM || cartridgeType == ROM_RAM_BATTERY) {
+			if (ramSize != 1) {
+				warnx("MBC \"%s\" should have 2 KiB of RAM (-r 1)", mbcName(cartridgeType));
+			}
+		} else if (hasRAM(cartridgeType)) {
+			if (!ramSize) {
+				warnx("MBC \"%s\" has RAM, but RAM size was set to 0", mbcName(cartridgeType));
+			} else if (ramSize == 1) {
+				warnx("RAM size 1 (2 KiB) was specified for MBC \"%s\"", mbcName(cartridgeType));
+			}
+		} else if (ramSize) {
+			warnx(
+			    "MBC \"%s\" has no RAM, but RAM size was set to %u", mbcName(cartridgeType), ramSize
+			);
+		}
+	}
+
+	if (sgb && oldLicensee != UNSPECIFIED && oldLicensee != 0x33) {
+		warnx("SGB compatibility enabled, but old licensee is 0x%02x, not 0x33", oldLicensee);
+	}
+
+	if (logoFilename) {
+		FILE *logoFile;
+		if (strcmp(logoFilename, "-")) {
+			logoFile = fopen(logoFilename, "rb");
+		} else {
+			logoFilename = "<stdin>";
+			(void)setmode(STDIN_FILENO, O_BINARY);
+			logoFile = stdin;
+		}
+		if (!logoFile) {
+			fatalOptions("Failed to open \"%s\" for reading: %s", logoFilename, strerror(errno));
+		}
+		Defer closeLogo{[&] { fclose(logoFile); }};
+		uint8_t logoBpp[sizeof(logo)];
+		if (size_t nbRead = fread(logoBpp, 1, sizeof(logoBpp), logoFile);
+		    nbRead != sizeof(logo) || fgetc(logoFile) != EOF || ferror(logoFile)) {
+			fatalOptions("\"%s\" is not %zu bytes", logoFilename, sizeof(logo));
+		}
+		auto highs = [&logoBpp](size_t i) {
+			return (logoBpp[i * 2] & 0xF0) | ((logoBpp[i * 2 + 1] & 0xF0) >> 4);
+		};
+		auto lows = [&logoBpp](size_t i) {
+			return ((logoBpp[i * 2] & 0x0F) << 4) | (logoBpp[i * 2 + 1] & 0x0F);
+		};
+		constexpr size_t mid = sizeof(logo) / 2;
+		for (size_t i = 0; i < mid; i += 4) {
+			logo[i + 0] = highs(i + 0);
+			logo[i + 1] = highs(i + 1);
+			logo[i + 2] = lows(i + 0);
+			logo[i + 3] = lows(i + 1);
+			logo[mid + i + 0] = highs(i + 2);
+			logo[mid + i + 1] = highs(i + 3);
+			logo[mid + i + 2] = lows(i + 2);
+			logo[mid + i + 3] = lows(i + 3);
+		}
+	} else {
+		memcpy(logo, nintendoLogo, sizeof(nintendoLogo));
+	}
+	if (fixSpec & TRASH_LOGO) {
+		for (uint16_t i = 0; i < sizeof(logo); i++) {
+			logo[i] = 0xFF ^ logo[i];
+		}
+	}
+}
+
+bool header_IsFixing() {
+	return isFixing;
+}
+
+uint16_t header_Size() {
+	return (cartridgeType & 0xFF00) == TPP1 ? 0x154 : 0x150;
+}
+
+uint16_t header_PadValue() {
+	return padValue;
+}
+
+bool header_FixesGlobalSum() {
+	return fixSpec & (FIX_GLOBAL_SUM | TRASH_GLOBAL_SUM);
+}
+
+void header_Overwrite(uint8_t *rom0) {
+	if (fixSpec & (FIX_LOGO | TRASH_LOGO)) {
+		overwriteBytes(rom0, 0x0104, logo, sizeof(logo), logoFilename ? "logo" : "Nintendo logo");
+	}
+
+	if (title) {
+		overwriteBytes(rom0, 0x134, reinterpret_cast<uint8_t const *>(title), titleLen, "title");
+	}
+
+	if (gameID) {
+		overwriteBytes(
+		    rom0, 0x13F, reinterpret_cast<uint8_t const *>(gameID), gameIDLen, "manufacturer code"
+		);
+	}
+
+	if (model != DMG) {
+		overwriteByte(rom0, 0x143, model == BOTH ? 0x80 : 0xC0, "CGB flag");
+	}
+
+	if (newLicensee) {
+		overwriteBytes(
+		    rom0,
+		    0x144,
+		    reinterpret_cast<uint8_t const *>(newLicensee),
+		    newLicenseeLen,
+		    "new licensee code"
+		);
+	}
+
+	if (sgb) {
+		overwriteByte(rom0, 0x146, 0x03, "SGB flag");
+	}
+
+	// If a valid MBC was specified...
+	if (cartridgeType < MBC_NONE) {
+		uint8_t byte = cartridgeType;
+
+		if ((cartridgeType & 0xFF00) == TPP1) {
+			// Cartridge type isn't directly actionable, translate it
+			byte = 0xBC;
+			// The other TPP1 identification bytes will be written below
+		}
+		overwriteByte(rom0, 0x147, byte, "cartridge type");
+	}
+
+	// ROM size will be written last, after evaluating the file's size
+
+	if ((cartridgeType & 0xFF00) == TPP1) {
+		uint8_t const tpp1Code[2] = {0xC1, 0x65};
+
+		overwriteBytes(rom0, 0x149, tpp1Code, sizeof(tpp1Code), "TPP1 identification code");
+
+		overwriteBytes(rom0, 0x150, tpp1Rev, sizeof(tpp1Rev), "TPP1 revision number");
+
+		if (ramSize != UNSPECIFIED) {
+			overwriteByte(rom0, 0x152, ramSize, "RAM size");
+		}
+
+		overwriteByte(rom0, 0x153, cartridgeType & 0xFF, "TPP1 feature flags");
+	} else {
+		// Regular mappers
+
+		if (ramSize != UNSPECIFIED) {
+			overwriteByte(rom0, 0x149, ramSize, "RAM size");
+		}
+
+		if (!japanese) {
+			overwriteByte(rom0, 0x14A, 0x01, "destination code");
+		}
+	}
+
+	if (oldLicensee != UNSPECIFIED) {
+		overwriteByte(rom0, 0x14B, oldLicensee, "old licensee code");
+	} else if (sgb && rom0[0x14B] != 0x33) {
+		warnx("SGB compatibility enabled, but old licensee was 0x%02x, not 0x33", rom0[0x14B]);
+	}
+
+	if (romVersion != UNSPECIFIED) {
+		overwriteByte(rom0, 0x14C, romVersion, "mask ROM version number");
+	}
+}
+
+uint32_t header_PadROMSize(uint8_t *rom0, uint32_t nbBanks) {
+	// Pad to the next valid power of 2. This is because padding is required by flashers, which
+	// flash to ROM chips, whose size is always a power of 2... so there'd be no point in
+	// padding to something else.
+	// Additionally, a ROM must be at least 32k, so we guarantee a whole amount of banks...
+	if (nbBanks < 2) {
+		nbBanks = 2;
+	}
+	// x&(x-1) is zero iff x is a power of 2, or 0; we know for sure it's non-zero,
+	// so this is true (non-zero) when we don't have a power of 2
+	if (nbBanks & (nbBanks - 1)) {
+		nbBanks = 1 << (CHAR_BIT * sizeof(nbBanks) - clz(nbBanks));
+	}
+	// Write final ROM size
+	rom0[0x148] = ctz(nbBanks / 2);
+	return nbBanks;
+}
+
+void header_FixChecksums(uint8_t *rom0, size_t rom0Len, uint16_t restSum) {
+	// Handle the header checksum after the ROM size has been written
+	if (fixSpec & (FIX_HEADER_SUM | TRASH_HEADER_SUM)) {
+		uint8_t sum = 0;
+
+		for (uint16_t i = 0x134; i < 0x14D; i++) {
+			sum -= rom0[i] + 1;
+		}
+
+		overwriteByte(rom0, 0x14D, fixSpec & TRASH_HEADER_SUM ? ~sum : sum, "header checksum");
+	}
+
+	if (fixSpec & (FIX_GLOBAL_SUM | TRASH_GLOBAL_SUM)) {
+		// Computation of the global checksum does not include the checksum bytes
+		assume(rom0Len >= 0x150);
+		uint16_t globalSum = restSum;
+		globalSum += header_SumBytes(rom0, 0x14E);
+		globalSum += header_SumBytes(&rom0[0x150], rom0Len - 0x150);
+
+		if (fixSpec & TRASH_GLOBAL_SUM) {
+			globalSum = ~globalSum;
+		}
+
+		uint8_t bytes[2] = {
+		    static_cast<uint8_t>(globalSum >> 8), static_cast<uint8_t>(globalSum & 0xFF)
+		};
+
+		overwriteBytes(rom0, 0x14E, bytes, sizeof(bytes), "global checksum");
+	}
+}
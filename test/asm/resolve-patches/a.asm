@@ -0,0 +1,45 @@
+; Expressions that only become constant once the whole file has been assembled
+
+SECTION "fixed", ROM0[$0000]
+	dw FixedFwd ; Forward reference to a fixed label
+	db LOW(FixedFwd), HIGH(FixedFwd)
+	dw FloatEnd - FloatStart ; Difference of not-yet-defined floating labels
+	db BANK(FixedFwd), BANK("fixed")
+	dw SIZEOF("later"), STARTOF("later")
+	dl LaterConst * 3
+	jr FixedFwd
+	ld a, [FixedFwd]
+	ldh a, [HRAMFwd]
+	rst RSTFwd
+	bit BitFwd, a
+FixedFwd:
+	db $42
+FixedFwd2:
+
+SECTION "later", ROM0[$0040]
+	ds 5, $FF
+
+SECTION "floating", ROM0
+	assert FloatEnd - FloatStart == 15 ; Only known once `FloatEnd` is defined
+	assert warn, FixedFwd2 == $1B
+FloatStart:
+	jr FloatEnd ; Forward JR in a floating section
+	db FloatEnd - @
+	dw FloatStart + 2 - FloatEnd
+	db FloatEnd - FloatStart + BANK(@)
+	db (FloatEnd - FloatStart) * 2 + 1
+	db 300 * (FloatEnd - FloatStart) ; Stays a patch (out of range)
+	dw (FloatEnd - FloatStart) * $2000 ; Stays a patch (out of range)
+	jr Unrelated ; Stays a patch (different section)
+	ds 3
+FloatEnd:
+	nop
+
+SECTION "unrelated", ROM0
+Unrelated:
+	ret
+
+DEF LaterConst EQU $11223344
+DEF HRAMFwd EQU $FF80
+DEF RSTFwd EQU $38
+DEF BitFwd EQU 5
@@ -0,0 +1,15 @@
+; Values that are only known once the whole file has been assembled, but that are invalid;
+; they must stay patches, so that RGBLINK reports them
+
+SECTION "fixed", ROM0[$0000]
+	jr FarFwd
+	ldh a, [NotHRAM]
+	rst NotRST
+	bit NotBit, a
+	ds $100
+FarFwd:
+	ret
+
+DEF NotHRAM EQU $C000
+DEF NotRST EQU $39
+DEF NotBit EQU 8
@@ -194,6 +194,31 @@ for variant in '' '.pipe'; do
 	fi
 done
 
+i="resolve-patches"
+# Patches whose values are known by the end of assembly are resolved by RGBASM, except for invalid
+# values, which must be left for RGBLINK to report
+for variant in /a /b; do
+	(( tests++ ))
+	echo "${bold}${green}${i}${variant}...${rescolors}${resbold}"
+	"$RGBASM" -Weverything -v -o "$o" "$i$variant".asm 2>&1 | grep '^Resolved' >"$output"
+	tryDiff "$i$variant".out "$output" out
+	our_rc=$?
+	"$RGBLINK" -Weverything -o "$gb" "$o" 2>"$errput"
+	tryDiff "$i$variant".err "$errput" err
+	(( our_rc = our_rc || $? ))
+	if [[ -f "$i$variant".out.bin ]]; then
+		rom_size=$(printf %s $(wc -c <"$i$variant".out.bin))
+		dd if="$gb" count=1 bs="$rom_size" >"$output" 2>/dev/null
+		tryCmp "$i$variant".out.bin "$output" gb
+		(( our_rc = our_rc || $? ))
+	fi
+
+	(( rc = rc || our_rc ))
+	if [[ $our_rc -ne 0 ]]; then
+		(( failed++ ))
+	fi
+done
+
 if [[ "$failed" -eq 0 ]]; then
 	echo "${bold}${green}All ${tests} tests passed!${rescolors}${resbold}"
 else
@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: MIT
+
+// Generates a random, but valid, set of RGBASM source files that link together.
+// They exercise most of what ends up in object files, ROMs, map and sym files: fixed, aligned,
+// and floating sections of every type, fragments and unions shared between files, exported and
+// local labels referenced across files, constants, macros, REPT blocks, and charmaps.
+// The same seed always generates the same files, regardless of the platform.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static std::mt19937 rng; // Its output is fully specified by the standard, unlike distributions
+
+static uint32_t randUpTo(uint32_t max) { // Inclusive
+	return rng() % (max + 1);
+}
+
+static bool randChance(uint32_t percent) {
+	return randUpTo(99) < percent;
+}
+
+enum SectionKind {
+	KIND_ROM0,
+	KIND_ROMX,
+	KIND_ROMX_BANKED,
+	KIND_ROMX_ALIGNED,
+	KIND_FRAGMENT,
+	KIND_WRAM0,
+	KIND_WRAMX,
+	KIND_UNION,
+	KIND_HRAM_UNION,
+
+	NB_KINDS
+};
+
+static bool isROM(SectionKind kind) {
+	return kind <= KIND_FRAGMENT;
+}
+
+struct SectionPlan {
+	SectionKind kind;
+	std::string name;
+	std::vector<std::string> labels;
+};
+
+struct FilePlan {
+	std::vector<SectionPlan> sections;
+	std::vector<std::string> constants;
+	std::vector<std::string> charmapStrings;
+};
+
+static std::vector<FilePlan> files;
+static std::vector<std::string> romLabels;
+static std::vector<std::string> ramLabels;
+static std::vector<std::string> constants;
+
+static std::string const &pick(std::vector<std::string> const &list) {
+	return list[randUpTo(list.size() - 1)];
+}
+
+static std::string randomString(uint32_t minLen, uint32_t maxLen) {
+	std::string str;
+	for (uint32_t len = minLen + randUpTo(maxLen - minLen); len; --len) {
+		str.push_back('a' + randUpTo(25));
+	}
+	return str;
+}
+
+static void planFile(uint32_t fileID) {
+	FilePlan &file = files.emplace_back();
+
+	for (uint32_t i = 0, n = 1 + randUpTo(4); i < n; ++i) {
+		std::string name = "Const" + std::to_string(fileID) + "_" + std::to_string(i);
+		file.constants.push_back(name);
+		constants.push_back(name);
+	}
+	for (uint32_t i = 0, n = 1 + randUpTo(6); i < n; ++i) {
+		file.charmapStrings.push_back(randomString(1, 3));
+	}
+
+	for (uint32_t i = 0, n = 2 + randUpTo(10); i < n; ++i) {
+		SectionPlan &section = file.sections.emplace_back();
+
+		section.kind = static_cast<SectionKind>(randUpTo(NB_KINDS - 1));
+		// Fragments and unions are shared between files, and must agree on their type
+		if (section.kind == KIND_FRAGMENT) {
+			section.name = "Fragment" + std::to_string(randUpTo(2));
+		} else if (section.kind == KIND_UNION) {
+			section.name = "Union" + std::to_string(randUpTo(2));
+		} else if (section.kind == KIND_HRAM_UNION) {
+			section.name = "HRAMUnion";
+		} else {
+			section.name = "Section" + std::to_string(fileID) + "_" + std::to_string(i);
+		}
+
+		bool rom = isROM(section.kind);
+		for (uint32_t j = 0, m = randUpTo(rom ? 8 : 4); j < m; ++j) {
+			std::string label = (rom ? "Label" : "wVar") + std::to_string(fileID) + "_"
+			                    + std::to_string(i) + "_" + std::to_string(j);
+			section.labels.push_back(label);
+			(rom ? romLabels : ramLabels).push_back(label);
+		}
+	}
+}
+
+static void writeInstruction(FILE *file, uint32_t fileID, std::vector<std::string> const &locals) {
+	switch (randUpTo(9)) {
+	case 0:
+		fprintf(file, "\tld a, %" PRIu32 "\n", randUpTo(255));
+		break;
+	case 1:
+		fprintf(file, "\tcall %s\n", pick(romLabels).c_str());
+		break;
+	case 2:
+		fprintf(file, "\tdw %s, BANK(%s)\n", pick(romLabels).c_str(), pick(romLabels).c_str());
+		break;
+	case 3:
+		if (!ramLabels.empty()) {
+			fprintf(file, "\tld a, [%s]\n", pick(ramLabels).c_str());
+		}
+		break;
+	case 4:
+		fprintf(file, "\tld hl, LOW(%s) * 3 + 1\n", pick(constants).c_str());
+		break;
+	case 5:
+		fprintf(
+		    file,
+		    "\tfill%" PRIu32 " %" PRIu32 ", %" PRIu32 ", %s\n",
+		    fileID,
+		    1 + randUpTo(4),
+		    randUpTo(255),
+		    pick(romLabels).c_str()
+		);
+		break;
+	case 6:
+		fprintf(file, "\tdb \"%s\"\n", pick(files[fileID].charmapStrings).c_str());
+		break;
+	case 7:
+		fprintf(file, "\tds %" PRIu32 ", $%02" PRIx32 "\n", randUpTo(32), randUpTo(255));
+		break;
+	case 8:
+		if (!locals.empty()) {
+			fprintf(file, "\tjp %s\n", pick(locals).c_str());
+		}
+		break;
+	case 9:
+		fprintf(file, "\tdb LOW(%s - @), HIGH(@)\n", pick(romLabels).c_str());
+		break;
+	}
+}
+
+static void writeSection(FILE *file, uint32_t fileID, SectionPlan const &section) {
+	switch (section.kind) {
+	case KIND_ROM0:
+		fprintf(file, "SECTION \"%s\", ROM0\n", section.name.c_str());
+		break;
+	case KIND_ROMX:
+		fprintf(file, "SECTION \"%s\", ROMX\n", section.name.c_str());
+		break;
+	case KIND_ROMX_BANKED:
+		fprintf(
+		    file, "SECTION \"%s\", ROMX, BANK[%" PRIu32 "]\n", section.name.c_str(), 1 + randUpTo(7)
+		);
+		break;
+	case KIND_ROMX_ALIGNED:
+		fprintf(
+		    file, "SECTION \"%s\", ROMX, ALIGN[%" PRIu32 "]\n", section.name.c_str(), randUpTo(8)
+		);
+		break;
+	case KIND_FRAGMENT:
+		fprintf(file, "SECTION FRAGMENT \"%s\", ROMX\n", section.name.c_str());
+		break;
+	case KIND_WRAM0:
+		fprintf(file, "SECTION \"%s\", WRAM0\n", section.name.c_str());
+		break;
+	case KIND_WRAMX:
+		fprintf(file, "SECTION \"%s\", WRAMX\n", section.name.c_str());
+		break;
+	case KIND_UNION:
+		fprintf(file, "SECTION UNION \"%s\", WRAM0\n", section.name.c_str());
+		break;
+	case KIND_HRAM_UNION:
+		fprintf(file, "SECTION UNION \"%s\", HRAM\n", section.name.c_str());
+		break;
+	case NB_KINDS:
+		break;
+	}
+
+	if (!isROM(section.kind)) {
+		uint32_t maxSize = section.kind == KIND_HRAM_UNION ? 4 : 32;
+		for (std::string const &label : section.labels) {
+			fprintf(file, "%s:: ds %" PRIu32 "\n", label.c_str(), 1 + randUpTo(maxSize - 1));
+		}
+		if (section.labels.empty()) {
+			fprintf(file, "\tds %" PRIu32 "\n", 1 + randUpTo(maxSize - 1));
+		}
+		putc('\n', file);
+		return;
+	}
+
+	std::vector<std::string> locals;
+	auto writeInstructions = [&]() {
+		for (uint32_t n = randUpTo(6); n; --n) {
+			writeInstruction(file, fileID, locals);
+		}
+		if (randChance(20)) {
+			fprintf(file, "\tREPT %" PRIu32 "\n", 1 + randUpTo(4));
+			writeInstruction(file, fileID, locals);
+			fputs("\tENDR\n", file);
+		}
+	};
+
+	writeInstructions();
+	for (std::string const &label : section.labels) {
+		fprintf(file, "%s::\n", label.c_str());
+		writeInstructions();
+		if (randChance(50)) {
+			std::string local = label + ".local" + std::to_string(locals.size());
+			fprintf(file, "%s\n", local.c_str());
+			locals.push_back(local);
+			writeInstructions();
+		}
+	}
+	// Sections must not be empty, so that BANK() of their labels is meaningful
+	fputs("\tret\n\n", file);
+}
+
+static void writeFile(char const *baseName, uint32_t fileID, uint32_t seed) {
+	std::string fileName = baseName + std::to_string(fileID) + ".asm";
+	FILE *file = fopen(fileName.c_str(), "w");
+	if (!file) {
+		fprintf(stderr, "FATAL: Cannot create %s: %s\n", fileName.c_str(), strerror(errno));
+		exit(1);
+	}
+	FilePlan const &plan = files[fileID];
+
+	fprintf(
+	    file, "; Generated by randasmgen, seed %" PRIu32 ", file %" PRIu32 "\n\n", seed, fileID
+	);
+
+	for (std::string const &name : plan.constants) {
+		fprintf(file, "DEF %s EQU %" PRIu32 "\n", name.c_str(), randUpTo(0xFFFF));
+		fprintf(file, "EXPORT %s\n", name.c_str());
+	}
+	putc('\n', file);
+
+	fprintf(file, "NEWCHARMAP file%" PRIu32 "\n", fileID);
+	for (std::string const &str : plan.charmapStrings) {
+		fprintf(file, "CHARMAP \"%s\", %" PRIu32 "\n", str.c_str(), randUpTo(255));
+	}
+	putc('\n', file);
+
+	fprintf(file, "MACRO fill%" PRIu32 "\n", fileID);
+	fputs("\tREPT \\1\n", file);
+	fputs("\t\tdb \\2, LOW(\\3), HIGH(\\3)\n", file);
+	fputs("\tENDR\n", file);
+	fputs("ENDM\n\n", file);
+
+	for (SectionPlan const &section : plan.sections) {
+		writeSection(file, fileID, section);
+	}
+
+	fclose(file);
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 4) {
+		fprintf(stderr, "usage: %s <seed> <basename> <file count>\n", argv[0]);
+		return 2;
+	}
+
+	char *endptr;
+	uint32_t seed = strtoul(argv[1], &endptr, 0);
+	if (argv[1][0] == '\0' || *endptr != '\0') {
+		fputs("FATAL: invalid seed\n", stderr);
+		return 1;
+	}
+	uint32_t nbFiles = strtoul(argv[3], &endptr, 0);
+	if (argv[3][0] == '\0' || *endptr != '\0' || nbFiles == 0) {
+		fputs("FATAL: invalid file count\n", stderr);
+		return 1;
+	}
+
+	rng.seed(seed);
+	for (uint32_t fileID = 0; fileID < nbFiles; ++fileID) {
+		planFile(fileID);
+	}
+	// Make sure that every file has something to call
+	if (romLabels.empty()) {
+		SectionPlan &section = files[0].sections.emplace_back();
+		section.kind = KIND_ROM0;
+		section.name = "Entry";
+		section.labels.push_back("Entry");
+		romLabels.push_back("Entry");
+	}
+
+	for (uint32_t fileID = 0; fileID < nbFiles; ++fileID) {
+		writeFile(argv[2], fileID, seed);
+	}
+
+	return 0;
+}
@@ -0,0 +1,166 @@
+#!/usr/bin/env bash
+
+export LC_ALL=C
+
+# Game Boy release date, 1989-04-21T12:34:56Z (for reproducible test results)
+export SOURCE_DATE_EPOCH=609165296
+
+cd "$(dirname "$0")"
+
+usage() {
+	echo "Runs randomly generated inputs through two builds of RGBDS, and compares their outputs."
+	echo "Usage: $0 [options] <reference directory>"
+	echo "The reference directory must contain the rgbasm, rgblink, rgbfix, and rgbgfx to compare"
+	echo "against the ones in the root of this repository."
+	echo "Options:"
+	echo "    -h, --help            show this help message"
+	echo "    -n, --iterations <n>  number of inputs to generate (default: 20)"
+	echo "    -s, --seed <seed>     seed of the first input (default: random)"
+	echo "    --no-objects          do not compare object files (e.g. across format revisions)"
+}
+
+iterations=20
+seed="$RANDOM"
+compareobjs=true
+while [[ $# -gt 0 ]]; do
+	case "$1" in
+		-h|--help)
+			usage
+			exit 0
+			;;
+		-n|--iterations)
+			shift
+			iterations="$1"
+			;;
+		-s|--seed)
+			shift
+			seed="$1"
+			;;
+		--no-objects)
+			compareobjs=false
+			;;
+		-*)
+			usage
+			exit 1
+			;;
+		*)
+			break
+			;;
+	esac
+	shift
+done
+
+if [[ $# -ne 1 ]]; then
+	usage
+	exit 1
+fi
+refdir="$(cd "$1" && pwd)" || exit
+for tool in rgbasm rgblink rgbfix rgbgfx; do
+	if [[ ! -x "$refdir/$tool" ]]; then
+		echo "$refdir/$tool is not an executable" >&2
+		exit 1
+	fi
+done
+newdir="$(cd ../.. && pwd)"
+randasmgen="$PWD/randasmgen"
+randtilegen="$(cd ../gfx && pwd)/randtilegen"
+
+[[ -e "$randasmgen" ]] || make -C ../.. test/diff/randasmgen Q= ${CXX:+"CXX=$CXX"} || exit
+[[ -e "$randtilegen" ]] || make -C ../.. test/gfx/randtilegen Q= ${CXX:+"CXX=$CXX"} || exit
+
+bold="$(tput bold)"
+resbold="$(tput sgr0)"
+red="$(tput setaf 1)"
+green="$(tput setaf 2)"
+rescolors="$(tput op)"
+
+tests=0
+failed=0
+rc=0
+
+# Runs the given command line with both builds' tools, in `ref/` and `new/` respectively
+runBoth() {
+	for build in ref new; do
+		local dir="$refdir"
+		[[ "$build" = new ]] && dir="$newdir"
+		(cd "$build" && export RGBDS="$dir" && eval "$*") >"$build.log" 2>&1
+		echo "[exit status: $?]" >>"$build.log"
+	done
+	cmp -s ref.log new.log || { diff -u ref.log new.log; false; }
+}
+
+# Compares the given files between both builds
+compareOutputs() {
+	local out_rc=0
+	for f in "$@"; do
+		# Both builds failing to produce a file is fine, as long as they report the same errors
+		if [[ ! -e "ref/$f" && ! -e "new/$f" ]]; then
+			continue
+		elif ! cmp "ref/$f" "new/$f"; then
+			echo "${bold}${red}$f mismatch!${rescolors}${resbold}"
+			out_rc=1
+		fi
+	done
+	return $out_rc
+}
+
+runIteration() {
+	local nbfiles=$(( 1 + $1 % 12 ))
+	local objs
+
+	mkdir ref new
+	"$randasmgen" "$1" src "$nbfiles" || return
+	objs="$(for (( i = 0; i < nbfiles; i++ )); do echo -n " src$i.o"; done)"
+
+	runBoth 'for f in ../src*.asm; do f="${f#../}"; "$RGBDS"/rgbasm -o "${f%.asm}.o" "../$f" || exit; done' || return
+	if "$compareobjs"; then
+		compareOutputs $objs || return
+	fi
+	# Link each build's objects with its own linker, so that this works across object revisions
+	runBoth '"$RGBDS"/rgblink -m game.map -n game.sym -o game.gb'"$objs" || return
+	compareOutputs game.map game.sym game.gb || return
+	runBoth '"$RGBDS"/rgblink -p 0x42 -o game-pad.gb'"$objs" || return
+	compareOutputs game-pad.gb || return
+	runBoth '"$RGBDS"/rgbfix -cjsv -k 01 -l 0x33 -m MBC5 -n 1 -p 0xFF -r 1 -t RANDOM game.gb' || return
+	compareOutputs game.gb || return
+
+	# Derive the images from the seed too, so that failures can be reproduced
+	local bytes byte
+	RANDOM="$1"
+	for (( i = 0; i < 2048 + $1 % 8192; i++ )); do
+		printf -v byte '\\x%02x' $(( RANDOM & 0xFF ))
+		bytes+="$byte"
+	done
+	printf "$bytes" >seed.bin
+	"$randtilegen" seed.bin img 4 >/dev/null || return
+	for img in img*.png; do
+		cp "$img" ref/
+		cp "$img" new/
+		runBoth '"$RGBDS"/rgbgfx -u -o '"$img"'.2bpp -p '"$img"'.pal -t '"$img"'.tilemap -a '"$img"'.attrmap '"$img" || return
+		compareOutputs "$img".{2bpp,pal,tilemap,attrmap} || return
+		runBoth '"$RGBDS"/rgbgfx -C -m -b 0x80 -o '"$img"'.m.2bpp -q '"$img"'.palmap -t '"$img"'.m.tilemap '"$img" || return
+		compareOutputs "$img".{m.2bpp,palmap,m.tilemap} || return
+	done
+}
+
+for (( n = 0; n < iterations; n++ )); do
+	(( tests++ ))
+	(( iterseed = seed + n ))
+	echo "${bold}${green}Testing seed $iterseed...${rescolors}${resbold}"
+	workdir="$(mktemp -d)"
+	if (cd "$workdir" && runIteration "$iterseed"); then
+		rm -rf "$workdir"
+	else
+		rc=1
+		(( failed++ ))
+		echo "${bold}${red}Seed $iterseed failed! Its inputs and outputs are in $workdir${rescolors}${resbold}"
+	fi
+done
+
+if [[ "$failed" -eq 0 ]]; then
+	echo "${bold}${green}All ${tests} tests passed!${rescolors}${resbold}"
+else
+	echo "${bold}${red}${failed} of the tests failed!${rescolors}${resbold}"
+fi
+
+exit $rc
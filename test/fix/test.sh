@@ -128,6 +128,18 @@ rc=$((rc || $? != 1))
 tryDiff "$src/noexist.err" out.err noexist.err
 rc=$((rc || $?))
 
+# Check that fixing files in parallel still reports their errors in order
+cp "$src/verify.bin" jobs1.gb
+cp "$src/verify.bin" jobs2.gb
+$RGBFIX --jobs 3 -v noexist jobs1.gb noexist2 jobs2.gb 2>out.err
+rc=$((rc || $? != 1))
+tryDiff "$src/jobs.err" out.err jobs.err
+rc=$((rc || $?))
+for f in jobs1.gb jobs2.gb; do
+	tryCmp "$src/verify.gb" "$f" "$f"
+	rc=$((rc || $?))
+done
+
 if [[ "$failed" -eq 0 ]]; then
 	echo "${bold}${green}All ${tests} tests passed!${rescolors}${resbold}"
 else
@@ -4,10 +4,11 @@
 [[ -e ./randtilegen ]] || make -C ../.. test/gfx/randtilegen Q= ${CXX:+"CXX=$CXX"} || exit
 
 errtmp="$(mktemp)"
+cachetmp="$(mktemp -d)"
 
 # Immediate expansion is the desired behavior.
 # shellcheck disable=SC2064
-trap "rm -f ${errtmp@Q} result.{png,1bpp,2bpp,pal,tilemap,attrmap,palmap} out*.png" EXIT
+trap "rm -rf ${errtmp@Q} ${cachetmp@Q} result.{png,1bpp,2bpp,pal,tilemap,attrmap,palmap} out*.png" EXIT
 
 tests=0
 failed=0
@@ -113,6 +114,31 @@ done
 newTest "$RGBGFX -m -o - write_stdout.bin > result.2bpp"
 runTest && tryCmp write_stdout.out.2bpp result.2bpp || failTest $?
 
+# Test batch mode, whose jobs must succeed or fail independently of each other
+newTest "$RGBGFX --batch batch.manifest -j 2"
+runTest 2>"$errtmp"
+diff -au --strip-trailing-cr batch.err "$errtmp" && tryCmp font_nums.out.2bpp result.2bpp \
+	&& tryCmp alpha_rgb.out.pal result.pal && tryCmp alpha_rgb.out.palmap result.palmap || failTest
+
+# Test batch mode converting its images to a shared tileset and palettes
+newTest "$RGBGFX -m -o result.2bpp -p result.pal --shared-tileset --shared-palettes" \
+	"--batch shared.manifest"
+runTest && tryCmp shared.out.2bpp result.2bpp && tryCmp shared.out.pal result.pal \
+	&& tryCmp shared.out.tilemap result.tilemap \
+	&& tryCmp shared.out.attrmap result.attrmap || failTest $?
+
+# Test shared palettes losing a color to transparency found in a later image
+newTest "$RGBGFX -u -o result.2bpp --shared-tileset --shared-palettes --batch shared_alpha.manifest"
+runTest 2>"$errtmp"
+diff -au --strip-trailing-cr shared_alpha.err "$errtmp" || failTest
+
+# Test caching conversions, whose second run must copy the first one's outputs
+newTest "$RGBGFX --cache-dir ${cachetmp@Q} @pack_tries.flags -o result.2bpp -p result.pal" \
+	"-q result.palmap pack_tries.png"
+runTest && checkOutput pack_tries && rm result.{2bpp,pal,palmap} \
+	&& eval "$cmdline -vv" 2>&1 | grep -q '^Copied outputs from cache entry' \
+	&& checkOutput pack_tries || failTest $?
+
 if [[ "$failed" -eq 0 ]]; then
 	echo "${bold}${green}All ${tests} tests passed!${rescolors}${resbold}"
 else
@@ -0,0 +1,3 @@
+; Only referred to by its section name, since it exports no symbols
+SECTION "Data", ROMX
+	db "data"
@@ -0,0 +1,9 @@
+SECTION "Main", ROM0[$100]
+	ld a, BANK("Data")
+	ld hl, STARTOF("Data")
+	ld bc, SIZEOF("Pieces")
+	jr @
+
+; An archive member defines the other piece of this section
+SECTION FRAGMENT "Pieces", ROM0
+	db 1, 2
@@ -0,0 +1,3 @@
+; Only linked because the section that this is a piece of is referred to by name
+SECTION FRAGMENT "Pieces", ROM0
+	db 3, 4, 5
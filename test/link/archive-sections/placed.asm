@@ -0,0 +1,3 @@
+; Only placed by the linker script
+SECTION "Placed", ROM0
+	db $42
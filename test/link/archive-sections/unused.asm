@@ -0,0 +1,3 @@
+; Nothing refers to this member's section, so it must not be linked
+SECTION "Unused", ROM0
+	db $ff
@@ -0,0 +1,9 @@
+; Only imported by another archive member
+SECTION "Helper", ROM0
+Helper::
+	ld [$C000], a
+	ret
+
+; Also exported by another member, with the same value
+DEF SHARED EQU 5
+EXPORT SHARED
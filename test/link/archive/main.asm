@@ -0,0 +1,3 @@
+SECTION "Main", ROM0[$100]
+	call Routine
+	jr @
@@ -0,0 +1,7 @@
+SECTION "Routine", ROM0
+Routine::
+	ld a, 42
+	jp Helper
+
+DEF SHARED EQU 5
+EXPORT SHARED
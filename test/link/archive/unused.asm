@@ -0,0 +1,4 @@
+; Nothing imports this member's symbols, so it must not be linked
+SECTION "Unused", ROM0
+Unused::
+	ret
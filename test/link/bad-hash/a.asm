@@ -0,0 +1,6 @@
+; `a.o` was assembled from this file, then the stored hash of "Corrupted" was altered,
+; which must be reported instead of interning that name twice
+
+SECTION "Definition", ROM0
+Corrupted::
+	db 42
@@ -0,0 +1,2 @@
+SECTION "Reference", ROM0
+	dw Corrupted
@@ -0,0 +1,14 @@
+SECTION "Entry point", ROM0[$100]
+	di
+	jp Start
+
+SECTION "Start", ROM0[$150]
+Start:
+	ld a, BANK(Far)
+	ld [$2000], a
+	jp Far
+
+SECTION "Far", ROMX, BANK[2]
+Far:
+	ds $1234, $A5
+	jr @
@@ -0,0 +1,16 @@
+	INCLUDE "fold-sections/macros.inc"
+
+	font A
+	helper A
+
+SECTION "Entry", ROM0[$100]
+	call HelperA
+	call HelperB
+	call HelperC
+	ld a, BANK("Font B")
+	ld hl, FontD
+	ld hl, FontE
+
+SECTION "Shared data", ROM0
+SharedData::
+	db $55
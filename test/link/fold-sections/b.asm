@@ -0,0 +1,19 @@
+	INCLUDE "fold-sections/macros.inc"
+
+	; Identical to "Font A", so folded
+	font B
+	; Refers to a folded font, so folded in turn
+	helper B
+	; Only differs by its bank, so not folded
+	font C, 2
+	helper C
+
+	; Different contents, so not folded
+SECTION "Font D", ROMX
+FontD::
+	db $01, $02, $03, $05
+
+	; Fixed, so not folded
+SECTION "Font E", ROMX[$7000]
+FontE::
+	db $01, $02, $03, $04
@@ -0,0 +1,28 @@
+SECTION "Entry", ROM0[$100]
+	call Routine
+	ld a, BANK(BankedData)
+	ld b, BANK("Banked")
+	jp Fragmented
+
+SECTION FRAGMENT "Code", ROM0
+Fragmented:
+	ld hl, wCounter
+	inc [hl]
+	ret
+
+SECTION "Banked", ROMX
+	ds 3, $11
+
+SECTION "Unused code", ROM0
+UnusedCode::
+	call Routine ; References from unused sections do not keep anything
+	jp UnusedToo
+
+SECTION "Unused too", ROM0
+UnusedToo:
+	ret
+
+SECTION "Unused variables", WRAM0
+wUnused:: ds 16
+
+	assert STARTOF("Checked") != 0
@@ -0,0 +1,32 @@
+SECTION "Routine", ROM0
+Routine::
+	ld a, [wBuffer]
+	ret
+
+SECTION FRAGMENT "Code", ROM0
+	db $42
+
+SECTION "Banked data", ROMX
+BankedData::
+	db 1, 2, 3
+
+SECTION "Buffer", WRAM0
+wBuffer:: ds 4
+
+SECTION "Counter", HRAM
+wCounter:: db
+
+SECTION "Checked", ROMX
+	db $cc
+
+SECTION "Kept", ROM0
+KeptRoutine::
+	ret
+
+SECTION "Library function", ROM0
+LibFunction::
+	ld a, [wLibState]
+	ret
+
+SECTION "Library state", WRAM0
+wLibState:: db
@@ -0,0 +1,36 @@
+; Assembled with different `VERSION`s between links that reuse the same state file
+
+SECTION "Entry", ROM0[$100]
+	jp Main
+
+SECTION "Main", ROM0
+Main::
+	ld hl, Data
+	call Routine
+	jr Main
+
+SECTION "Routine", ROM0
+Routine::
+IF VERSION == 1
+	ld a, [hli]
+	ld [$C000], a
+ELSE
+	; Same size, different bytes: the previous layout can be reused
+	ld a, [hld]
+	ld [$C001], a
+ENDC
+	ret
+
+SECTION "Data", ROM0
+Data::
+IF VERSION == 3
+	; Different size: sections must be placed again
+	db "NEW "
+ENDC
+	db "VERSION", VERSION
+
+; Empty sections at the same address must be output in the same order when the layout is reused
+SECTION "Floating empty", ROM0
+FloatingEmpty::
+SECTION "Fixed empty", ROM0[$0000]
+FixedEmpty::
@@ -0,0 +1,25 @@
+DEF VERSION EQU 3
+EXPORT VERSION
+
+SECTION "entry", ROM0[$100]
+	jp Start
+
+SECTION FRAGMENT "code", ROM0
+Start::
+	ld a, [wCounter]
+	inc a
+.loop
+	ld [wCounter], a
+	jr .loop
+
+SECTION "data", ROMX
+Data::
+	REPT 2
+		dw Start
+	ENDR
+
+SECTION "unused", ROMX
+	db "Not referenced"
+
+SECTION UNION "vars", WRAM0
+wCounter:: db
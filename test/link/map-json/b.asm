@@ -0,0 +1,9 @@
+SECTION FRAGMENT "code", ROM0
+	db LOW(Start), BANK(Data)
+
+SECTION UNION "vars", WRAM0
+wOther:: dw
+
+; Not valid UTF-8: a stray continuation byte, a truncated sequence, and a valid one
+SECTION "bytes   é", ROMX
+	db 0
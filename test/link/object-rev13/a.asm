@@ -0,0 +1,23 @@
+; `a.o` was assembled from this file with an object revision 13 RGBASM,
+; to check that older object files can still be linked with newer ones
+
+SECTION "Old code", ROM0
+OldEntry::
+	call NewRoutine
+	ld hl, NewData
+	ld a, BANK(NewData)
+.local
+	jr .local
+	dw SIZEOF("New data"), STARTOF("Shared")
+
+SECTION FRAGMENT "Shared", ROM0
+OldFragment::
+	db "old", OldConstant
+
+SECTION "Old vars", WRAM0
+wOldVar:: ds 2
+
+DEF OldConstant EQU $42
+EXPORT OldConstant
+
+	assert NewData != OldEntry
@@ -0,0 +1,12 @@
+SECTION "New code", ROM0
+NewRoutine::
+	ld a, [wOldVar]
+	jp OldEntry
+
+SECTION "New data", ROMX
+NewData::
+	db OldConstant, LOW(OldFragment), HIGH(OldFragment)
+
+SECTION FRAGMENT "Shared", ROM0
+	db "new"
+	dw OldFragment
@@ -0,0 +1,16 @@
+SECTION "entry", ROM0[$100]
+	jp Start
+
+SECTION FRAGMENT "code", ROM0
+Start::
+	ld a, [wCounter]
+	inc a
+	ld [wCounter], a
+	jr Start
+
+SECTION "data", ROMX
+Data::
+	dw Start
+
+SECTION UNION "vars", WRAM0
+wCounter:: db
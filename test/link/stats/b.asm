@@ -0,0 +1,5 @@
+SECTION FRAGMENT "code", ROM0
+	db LOW(Start), BANK(Data)
+
+SECTION UNION "vars", WRAM0
+wOther:: dw
@@ -140,6 +140,44 @@ done
 
 # These tests do their own thing
 
+test="archive"
+startTest
+"$RGBASM" -o "$otemp" "$test"/main.asm
+"$RGBASM" -o "$outtemp" "$test"/routine.asm
+"$RGBASM" -o "$outtemp2" "$test"/unused.asm
+"$RGBASM" -o "$outtemp3" "$test"/helper.asm
+rgblinkQuiet -a "$gbtemp2" "$outtemp3" "$outtemp" "$outtemp2"
+continueTest
+rgblinkQuiet -o "$gbtemp" -m "$outtemp2" -n "$outtemp3" "$otemp" "$gbtemp2" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+tryDiff "$test"/ref.out.map "$outtemp2"
+tryDiff "$test"/ref.out.sym "$outtemp3"
+tryCmpRom "$test"/ref.out.bin
+evaluateTest
+
+test="archive-sections"
+startTest
+"$RGBASM" -o "$otemp" "$test"/main.asm
+"$RGBASM" -o "$outtemp" "$test"/data.asm
+"$RGBASM" -o "$outtemp2" "$test"/piece.asm
+"$RGBASM" -o "$outtemp3" "$test"/placed.asm
+"$RGBASM" -o "$gbtemp" "$test"/unused.asm
+rgblinkQuiet -a "$gbtemp2" "$outtemp" "$outtemp2" "$outtemp3" "$gbtemp"
+continueTest
+rgblinkQuiet -l "$test"/script.link -o "$gbtemp" -m "$outtemp2" "$otemp" "$gbtemp2" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+tryDiff "$test"/ref.out.map "$outtemp2"
+tryCmpRom "$test"/ref.out.bin
+evaluateTest
+
+test="bad-hash"
+startTest
+"$RGBASM" -o "$otemp" "$test"/b.asm
+continueTest
+rgblinkQuiet -o "$gbtemp" "$test"/a.o "$otemp" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+evaluateTest
+
 test="bank-const"
 startTest
 "$RGBASM" -o "$otemp" "$test"/a.asm
@@ -173,6 +211,58 @@ for test in fragment-align/*; do
 	evaluateTest
 done
 
+test="fix-header"
+startTest
+"$RGBASM" -o "$otemp" "$test"/a.asm
+continueTest
+headerOpts=(--validate --pad-value 0xFF --mbc-type MBC5+RAM --ram-size 2 --title "HEADER FIXED BY RGBLINK")
+rgblinkQuiet "${headerOpts[@]}" -o "$gbtemp" "$otemp" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+# This test does not trim its output with 'dd' because it needs to verify the padding
+tryCmp "$test"/ref.out.bin "$gbtemp"
+evaluateTest
+continueTest "-stdout"
+"$RGBLINK" "${headerOpts[@]}" -o - "$otemp" >"$gbtemp2" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+tryCmp "$test"/ref.out.bin "$gbtemp2"
+evaluateTest
+# Pipes cannot be rewound, so the ROM is written differently there
+continueTest "-pipe"
+"$RGBLINK" "${headerOpts[@]}" -o - "$otemp" 2>"$outtemp" | cat >"$gbtemp2"
+tryDiff "$test"/out.err "$outtemp"
+tryCmp "$test"/ref.out.bin "$gbtemp2"
+evaluateTest
+# RGBFIX refuses ROMs of 65536 banks or more, so fixing one while linking must fail as well
+continueTest "-too-many-banks"
+"$RGBASM" -o "$otemp" invalid-bank.asm
+"$RGBLINK" --validate -o - "$otemp" >"$gbtemp" 2>"$outtemp"
+tryDiff "$test"/too-many-banks.err "$outtemp"
+tryCmpRomSize "$gbtemp" 0
+evaluateTest
+
+test="fold-sections"
+startTest
+"$RGBASM" -o "$otemp" "$test"/a.asm
+"$RGBASM" -o "$gbtemp2" "$test"/b.asm
+continueTest
+rgblinkQuiet -F -o "$gbtemp" -m "$outtemp2" -n "$outtemp3" "$otemp" "$gbtemp2" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+tryDiff "$test"/ref.out.map "$outtemp2"
+tryDiff "$test"/ref.out.sym "$outtemp3"
+tryCmpRom "$test"/ref.out.bin
+evaluateTest
+
+test="gc-sections"
+startTest
+"$RGBASM" -o "$otemp" "$test"/a.asm
+"$RGBASM" -o "$gbtemp2" "$test"/b.asm
+continueTest
+rgblinkQuiet -g -k KeptRoutine -l "$test"/script.link -o "$gbtemp" -m "$outtemp2" "$otemp" "$gbtemp2" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+tryDiff "$test"/ref.out.map "$outtemp2"
+tryCmpRom "$test"/ref.out.bin
+evaluateTest
+
 test="high-low"
 startTest
 "$RGBASM" -o "$otemp" "$test"/a.asm
@@ -223,6 +313,49 @@ tryDiff "$test"/ref.out.map "$outtemp2"
 tryCmpRom "$test"/ref.out.bin
 evaluateTest
 
+test="incremental"
+startTest
+continueTest
+# The state file starts out empty, then gets reused or replaced depending on the changes
+for version in 1 2 3 2; do
+	"$RGBASM" -DVERSION="$version" -o "$otemp" "$test"/a.asm
+	rgblinkQuiet -i "$outtemp3" -m "$outtemp2" -o "$gbtemp" "$otemp" 2>"$outtemp"
+	tryDiff "$test"/out.err "$outtemp"
+	tryDiff "$test"/ref"$version".out.map "$outtemp2"
+	tryCmpRom "$test"/ref"$version".out.bin
+done
+evaluateTest
+
+test="map-json"
+startTest
+"$RGBASM" -o "$otemp" "$test"/a.asm
+"$RGBASM" -o "$gbtemp2" "$test"/b.asm
+continueTest
+rgblinkQuiet -g --map-json "$outtemp2" -o "$gbtemp" "$otemp" "$gbtemp2" 2>"$outtemp"
+tryDiff "$test"/out.err "$outtemp"
+tryDiff "$test"/ref.out.json "$outtemp2"
+evaluateTest
+
+for test in object-rev*; do
+	startTest
+	"$RGBASM" -o "$otemp" "$test"/b.asm
+	continueTest
+	rgblinkQuiet -o "$gbtemp" -n "$outtemp2" "$test"/a.o "$otemp" 2>"$outtemp"
+	tryDiff "$test"/out.err "$outtemp"
+	tryDiff "$test"/ref.out.sym "$outtemp2"
+	tryCmpRom "$test"/ref.out.bin
+	evaluateTest
+	# Written with the current revision, the same source must link the same way
+	continueTest "-current"
+	"$RGBASM" -o "$gbtemp2" "$test"/a.asm
+	"$RGBASM" -o "$otemp" "$test"/b.asm # `tryCmpRom` overwrote it
+	rgblinkQuiet -o "$gbtemp" -n "$outtemp2" "$gbtemp2" "$otemp" 2>"$outtemp"
+	tryDiff "$test"/out.err "$outtemp"
+	tryDiff "$test"/ref.out.sym "$outtemp2"
+	tryCmpRom "$test"/ref.out.bin
+	evaluateTest
+done
+
 test="overlay/smaller"
 startTest
 "$RGBASM" -o "$otemp" "$test"/a.asm
@@ -388,6 +521,25 @@ for i in section-union/*.asm; do
 	evaluateTest
 done
 
+test="stats"
+startTest
+"$RGBASM" -o "$otemp" "$test"/a.asm
+"$RGBASM" -o "$gbtemp2" "$test"/b.asm
+continueTest
+rgblinkQuiet --stats=json -o "$gbtemp" "$otemp" "$gbtemp2" 2>"$outtemp"
+# Timings and memory usage vary from run to run, unlike the counters
+tryDiff "$test"/out.err <(sed -E 's/"(time_ms|peak_rss_kib)": [0-9.]+/"\1": 0/g' "$outtemp")
+evaluateTest
+
+test="stats"
+startTest
+"$RGBASM" -o "$gbtemp2" "$test"/b.asm
+continueTest
+# The report is printed even if the link fails, up to the failing phase
+rgblinkQuiet --stats=json -o "$gbtemp" "$gbtemp2" 2>"$outtemp"
+tryDiff "$test"/failed.out.err <(sed -E 's/"(time_ms|peak_rss_kib)": [0-9.]+/"\1": 0/g' "$outtemp")
+evaluateTest
+
 test="symbols/conflict"
 startTest
 "$RGBASM" -o "$otemp" "$test"/a.asm